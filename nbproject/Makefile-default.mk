@@ -57,17 +57,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=src/UART2.c src/io.c src/main.c src/timer.c src/app.c
+SOURCEFILES_QUOTED_IF_SPACED=src/UART2.c src/io.c src/main.c src/app.c src/eeprom.c src/boot.c src/power.c src/led.c src/alarm.c src/clock.c src/link.c src/stack.c src/sched.c src/timebase.c src/calib.c src/sync.c src/battery.c src/pot.c src/display.c src/lcd.c src/profile.c src/bcd.c src/bench.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/src/UART2.o ${OBJECTDIR}/src/io.o ${OBJECTDIR}/src/main.o ${OBJECTDIR}/src/timer.o ${OBJECTDIR}/src/app.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/src/UART2.o.d ${OBJECTDIR}/src/io.o.d ${OBJECTDIR}/src/main.o.d ${OBJECTDIR}/src/timer.o.d ${OBJECTDIR}/src/app.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/src/UART2.o ${OBJECTDIR}/src/io.o ${OBJECTDIR}/src/main.o ${OBJECTDIR}/src/app.o ${OBJECTDIR}/src/eeprom.o ${OBJECTDIR}/src/boot.o ${OBJECTDIR}/src/power.o ${OBJECTDIR}/src/led.o ${OBJECTDIR}/src/alarm.o ${OBJECTDIR}/src/clock.o ${OBJECTDIR}/src/link.o ${OBJECTDIR}/src/stack.o ${OBJECTDIR}/src/sched.o ${OBJECTDIR}/src/timebase.o ${OBJECTDIR}/src/calib.o ${OBJECTDIR}/src/sync.o ${OBJECTDIR}/src/battery.o ${OBJECTDIR}/src/pot.o ${OBJECTDIR}/src/display.o ${OBJECTDIR}/src/lcd.o ${OBJECTDIR}/src/profile.o ${OBJECTDIR}/src/bcd.o ${OBJECTDIR}/src/bench.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/src/UART2.o.d ${OBJECTDIR}/src/io.o.d ${OBJECTDIR}/src/main.o.d ${OBJECTDIR}/src/app.o.d ${OBJECTDIR}/src/eeprom.o.d ${OBJECTDIR}/src/boot.o.d ${OBJECTDIR}/src/power.o.d ${OBJECTDIR}/src/led.o.d ${OBJECTDIR}/src/alarm.o.d ${OBJECTDIR}/src/clock.o.d ${OBJECTDIR}/src/link.o.d ${OBJECTDIR}/src/stack.o.d ${OBJECTDIR}/src/sched.o.d ${OBJECTDIR}/src/timebase.o.d ${OBJECTDIR}/src/calib.o.d ${OBJECTDIR}/src/sync.o.d ${OBJECTDIR}/src/battery.o.d ${OBJECTDIR}/src/pot.o.d ${OBJECTDIR}/src/display.o.d ${OBJECTDIR}/src/lcd.o.d ${OBJECTDIR}/src/profile.o.d ${OBJECTDIR}/src/bcd.o.d ${OBJECTDIR}/src/bench.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/src/UART2.o ${OBJECTDIR}/src/io.o ${OBJECTDIR}/src/main.o ${OBJECTDIR}/src/timer.o ${OBJECTDIR}/src/app.o
+OBJECTFILES=${OBJECTDIR}/src/UART2.o ${OBJECTDIR}/src/io.o ${OBJECTDIR}/src/main.o ${OBJECTDIR}/src/app.o ${OBJECTDIR}/src/eeprom.o ${OBJECTDIR}/src/boot.o ${OBJECTDIR}/src/power.o ${OBJECTDIR}/src/led.o ${OBJECTDIR}/src/alarm.o ${OBJECTDIR}/src/clock.o ${OBJECTDIR}/src/link.o ${OBJECTDIR}/src/stack.o ${OBJECTDIR}/src/sched.o ${OBJECTDIR}/src/timebase.o ${OBJECTDIR}/src/calib.o ${OBJECTDIR}/src/sync.o ${OBJECTDIR}/src/battery.o ${OBJECTDIR}/src/pot.o ${OBJECTDIR}/src/display.o ${OBJECTDIR}/src/lcd.o ${OBJECTDIR}/src/profile.o ${OBJECTDIR}/src/bcd.o ${OBJECTDIR}/src/bench.o
 
 # Source Files
-SOURCEFILES=src/UART2.c src/io.c src/main.c src/timer.c src/app.c
+SOURCEFILES=src/UART2.c src/io.c src/main.c src/app.c src/eeprom.c src/boot.c src/power.c src/led.c src/alarm.c src/clock.c src/link.c src/stack.c src/sched.c src/timebase.c src/calib.c src/sync.c src/battery.c src/pot.c src/display.c src/lcd.c src/profile.c src/bcd.c src/bench.c
 
 
 
@@ -113,18 +113,126 @@ ${OBJECTDIR}/src/main.o: src/main.c  .generated_files/flags/default/830043d0a636
 	@${RM} ${OBJECTDIR}/src/main.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE)  src/main.c  -o ${OBJECTDIR}/src/main.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/main.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
 	
-${OBJECTDIR}/src/timer.o: src/timer.c  .generated_files/flags/default/9cbefa06d5ec413485df89fe9623848ad1092787 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
-	@${MKDIR} "${OBJECTDIR}/src" 
-	@${RM} ${OBJECTDIR}/src/timer.o.d 
-	@${RM} ${OBJECTDIR}/src/timer.o 
-	${MP_CC} $(MP_EXTRA_CC_PRE)  src/timer.c  -o ${OBJECTDIR}/src/timer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/timer.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
-	
 ${OBJECTDIR}/src/app.o: src/app.c  .generated_files/flags/default/688c37eb7d5ef680e31f0c8186dbd2c4f11a05a8 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
 	@${MKDIR} "${OBJECTDIR}/src" 
 	@${RM} ${OBJECTDIR}/src/app.o.d 
 	@${RM} ${OBJECTDIR}/src/app.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE)  src/app.c  -o ${OBJECTDIR}/src/app.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/app.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
 	
+${OBJECTDIR}/src/eeprom.o: src/eeprom.c  .generated_files/flags/default/f437c47890dcfce8390dbd1a972adbf955837f07 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/eeprom.o.d 
+	@${RM} ${OBJECTDIR}/src/eeprom.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/eeprom.c  -o ${OBJECTDIR}/src/eeprom.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/eeprom.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/boot.o: src/boot.c  .generated_files/flags/default/ab807d2e6cbfda10894b290f81de35f54ef76909 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/boot.o.d 
+	@${RM} ${OBJECTDIR}/src/boot.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/boot.c  -o ${OBJECTDIR}/src/boot.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/boot.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/power.o: src/power.c  .generated_files/flags/default/3a62ec1f3d208bf09ffdbada901f70e20ed295e6 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/power.o.d 
+	@${RM} ${OBJECTDIR}/src/power.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/power.c  -o ${OBJECTDIR}/src/power.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/power.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/led.o: src/led.c  .generated_files/flags/default/242cf489d997fd6b168c5dbcb0fdc23794b72dd9 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/led.o.d 
+	@${RM} ${OBJECTDIR}/src/led.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/led.c  -o ${OBJECTDIR}/src/led.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/led.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/alarm.o: src/alarm.c  .generated_files/flags/default/bf79ac7c21b35e18c01d385e25d441076572e33c .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/alarm.o.d 
+	@${RM} ${OBJECTDIR}/src/alarm.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/alarm.c  -o ${OBJECTDIR}/src/alarm.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/alarm.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/clock.o: src/clock.c  .generated_files/flags/default/6bed037640769142227b7b2c37cc8fa9dd569522 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/clock.o.d 
+	@${RM} ${OBJECTDIR}/src/clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/clock.c  -o ${OBJECTDIR}/src/clock.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/clock.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/link.o: src/link.c  .generated_files/flags/default/40cb15f8e2269abc6bf6c9b33bee8268d13569d7 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/link.o.d 
+	@${RM} ${OBJECTDIR}/src/link.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/link.c  -o ${OBJECTDIR}/src/link.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/link.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/stack.o: src/stack.c  .generated_files/flags/default/9da1f4687dcbc455be8725896efac86ee98ba3c2 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/stack.o.d 
+	@${RM} ${OBJECTDIR}/src/stack.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/stack.c  -o ${OBJECTDIR}/src/stack.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/stack.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/sched.o: src/sched.c  .generated_files/flags/default/29cf640c574c4681740680e91a54d7ab73767009 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/sched.o.d 
+	@${RM} ${OBJECTDIR}/src/sched.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/sched.c  -o ${OBJECTDIR}/src/sched.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/sched.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/timebase.o: src/timebase.c  .generated_files/flags/default/98c3238bf24df5246436fb0eea4b1e72e0432071 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/timebase.o.d 
+	@${RM} ${OBJECTDIR}/src/timebase.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/timebase.c  -o ${OBJECTDIR}/src/timebase.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/timebase.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/calib.o: src/calib.c  .generated_files/flags/default/aeb41cdc7452e2b9ce09ab710d33cf6bc54ed8ae .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/calib.o.d 
+	@${RM} ${OBJECTDIR}/src/calib.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/calib.c  -o ${OBJECTDIR}/src/calib.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/calib.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/sync.o: src/sync.c  .generated_files/flags/default/f37c4b40d2871c3463320a1645c9c310061a19ac .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/sync.o.d 
+	@${RM} ${OBJECTDIR}/src/sync.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/sync.c  -o ${OBJECTDIR}/src/sync.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/sync.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/battery.o: src/battery.c  .generated_files/flags/default/7d7969b9d7eeefbde3d4ceddfbc52a39026bce83 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/battery.o.d 
+	@${RM} ${OBJECTDIR}/src/battery.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/battery.c  -o ${OBJECTDIR}/src/battery.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/battery.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/pot.o: src/pot.c  .generated_files/flags/default/8e35c48263d1ef6ea0e478b3b03113d862ca7828 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/pot.o.d 
+	@${RM} ${OBJECTDIR}/src/pot.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/pot.c  -o ${OBJECTDIR}/src/pot.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/pot.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/display.o: src/display.c  .generated_files/flags/default/596972a70c7a8188a7f05d39e17f7340cfa1ef91 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/display.o.d 
+	@${RM} ${OBJECTDIR}/src/display.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/display.c  -o ${OBJECTDIR}/src/display.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/display.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/lcd.o: src/lcd.c  .generated_files/flags/default/0a9502e93e87832b3b8f32eb275efaa08e8e65bd .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/lcd.o.d 
+	@${RM} ${OBJECTDIR}/src/lcd.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/lcd.c  -o ${OBJECTDIR}/src/lcd.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/lcd.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/profile.o: src/profile.c  .generated_files/flags/default/ee692300209c14f26a2db899e7a07acc42a761a9 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/profile.o.d 
+	@${RM} ${OBJECTDIR}/src/profile.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/profile.c  -o ${OBJECTDIR}/src/profile.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/profile.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/bcd.o: src/bcd.c  .generated_files/flags/default/b97d5a164f96bb36013796ad91a6f12c0546f20e .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/bcd.o.d 
+	@${RM} ${OBJECTDIR}/src/bcd.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/bcd.c  -o ${OBJECTDIR}/src/bcd.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/bcd.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/bench.o: src/bench.c  .generated_files/flags/default/071a27ed89daf9d74c6f959bf0b346784a7b163e .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/bench.o.d 
+	@${RM} ${OBJECTDIR}/src/bench.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/bench.c  -o ${OBJECTDIR}/src/bench.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/bench.o.d"      -g -D__DEBUG     -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
 else
 ${OBJECTDIR}/src/UART2.o: src/UART2.c  .generated_files/flags/default/803960f3964e6c2b5ff7930d4f499405513cedd4 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
 	@${MKDIR} "${OBJECTDIR}/src" 
@@ -144,18 +252,126 @@ ${OBJECTDIR}/src/main.o: src/main.c  .generated_files/flags/default/bc6d83b14562
 	@${RM} ${OBJECTDIR}/src/main.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE)  src/main.c  -o ${OBJECTDIR}/src/main.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/main.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
 	
-${OBJECTDIR}/src/timer.o: src/timer.c  .generated_files/flags/default/5514e6d5add1868cc7393d06389ca73aba6592b0 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
-	@${MKDIR} "${OBJECTDIR}/src" 
-	@${RM} ${OBJECTDIR}/src/timer.o.d 
-	@${RM} ${OBJECTDIR}/src/timer.o 
-	${MP_CC} $(MP_EXTRA_CC_PRE)  src/timer.c  -o ${OBJECTDIR}/src/timer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/timer.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
-	
 ${OBJECTDIR}/src/app.o: src/app.c  .generated_files/flags/default/184e81bdcbf035dfa157e2fa6d0ebf9c79564321 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
 	@${MKDIR} "${OBJECTDIR}/src" 
 	@${RM} ${OBJECTDIR}/src/app.o.d 
 	@${RM} ${OBJECTDIR}/src/app.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE)  src/app.c  -o ${OBJECTDIR}/src/app.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/app.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
 	
+${OBJECTDIR}/src/eeprom.o: src/eeprom.c  .generated_files/flags/default/d5dfdcdbcec29308dc05dd31417c924b289f5227 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/eeprom.o.d 
+	@${RM} ${OBJECTDIR}/src/eeprom.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/eeprom.c  -o ${OBJECTDIR}/src/eeprom.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/eeprom.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/boot.o: src/boot.c  .generated_files/flags/default/e1e65760bd94ba79925217b8bb82386b6cedbdbd .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/boot.o.d 
+	@${RM} ${OBJECTDIR}/src/boot.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/boot.c  -o ${OBJECTDIR}/src/boot.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/boot.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/power.o: src/power.c  .generated_files/flags/default/bf28e4f21a5c5da3165b3a3fde5836eae9b03d4f .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/power.o.d 
+	@${RM} ${OBJECTDIR}/src/power.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/power.c  -o ${OBJECTDIR}/src/power.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/power.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/led.o: src/led.c  .generated_files/flags/default/8228a5ea9ade21719767a3382334a2e09eb226b4 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/led.o.d 
+	@${RM} ${OBJECTDIR}/src/led.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/led.c  -o ${OBJECTDIR}/src/led.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/led.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/alarm.o: src/alarm.c  .generated_files/flags/default/6b821201da118baad8fce04a2029890ce831e8a0 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/alarm.o.d 
+	@${RM} ${OBJECTDIR}/src/alarm.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/alarm.c  -o ${OBJECTDIR}/src/alarm.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/alarm.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/clock.o: src/clock.c  .generated_files/flags/default/0fdae9517d43c8371ee5e96b0d2842e269999eb0 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/clock.o.d 
+	@${RM} ${OBJECTDIR}/src/clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/clock.c  -o ${OBJECTDIR}/src/clock.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/clock.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/link.o: src/link.c  .generated_files/flags/default/6d2a28c2cb87b63753dddc4c5e61b0285ff8778b .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/link.o.d 
+	@${RM} ${OBJECTDIR}/src/link.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/link.c  -o ${OBJECTDIR}/src/link.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/link.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/stack.o: src/stack.c  .generated_files/flags/default/ee042aba6b5b0fc81ba5f7fcdfe01e061ffb651a .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/stack.o.d 
+	@${RM} ${OBJECTDIR}/src/stack.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/stack.c  -o ${OBJECTDIR}/src/stack.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/stack.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/sched.o: src/sched.c  .generated_files/flags/default/fc68218d6fd788cf6336548a8f613fb824c014d3 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/sched.o.d 
+	@${RM} ${OBJECTDIR}/src/sched.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/sched.c  -o ${OBJECTDIR}/src/sched.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/sched.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/timebase.o: src/timebase.c  .generated_files/flags/default/e7c273d6b1c075ba1aeed425f42f102d62b352d2 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/timebase.o.d 
+	@${RM} ${OBJECTDIR}/src/timebase.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/timebase.c  -o ${OBJECTDIR}/src/timebase.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/timebase.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/calib.o: src/calib.c  .generated_files/flags/default/8c3bb5acc60cdd64503f3108d8d5daadcd00ca7b .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/calib.o.d 
+	@${RM} ${OBJECTDIR}/src/calib.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/calib.c  -o ${OBJECTDIR}/src/calib.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/calib.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/sync.o: src/sync.c  .generated_files/flags/default/af89f6a65149c00b787fcb878e861d88919debc4 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/sync.o.d 
+	@${RM} ${OBJECTDIR}/src/sync.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/sync.c  -o ${OBJECTDIR}/src/sync.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/sync.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/battery.o: src/battery.c  .generated_files/flags/default/eaea7cd19eb72339bb67075c5cd58d7674a7a6b8 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/battery.o.d 
+	@${RM} ${OBJECTDIR}/src/battery.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/battery.c  -o ${OBJECTDIR}/src/battery.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/battery.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/pot.o: src/pot.c  .generated_files/flags/default/58c7a83fe2653740d38580412ec0c2de1e0b2943 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/pot.o.d 
+	@${RM} ${OBJECTDIR}/src/pot.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/pot.c  -o ${OBJECTDIR}/src/pot.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/pot.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/display.o: src/display.c  .generated_files/flags/default/7ba8b15a3008e359c95083d382504c4a2e58b272 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/display.o.d 
+	@${RM} ${OBJECTDIR}/src/display.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/display.c  -o ${OBJECTDIR}/src/display.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/display.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/lcd.o: src/lcd.c  .generated_files/flags/default/2ad2e59e3d46c168faa7bf81c4ef6c9888f55a14 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/lcd.o.d 
+	@${RM} ${OBJECTDIR}/src/lcd.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/lcd.c  -o ${OBJECTDIR}/src/lcd.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/lcd.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/profile.o: src/profile.c  .generated_files/flags/default/6814d1ecf17749282b9f8b55969c375512e6aa30 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/profile.o.d 
+	@${RM} ${OBJECTDIR}/src/profile.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/profile.c  -o ${OBJECTDIR}/src/profile.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/profile.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/bcd.o: src/bcd.c  .generated_files/flags/default/3c4a26a17ff559a99eeb1b6b8c540eb8c32b2f3e .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/bcd.o.d 
+	@${RM} ${OBJECTDIR}/src/bcd.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/bcd.c  -o ${OBJECTDIR}/src/bcd.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/bcd.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
+${OBJECTDIR}/src/bench.o: src/bench.c  .generated_files/flags/default/942c06875d6c8c3c1a329b1a16cecc013fada792 .generated_files/flags/default/2dbb7b810b5280c4b024d19281a32f5ee4298ea0
+	@${MKDIR} "${OBJECTDIR}/src" 
+	@${RM} ${OBJECTDIR}/src/bench.o.d 
+	@${RM} ${OBJECTDIR}/src/bench.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  src/bench.c  -o ${OBJECTDIR}/src/bench.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/src/bench.o.d"        -g -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off    -mdfp="${DFP_DIR}/xc16"
+	
 endif
 
 # ------------------------------------------------------------------------------------
@@ -175,12 +391,12 @@ endif
 ifeq ($(TYPE_IMAGE), DEBUG_RUN)
 ${DISTDIR}/ENCM_511_App_Project_1.${IMAGE_TYPE}.${OUTPUT_SUFFIX}: ${OBJECTFILES}  nbproject/Makefile-${CND_CONF}.mk    
 	@${MKDIR} ${DISTDIR} 
-	${MP_CC} $(MP_EXTRA_LD_PRE)  -o ${DISTDIR}/ENCM_511_App_Project_1.${IMAGE_TYPE}.${OUTPUT_SUFFIX}  ${OBJECTFILES_QUOTED_IF_SPACED}      -mcpu=$(MP_PROCESSOR_OPTION)        -D__DEBUG=__DEBUG   -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)   -mreserve=data@0x800:0x81F -mreserve=data@0x820:0x821 -mreserve=data@0x822:0x823 -mreserve=data@0x824:0x825 -mreserve=data@0x826:0x84F   -Wl,,,--defsym=__MPLAB_BUILD=1,--defsym=__MPLAB_DEBUG=1,--defsym=__DEBUG=1,-D__DEBUG=__DEBUG,,$(MP_LINKER_FILE_OPTION),--stack=16,--check-sections,--data-init,--pack-data,--handles,--isr,--no-gc-sections,--fill-upper=0,--stackguard=16,--no-force-link,--smart-io,-Map="${DISTDIR}/${PROJECTNAME}.${IMAGE_TYPE}.map",--report-mem,--memorysummary,${DISTDIR}/memoryfile.xml$(MP_EXTRA_LD_POST)  -mdfp="${DFP_DIR}/xc16" 
+	${MP_CC} $(MP_EXTRA_LD_PRE)  -o ${DISTDIR}/ENCM_511_App_Project_1.${IMAGE_TYPE}.${OUTPUT_SUFFIX}  ${OBJECTFILES_QUOTED_IF_SPACED}      -mcpu=$(MP_PROCESSOR_OPTION)        -D__DEBUG=__DEBUG   -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)   -mreserve=data@0x800:0x81F -mreserve=data@0x820:0x821 -mreserve=data@0x822:0x823 -mreserve=data@0x824:0x825 -mreserve=data@0x826:0x84F   -Wl,,,--defsym=__MPLAB_BUILD=1,--defsym=__MPLAB_DEBUG=1,--defsym=__DEBUG=1,-D__DEBUG=__DEBUG,,$(MP_LINKER_FILE_OPTION),--stack=512,--check-sections,--data-init,--pack-data,--handles,--isr,--no-gc-sections,--fill-upper=0,--stackguard=16,--no-force-link,--smart-io,-Map="${DISTDIR}/${PROJECTNAME}.${IMAGE_TYPE}.map",--report-mem,--memorysummary,${DISTDIR}/memoryfile.xml$(MP_EXTRA_LD_POST)  -mdfp="${DFP_DIR}/xc16" 
 	
 else
 ${DISTDIR}/ENCM_511_App_Project_1.${IMAGE_TYPE}.${OUTPUT_SUFFIX}: ${OBJECTFILES}  nbproject/Makefile-${CND_CONF}.mk   
 	@${MKDIR} ${DISTDIR} 
-	${MP_CC} $(MP_EXTRA_LD_PRE)  -o ${DISTDIR}/ENCM_511_App_Project_1.${IMAGE_TYPE}.${DEBUGGABLE_SUFFIX}  ${OBJECTFILES_QUOTED_IF_SPACED}      -mcpu=$(MP_PROCESSOR_OPTION)        -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -Wl,,,--defsym=__MPLAB_BUILD=1,$(MP_LINKER_FILE_OPTION),--stack=16,--check-sections,--data-init,--pack-data,--handles,--isr,--no-gc-sections,--fill-upper=0,--stackguard=16,--no-force-link,--smart-io,-Map="${DISTDIR}/${PROJECTNAME}.${IMAGE_TYPE}.map",--report-mem,--memorysummary,${DISTDIR}/memoryfile.xml$(MP_EXTRA_LD_POST)  -mdfp="${DFP_DIR}/xc16" 
+	${MP_CC} $(MP_EXTRA_LD_PRE)  -o ${DISTDIR}/ENCM_511_App_Project_1.${IMAGE_TYPE}.${DEBUGGABLE_SUFFIX}  ${OBJECTFILES_QUOTED_IF_SPACED}      -mcpu=$(MP_PROCESSOR_OPTION)        -omf=elf -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -Wl,,,--defsym=__MPLAB_BUILD=1,$(MP_LINKER_FILE_OPTION),--stack=512,--check-sections,--data-init,--pack-data,--handles,--isr,--no-gc-sections,--fill-upper=0,--stackguard=16,--no-force-link,--smart-io,-Map="${DISTDIR}/${PROJECTNAME}.${IMAGE_TYPE}.map",--report-mem,--memorysummary,${DISTDIR}/memoryfile.xml$(MP_EXTRA_LD_POST)  -mdfp="${DFP_DIR}/xc16" 
 	${MP_CC_DIR}/xc16-bin2hex ${DISTDIR}/ENCM_511_App_Project_1.${IMAGE_TYPE}.${DEBUGGABLE_SUFFIX} -a  -omf=elf   -mdfp="${DFP_DIR}/xc16" 
 	
 endif
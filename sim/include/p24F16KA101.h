@@ -0,0 +1,14 @@
+/*
+ * File:   p24F16KA101.h
+ * Author: Andy Smit
+ *
+ * Host simulator stand-in for the XC16 device header. Everything lives
+ * in the simulator's xc.h.
+ */
+
+#ifndef SIM_P24F16KA101_H
+#define	SIM_P24F16KA101_H
+
+#include "xc.h"
+
+#endif	/* SIM_P24F16KA101_H */
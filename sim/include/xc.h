@@ -0,0 +1,445 @@
+/*
+ * File:   xc.h
+ * Author: Andy Smit
+ *
+ * Host simulator stand-in for the XC16 xc.h header. Declares the special
+ * function registers used by the firmware as plain memory so the real
+ * sources in src/ compile with the host compiler. Peripheral behaviour is
+ * modelled in sim.c.
+ *
+ * Only the registers and bits the firmware touches are declared. Bit
+ * positions follow the PIC24F16KA101 datasheet so whole register writes
+ * such as U2MODE = 0x8008 land on the right bits.
+ */
+
+#ifndef SIM_XC_H
+#define	SIM_XC_H
+
+#include <stdint.h>
+
+// The firmware main() becomes firmware_main() so the replay harness can
+// own the process entry point.
+#define main firmware_main
+
+// XC16 interrupt attributes have no meaning on the host. An empty
+// attribute list entry is accepted by gcc.
+#define interrupt
+#define no_auto_psv
+#define shadow
+
+#define SIM_SFR(name, fields) \
+    typedef union \
+    { \
+        uint16_t w; \
+        struct { fields }; \
+    } name##BITS; \
+    extern volatile name##BITS sim_##name
+
+// CPU
+SIM_SFR(INTCON1, unsigned :15; unsigned NSTDIS:1;);
+#define INTCON1 sim_INTCON1.w
+#define INTCON1bits sim_INTCON1
+
+// Oscillator
+SIM_SFR(OSCCON, unsigned OSWEN:1; unsigned SOSCEN:1; unsigned :1;
+        unsigned CF:1; unsigned :1; unsigned LOCK:1; unsigned :1;
+        unsigned CLKLOCK:1; unsigned NOSC:3; unsigned :1; unsigned COSC:3;);
+#define OSCCON sim_OSCCON.w
+#define OSCCONbits sim_OSCCON
+
+// OSCCON byte writes with the unlock sequence. A switch requested with
+// OSWEN takes effect at once.
+void sim_write_oscconh(uint8_t value);
+void sim_write_oscconl(uint8_t value);
+#define __builtin_write_OSCCONH(value) sim_write_oscconh(value)
+#define __builtin_write_OSCCONL(value) sim_write_oscconl(value)
+
+SIM_SFR(CLKDIV, unsigned :8; unsigned RCDIV:3; unsigned DOZEN:1;
+        unsigned DOZE:3; unsigned ROI:1;);
+#define CLKDIV sim_CLKDIV.w
+#define CLKDIVbits sim_CLKDIV
+
+// FRC tuning: TUN is 6 bit two's complement, see fcy_hz in sim.c.
+SIM_SFR(OSCTUN, unsigned TUN:6;);
+#define OSCTUN sim_OSCTUN.w
+#define OSCTUNbits sim_OSCTUN
+
+SIM_SFR(REFOCON, unsigned :8; unsigned RODIV:4; unsigned ROSEL:1;
+        unsigned ROSSLP:1; unsigned :1; unsigned ROEN:1;);
+#define REFOCON sim_REFOCON.w
+#define REFOCONbits sim_REFOCON
+
+// Peripheral module disable. A set bit stops the module and holds its
+// registers at their reset values (modelled in sim.c).
+SIM_SFR(PMD1, unsigned ADC1MD:1; unsigned :2; unsigned SPI1MD:1;
+        unsigned :1; unsigned U1MD:1; unsigned U2MD:1; unsigned I2C1MD:1;
+        unsigned :3; unsigned T1MD:1; unsigned T2MD:1; unsigned T3MD:1;
+        unsigned :2;);
+#define PMD1 sim_PMD1.w
+#define PMD1bits sim_PMD1
+
+SIM_SFR(PMD2, unsigned OC1MD:1; unsigned :7; unsigned IC1MD:1;
+        unsigned :7;);
+#define PMD2 sim_PMD2.w
+#define PMD2bits sim_PMD2
+
+SIM_SFR(PMD3, unsigned :9; unsigned RTCCMD:1; unsigned CMPMD:1;
+        unsigned :5;);
+#define PMD3 sim_PMD3.w
+#define PMD3bits sim_PMD3
+
+SIM_SFR(PMD4, unsigned ULPWUMD:1; unsigned HLVDMD:1; unsigned CTMUMD:1;
+        unsigned REFOMD:1; unsigned EEMD:1; unsigned :11;);
+#define PMD4 sim_PMD4.w
+#define PMD4bits sim_PMD4
+
+// Ports
+SIM_SFR(TRISA, unsigned TRISA0:1; unsigned TRISA1:1; unsigned TRISA2:1;
+        unsigned TRISA3:1; unsigned TRISA4:1; unsigned TRISA5:1;
+        unsigned TRISA6:1;);
+#define TRISA sim_TRISA.w
+#define TRISAbits sim_TRISA
+
+SIM_SFR(PORTA, unsigned RA0:1; unsigned RA1:1; unsigned RA2:1;
+        unsigned RA3:1; unsigned RA4:1; unsigned RA5:1; unsigned RA6:1;);
+#define PORTA sim_PORTA.w
+#define PORTAbits sim_PORTA
+
+SIM_SFR(LATA, unsigned LATA0:1; unsigned LATA1:1; unsigned LATA2:1;
+        unsigned LATA3:1; unsigned LATA4:1; unsigned LATA5:1;
+        unsigned LATA6:1;);
+#define LATA sim_LATA.w
+#define LATAbits sim_LATA
+
+SIM_SFR(TRISB, unsigned TRISB0:1; unsigned TRISB1:1; unsigned TRISB2:1;
+        unsigned TRISB3:1; unsigned TRISB4:1; unsigned TRISB5:1;
+        unsigned TRISB6:1; unsigned TRISB7:1; unsigned TRISB8:1;
+        unsigned TRISB9:1; unsigned TRISB10:1; unsigned TRISB11:1;
+        unsigned TRISB12:1; unsigned TRISB13:1; unsigned TRISB14:1;
+        unsigned TRISB15:1;);
+#define TRISB sim_TRISB.w
+#define TRISBbits sim_TRISB
+
+SIM_SFR(PORTB, unsigned RB0:1; unsigned RB1:1; unsigned RB2:1;
+        unsigned RB3:1; unsigned RB4:1; unsigned RB5:1; unsigned RB6:1;
+        unsigned RB7:1; unsigned RB8:1; unsigned RB9:1; unsigned RB10:1;
+        unsigned RB11:1; unsigned RB12:1; unsigned RB13:1; unsigned RB14:1;
+        unsigned RB15:1;);
+#define PORTB sim_PORTB.w
+#define PORTBbits sim_PORTB
+
+SIM_SFR(LATB, unsigned LATB0:1; unsigned LATB1:1; unsigned LATB2:1;
+        unsigned LATB3:1; unsigned LATB4:1; unsigned LATB5:1;
+        unsigned LATB6:1; unsigned LATB7:1; unsigned LATB8:1;
+        unsigned LATB9:1; unsigned LATB10:1; unsigned LATB11:1;
+        unsigned LATB12:1; unsigned LATB13:1; unsigned LATB14:1;
+        unsigned LATB15:1;);
+#define LATB sim_LATB.w
+#define LATBbits sim_LATB
+
+extern volatile uint16_t AD1PCFG;
+
+// ADC, with SSRC = 0b111 only. Setting SAMP with ADON set converts once,
+// at once. With ASAM set it converts SMPI + 1 times into the buffers,
+// taking (SAMC + 12) ADC clocks each, then raises AD1IF and goes on
+// while ASAM stays set. The band gap reads as the supply sets it (see
+// sim_set_battery), the board's pot as a trace sets it, and any other
+// input as 0. Accesses to AD1CON1 go through a function so a single
+// conversion happens on the next access.
+SIM_SFR(AD1CON1, unsigned DONE:1; unsigned SAMP:1; unsigned ASAM:1;
+        unsigned :2; unsigned SSRC:3; unsigned FORM:2; unsigned :3;
+        unsigned ADSIDL:1; unsigned :1; unsigned ADON:1;);
+volatile AD1CON1BITS *sim_ad1con1(void);
+#define AD1CON1 (sim_ad1con1()->w)
+#define AD1CON1bits (*sim_ad1con1())
+
+SIM_SFR(AD1CON2, unsigned ALTS:1; unsigned BUFM:1; unsigned SMPI:4;
+        unsigned :1; unsigned BUFS:1; unsigned :2; unsigned CSCNA:1;
+        unsigned :2; unsigned VCFG:3;);
+#define AD1CON2 sim_AD1CON2.w
+#define AD1CON2bits sim_AD1CON2
+
+SIM_SFR(AD1CON3, unsigned ADCS:8; unsigned SAMC:5; unsigned :2;
+        unsigned ADRC:1;);
+#define AD1CON3 sim_AD1CON3.w
+#define AD1CON3bits sim_AD1CON3
+
+SIM_SFR(AD1CHS, unsigned CH0SA:4; unsigned :3; unsigned CH0NA:1;
+        unsigned CH0SB:4; unsigned :3; unsigned CH0NB:1;);
+#define AD1CHS sim_AD1CHS.w
+#define AD1CHSbits sim_AD1CHS
+
+extern volatile uint16_t sim_adc1buf[16];
+#define ADC1BUF0 sim_adc1buf[0]
+
+// High/low voltage detect. With HLVDEN set and VDIR clear, HLVDIF is
+// raised while the supply is below the trip point HLVDL selects (see
+// hlvd_trip_mv in sim.c).
+SIM_SFR(HLVDCON, unsigned HLVDL:4; unsigned :1; unsigned IRVST:1;
+        unsigned BGVST:1; unsigned VDIR:1; unsigned :5; unsigned HLVDSIDL:1;
+        unsigned :1; unsigned HLVDEN:1;);
+#define HLVDCON sim_HLVDCON.w
+#define HLVDCONbits sim_HLVDCON
+
+// Output compare 1. Only PWM mode on Timer 2 is modelled, as the LED's
+// average brightness.
+SIM_SFR(OC1CON, unsigned OCM:3; unsigned OCTSEL:1; unsigned OCFLT:1;
+        unsigned :8; unsigned OCSIDL:1; unsigned :2;);
+#define OC1CON sim_OC1CON.w
+#define OC1CONbits sim_OC1CON
+
+extern volatile uint16_t OC1R;
+extern volatile uint16_t OC1RS;
+
+// Change notification
+SIM_SFR(CNEN1, unsigned CN0IE:1; unsigned CN1IE:1; unsigned CN2IE:1;
+        unsigned CN3IE:1; unsigned CN4IE:1; unsigned CN5IE:1;
+        unsigned CN6IE:1; unsigned CN7IE:1; unsigned CN8IE:1;
+        unsigned CN9IE:1; unsigned CN10IE:1; unsigned CN11IE:1;
+        unsigned CN12IE:1; unsigned CN13IE:1; unsigned CN14IE:1;
+        unsigned CN15IE:1;);
+#define CNEN1 sim_CNEN1.w
+#define CNEN1bits sim_CNEN1
+
+SIM_SFR(CNEN2, unsigned CN16IE:1; unsigned :4; unsigned CN21IE:1;
+        unsigned CN22IE:1; unsigned CN23IE:1; unsigned CN24IE:1;
+        unsigned :4; unsigned CN29IE:1; unsigned CN30IE:1;);
+#define CNEN2 sim_CNEN2.w
+#define CNEN2bits sim_CNEN2
+
+SIM_SFR(CNPU1, unsigned CN0PUE:1; unsigned CN1PUE:1; unsigned CN2PUE:1;
+        unsigned CN3PUE:1; unsigned CN4PUE:1; unsigned CN5PUE:1;
+        unsigned CN6PUE:1; unsigned CN7PUE:1; unsigned CN8PUE:1;
+        unsigned CN9PUE:1; unsigned CN10PUE:1; unsigned CN11PUE:1;
+        unsigned CN12PUE:1; unsigned CN13PUE:1; unsigned CN14PUE:1;
+        unsigned CN15PUE:1;);
+#define CNPU1 sim_CNPU1.w
+#define CNPU1bits sim_CNPU1
+
+SIM_SFR(CNPU2, unsigned CN16PUE:1; unsigned :4; unsigned CN21PUE:1;
+        unsigned CN22PUE:1; unsigned CN23PUE:1; unsigned CN24PUE:1;
+        unsigned :4; unsigned CN29PUE:1; unsigned CN30PUE:1;);
+#define CNPU2 sim_CNPU2.w
+#define CNPU2bits sim_CNPU2
+
+// Interrupt controller
+SIM_SFR(IFS0, unsigned INT0IF:1; unsigned IC1IF:1; unsigned OC1IF:1;
+        unsigned T1IF:1; unsigned :3; unsigned T2IF:1; unsigned T3IF:1;
+        unsigned SPF1IF:1; unsigned SPI1IF:1; unsigned U1RXIF:1;
+        unsigned U1TXIF:1; unsigned AD1IF:1; unsigned :1; unsigned NVMIF:1;);
+#define IFS0 sim_IFS0.w
+#define IFS0bits sim_IFS0
+
+SIM_SFR(IFS1, unsigned SI2C1IF:1; unsigned MI2C1IF:1; unsigned CMIF:1;
+        unsigned CNIF:1; unsigned INT1IF:1; unsigned :8; unsigned INT2IF:1;
+        unsigned U2RXIF:1; unsigned U2TXIF:1;);
+#define IFS1 sim_IFS1.w
+#define IFS1bits sim_IFS1
+
+SIM_SFR(IEC0, unsigned INT0IE:1; unsigned IC1IE:1; unsigned OC1IE:1;
+        unsigned T1IE:1; unsigned :3; unsigned T2IE:1; unsigned T3IE:1;
+        unsigned SPF1IE:1; unsigned SPI1IE:1; unsigned U1RXIE:1;
+        unsigned U1TXIE:1; unsigned AD1IE:1; unsigned :1; unsigned NVMIE:1;);
+#define IEC0 sim_IEC0.w
+#define IEC0bits sim_IEC0
+
+SIM_SFR(IEC1, unsigned SI2C1IE:1; unsigned MI2C1IE:1; unsigned CMIE:1;
+        unsigned CNIE:1; unsigned INT1IE:1; unsigned :8; unsigned INT2IE:1;
+        unsigned U2RXIE:1; unsigned U2TXIE:1;);
+#define IEC1 sim_IEC1.w
+#define IEC1bits sim_IEC1
+
+SIM_SFR(IPC0, unsigned INT0IP:3; unsigned :1; unsigned IC1IP:3;
+        unsigned :1; unsigned OC1IP:3; unsigned :1; unsigned T1IP:3;);
+#define IPC0 sim_IPC0.w
+#define IPC0bits sim_IPC0
+
+SIM_SFR(IPC1, unsigned :12; unsigned T2IP:3;);
+#define IPC1 sim_IPC1.w
+#define IPC1bits sim_IPC1
+
+SIM_SFR(IPC2, unsigned T3IP:3; unsigned :1; unsigned SPF1IP:3;
+        unsigned :1; unsigned SPI1IP:3; unsigned :1; unsigned U1RXIP:3;);
+#define IPC2 sim_IPC2.w
+#define IPC2bits sim_IPC2
+
+SIM_SFR(IPC3, unsigned U1TXIP:3; unsigned :1; unsigned AD1IP:3;
+        unsigned :5; unsigned NVMIP:3;);
+#define IPC3 sim_IPC3.w
+#define IPC3bits sim_IPC3
+
+SIM_SFR(IPC4, unsigned SI2C1IP:3; unsigned :1; unsigned MI2C1IP:3;
+        unsigned :1; unsigned CMIP:3; unsigned :1; unsigned CNIP:3;);
+#define IPC4 sim_IPC4.w
+#define IPC4bits sim_IPC4
+
+SIM_SFR(IPC7, unsigned :8; unsigned U2RXIP:3; unsigned :1;
+        unsigned U2TXIP:3;);
+#define IPC7 sim_IPC7.w
+#define IPC7bits sim_IPC7
+
+SIM_SFR(IFS3, unsigned :1; unsigned MI2C2IF:1; unsigned :12;
+        unsigned RTCIF:1;);
+#define IFS3 sim_IFS3.w
+#define IFS3bits sim_IFS3
+
+SIM_SFR(IEC3, unsigned :1; unsigned MI2C2IE:1; unsigned :12;
+        unsigned RTCIE:1;);
+#define IEC3 sim_IEC3.w
+#define IEC3bits sim_IEC3
+
+SIM_SFR(IPC15, unsigned :8; unsigned RTCIP:3;);
+#define IPC15 sim_IPC15.w
+#define IPC15bits sim_IPC15
+
+SIM_SFR(IFS4, unsigned :1; unsigned U1ERIF:1; unsigned U2ERIF:1;
+        unsigned :5; unsigned HLVDIF:1;);
+#define IFS4 sim_IFS4.w
+#define IFS4bits sim_IFS4
+
+SIM_SFR(IEC4, unsigned :1; unsigned U1ERIE:1; unsigned U2ERIE:1;
+        unsigned :5; unsigned HLVDIE:1;);
+#define IEC4 sim_IEC4.w
+#define IEC4bits sim_IEC4
+
+SIM_SFR(IPC18, unsigned HLVDIP:3;);
+#define IPC18 sim_IPC18.w
+#define IPC18bits sim_IPC18
+
+// Timers
+#define SIM_TCON_FIELDS \
+    unsigned :1; unsigned TCS:1; unsigned TSYNC:1; unsigned T32:1; \
+    unsigned TCKPS:2; unsigned TGATE:1; unsigned :6; unsigned TSIDL:1; \
+    unsigned :1; unsigned TON:1;
+
+SIM_SFR(T1CON, SIM_TCON_FIELDS);
+#define T1CON sim_T1CON.w
+#define T1CONbits sim_T1CON
+SIM_SFR(T2CON, SIM_TCON_FIELDS);
+#define T2CON sim_T2CON.w
+#define T2CONbits sim_T2CON
+SIM_SFR(T3CON, SIM_TCON_FIELDS);
+#define T3CON sim_T3CON.w
+#define T3CONbits sim_T3CON
+
+extern volatile uint16_t TMR1;
+extern volatile uint16_t TMR2;
+extern volatile uint16_t TMR3;
+extern volatile uint16_t PR1;
+extern volatile uint16_t PR2;
+extern volatile uint16_t PR3;
+
+// UART2
+SIM_SFR(U2MODE, unsigned STSEL:1; unsigned PDSEL:2; unsigned BRGH:1;
+        unsigned RXINV:1; unsigned ABAUD:1; unsigned LPBACK:1;
+        unsigned WAKE:1; unsigned UEN:2; unsigned :1; unsigned RTSMD:1;
+        unsigned IREN:1; unsigned USIDL:1; unsigned :1; unsigned UARTEN:1;);
+#define U2MODE sim_U2MODE.w
+#define U2MODEbits sim_U2MODE
+
+SIM_SFR(U2STA, unsigned URXDA:1; unsigned OERR:1; unsigned FERR:1;
+        unsigned PERR:1; unsigned RIDLE:1; unsigned ADDEN:1;
+        unsigned URXISEL:2; unsigned TRMT:1; unsigned UTXBF:1;
+        unsigned UTXEN:1; unsigned UTXBRK:1; unsigned :1;
+        unsigned UTXISEL0:1; unsigned UTXINV:1; unsigned UTXISEL1:1;);
+
+// Accessing U2STA is where the simulator takes what was written to the
+// transmit register, so status accesses go through a function.
+volatile U2STABITS *sim_u2sta(void);
+#define U2STA (sim_u2sta()->w)
+#define U2STAbits (*sim_u2sta())
+
+extern volatile uint16_t U2BRG;
+extern volatile uint16_t U2TXREG;
+
+// Reading U2RXREG takes the oldest character from the receive FIFO.
+uint16_t sim_u2rxreg(void);
+#define U2RXREG sim_u2rxreg()
+
+// I2C1, master only. A start, stop or byte written to I2C1TRN is taken
+// up by the simulator the next time the firmware idles, and raises MI2C1IF
+// once it has gone on the bus. Receiving is not modelled.
+SIM_SFR(I2C1CON, unsigned SEN:1; unsigned RSEN:1; unsigned PEN:1;
+        unsigned RCEN:1; unsigned ACKEN:1; unsigned ACKDT:1;
+        unsigned STREN:1; unsigned GCEN:1; unsigned SMEN:1;
+        unsigned DISSLW:1; unsigned A10M:1; unsigned IPMIEN:1;
+        unsigned SCLREL:1; unsigned I2CSIDL:1; unsigned :1;
+        unsigned I2CEN:1;);
+#define I2C1CON sim_I2C1CON.w
+#define I2C1CONbits sim_I2C1CON
+
+SIM_SFR(I2C1STAT, unsigned TBF:1; unsigned RBF:1; unsigned R_W:1;
+        unsigned S:1; unsigned P:1; unsigned D_A:1; unsigned I2COV:1;
+        unsigned IWCOL:1; unsigned ADD10:1; unsigned GCSTAT:1;
+        unsigned BCL:1; unsigned :3; unsigned TRSTAT:1;
+        unsigned ACKSTAT:1;);
+#define I2C1STAT sim_I2C1STAT.w
+#define I2C1STATbits sim_I2C1STAT
+
+extern volatile uint16_t I2C1BRG;
+extern volatile uint16_t I2C1TRN;
+
+// RTCC, clocked by the secondary oscillator. Only the alarm is
+// modelled: with AMASK = 0b0001 it raises RTCIF on every second once
+// RTCEN and SOSCEN are set and the crystal has started. The time and
+// date registers are not.
+SIM_SFR(RCFGCAL, unsigned CAL:8; unsigned RTCPTR:2; unsigned RTCOE:1;
+        unsigned HALFSEC:1; unsigned RTCSYNC:1; unsigned RTCWREN:1;
+        unsigned :1; unsigned RTCEN:1;);
+#define RCFGCAL sim_RCFGCAL.w
+#define RCFGCALbits sim_RCFGCAL
+
+SIM_SFR(ALCFGRPT, unsigned ARPT:8; unsigned ALRMPTR:2; unsigned AMASK:4;
+        unsigned CHIME:1; unsigned ALRMEN:1;);
+#define ALCFGRPT sim_ALCFGRPT.w
+#define ALCFGRPTbits sim_ALCFGRPT
+
+#define __builtin_write_RTCWEN() (sim_RCFGCAL.RTCWREN = 1)
+
+// Data EEPROM. Table reads and writes go through the offset returned by
+// the last __builtin_tbloffset() call, which is how the firmware uses
+// them. __builtin_write_NVM() starts the operation in NVMCON and raises
+// NVMIF when it completes, a few milliseconds of virtual time later.
+SIM_SFR(NVMCON, unsigned NVMOP:6; unsigned ERASE:1; unsigned :5;
+        unsigned PGMONLY:1; unsigned WRERR:1; unsigned WREN:1;
+        unsigned WR:1;);
+#define NVMCON sim_NVMCON.w
+#define NVMCONbits sim_NVMCON
+
+extern volatile uint16_t TBLPAG;
+
+#define space(x)
+#define __builtin_tblpage(p) ((uint16_t)0x7F)
+uint16_t sim_tbloffset(const volatile void *p);
+uint16_t sim_tblrdl(uint16_t offset);
+void sim_tblwtl(uint16_t offset, uint16_t data);
+void sim_write_nvm(void);
+#define __builtin_tbloffset(p) sim_tbloffset(p)
+#define __builtin_tblrdl(offset) sim_tblrdl(offset)
+#define __builtin_tblwtl(offset, data) sim_tblwtl(offset, data)
+#define __builtin_write_NVM() sim_write_nvm()
+
+// CPU interrupt priority. Raising it masks interrupts at or below the
+// level; lowering it services anything now unmasked.
+extern uint8_t sim_cpu_ipl;
+void sim_set_cpu_ipl(uint8_t ipl);
+#define SET_CPU_IPL(ipl) sim_set_cpu_ipl(ipl)
+#define SET_AND_SAVE_CPU_IPL(save_to, ipl) \
+    do { (save_to) = sim_cpu_ipl; sim_set_cpu_ipl(ipl); } while (0)
+#define RESTORE_CPU_IPL(saved_to) sim_set_cpu_ipl(saved_to)
+
+// Code takes no virtual time, so a DISI window can never be interrupted.
+#define __builtin_disi(cycles) do{}while(0)
+
+// The 16 x 16 bit unsigned multiply instruction.
+#define __builtin_muluu(a, b) ((uint32_t)(uint16_t)(a) * (uint16_t)(b))
+
+// Power saving instructions
+void sim_idle(void);
+void sim_sleep(void);
+#define Idle() sim_idle()
+#define Sleep() sim_sleep()
+#define Nop() do{}while(0)
+#define ClrWdt() do{}while(0)
+
+#endif	/* SIM_XC_H */
@@ -0,0 +1,564 @@
+/*
+ * File:   replay.c
+ * Author: Andy Smit
+ *
+ * Time-warp replay harness. Drives the real firmware with recorded
+ * button traces on the simulator's virtual clock and reports state
+ * transition timing, missed button events and UART output.
+ *
+ * usage: replay [-v] [-s] [-t] [-k PCT] [-B MAH] [-u FILE] TRACE...
+ *        replay -b PCT,PCT... [-v] TRACE
+ *        replay -g SEED:SESSIONS > TRACE
+ *
+ *   -v          log every state transition to stderr
+ *   -s          measure and print the stack used by each ISR (slower)
+ *   -t          print the scheduler statistics of each task
+ *   -k PCT      run the RC oscillators PCT percent off nominal, and print
+ *               the firmware's clock estimate and countdown accuracy
+ *   -B MAH      run from a battery of MAH mAh, and print the charge used
+ *               and when the battery browned out (see sim_set_battery)
+ *   -u FILE     append the UART output of every trace to FILE ("-" for
+ *               stdout)
+ *   -b PCT,...  run one unit per PCT on a virtual bus, each with its RC
+ *               oscillators PCT percent off nominal. The first unit
+ *               takes the trace and its TX drives the RX of the others,
+ *               as for countdown sync (src/sync.c). Prints when each
+ *               unit's countdowns ended and how far apart they were.
+ *   -g S:N      write a synthetic trace of N countdown sessions
+ *
+ * Each trace runs in its own process so firmware globals start from
+ * their reset values. The summary line makes a corpus run usable as a
+ * regression benchmark: the UART hash changes if the output does. A
+ * trace's "expect" line for the build pins the hash, sessions and
+ * transitions, and a run without -k or -B that differs fails.
+ *
+ * Code takes no virtual time (see sim.h), so the waits reported, of a
+ * button for its state change and of a task to start and to finish, are
+ * only those on the hardware: the UART, the EEPROM and the timers.
+ *
+ * The boot times reported by the firmware are checked against the
+ * budgets in boot.h; a trace over budget fails the run, as does the
+ * alarm sounding outside the alarm state, its text sent on a line of
+ * other output or a task finishing past its deadline.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "sim.h"
+#include "boot.h"
+#include "sched.h"
+#include "timebase.h"
+#include "board.h"
+#include "lcd.h"
+#undef main
+
+// Units on a virtual bus
+#define BUS_MAX_UNITS 8
+
+
+static int replay_one(const char *path, sim_result_t *r, const char *uart,
+                      int verbose)
+{
+    static sim_trace_t trace;
+    int fds[2];
+    pid_t pid;
+    int status;
+
+    if (pipe(fds))
+    {
+        return -1;
+    }
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        FILE *uart_out = NULL;
+        close(fds[0]);
+        if (sim_trace_load(path, &trace))
+        {
+            _exit(2);
+        }
+        if (uart)
+        {
+            uart_out = strcmp(uart, "-") ? fopen(uart, "a") : stdout;
+        }
+        sim_run(&trace, r, uart_out, verbose ? stderr : NULL);
+        if (uart_out)
+        {
+            fflush(uart_out);
+        }
+        if (write(fds[1], r, sizeof(*r)) != sizeof(*r))
+        {
+            _exit(3);
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    if (pid < 0 || read(fds[0], r, sizeof(*r)) != sizeof(*r))
+    {
+        close(fds[0]);
+        waitpid(pid, &status, 0);
+        return -1;
+    }
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+    return 0;
+}
+
+
+/*
+ * bus_io
+ *
+ * Read or write all of a buffer on a pipe.
+ *
+ * @return 0 on success, -1 if the other end has gone
+ */
+static int bus_io(int write_fd, int fd, void *buf, size_t size)
+{
+    uint8_t *p = buf;
+    while (size)
+    {
+        ssize_t n = write_fd ? write(fd, p, size) : read(fd, p, size);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+
+/*
+ * replay_bus
+ *
+ * Replay a trace through the first of n units on a virtual bus, with
+ * the other units listening to its TX. Each unit runs in its own
+ * process; this one passes the characters between them at the end of
+ * every bus quantum (see sim_bus_attach).
+ *
+ * @return 0 if every unit ran, -1 otherwise
+ */
+static int replay_bus(const char *path, const double *skews, int n,
+                      sim_result_t *r, int verbose)
+{
+    static sim_trace_t trace;
+    int to_unit[BUS_MAX_UNITS];
+    int from_unit[BUS_MAX_UNITS];
+    uint8_t live[BUS_MAX_UNITS];
+    sim_event_t *sent = NULL;
+    uint32_t sent_capacity = 0;
+    int running = 0;
+    int i;
+
+    if (sim_trace_load(path, &trace))
+    {
+        return -1;
+    }
+    fflush(stdout);
+    for (i = 0; i < n; i++)
+    {
+        int up[2], down[2];
+        pid_t pid;
+        if (pipe(up) || pipe(down))
+        {
+            return -1;
+        }
+        pid = fork();
+        if (pid == 0)
+        {
+            // Only the first unit gets the trace's events
+            sim_trace_t quiet = {NULL, 0, trace.end_ns};
+            sim_result_t result;
+            sim_bus_header_t done = {0, 1};
+            close(up[0]);
+            close(down[1]);
+            sim_set_clock_skew((int32_t)(skews[i] * 10000));
+            sim_bus_attach(up[1], down[0]);
+            sim_run(i ? &quiet : &trace, &result, NULL,
+                    verbose ? stderr : NULL);
+            if (bus_io(1, up[1], &done, sizeof(done))
+                || bus_io(1, up[1], &result, sizeof(result)))
+            {
+                _exit(3);
+            }
+            _exit(0);
+        }
+        close(up[1]);
+        close(down[0]);
+        if (pid < 0)
+        {
+            return -1;
+        }
+        from_unit[i] = up[0];
+        to_unit[i] = down[1];
+        live[i] = 1;
+        running++;
+    }
+
+    while (running)
+    {
+        uint32_t sent_count = 0;
+        for (i = 0; i < n; i++)
+        {
+            sim_bus_header_t header;
+            if (!live[i])
+            {
+                continue;
+            }
+            if (bus_io(0, from_unit[i], &header, sizeof(header)))
+            {
+                return -1;
+            }
+            if (header.done)
+            {
+                if (bus_io(0, from_unit[i], &r[i], sizeof(r[i])))
+                {
+                    return -1;
+                }
+                live[i] = 0;
+                running--;
+                close(to_unit[i]);
+                continue;
+            }
+            if (sent_count + header.count > sent_capacity)
+            {
+                sent_capacity = (sent_count + header.count) * 2;
+                sent = realloc(sent, sent_capacity * sizeof(sim_event_t));
+            }
+            if (bus_io(0, from_unit[i], &sent[sent_count],
+                       header.count * sizeof(sim_event_t)))
+            {
+                return -1;
+            }
+            // Only the leader's TX is on the bus
+            if (i == 0)
+            {
+                sent_count += header.count;
+            }
+        }
+        for (i = 0; i < n; i++)
+        {
+            uint32_t count = i ? sent_count : 0;
+            if (live[i]
+                && (bus_io(1, to_unit[i], &count, sizeof(count))
+                    || bus_io(1, to_unit[i], sent, count * sizeof(sim_event_t))))
+            {
+                return -1;
+            }
+        }
+    }
+    for (i = 0; i < n; i++)
+    {
+        close(from_unit[i]);
+        wait(NULL);
+    }
+    free(sent);
+    return 0;
+}
+
+
+/*
+ * report_bus
+ *
+ * Print each unit of a bus run, then how far apart the units' countdowns
+ * ended.
+ *
+ * @return 1 if a task overran its deadline on any unit, otherwise 0
+ */
+static int report_bus(const char *path, const double *skews, int n,
+                      const sim_result_t *r)
+{
+    uint32_t sessions = r[0].sessions;
+    uint64_t worst = 0;
+    int failed = 0;
+    uint32_t s;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        uint8_t t;
+        printf("%s: unit %d %+.2f%%: %u sessions, %u transitions, "
+               "uart %u B at %u baud\n",
+               path, i, skews[i], r[i].sessions, r[i].transitions,
+               r[i].uart_bytes, r[i].uart_baud);
+        if (r[i].sessions < sessions)
+        {
+            sessions = r[i].sessions;
+        }
+        for (t = 0; t < SCHED_NUM_TASKS; t++)
+        {
+            if (r[i].tasks[t].overruns)
+            {
+                printf("%s: unit %d task %s overran its deadline %u times\n",
+                       path, i, SCHED_task_name(t), r[i].tasks[t].overruns);
+                failed = 1;
+            }
+        }
+    }
+    if (sessions > SIM_MAX_FINISHES)
+    {
+        sessions = SIM_MAX_FINISHES;
+    }
+    for (s = 0; s < sessions; s++)
+    {
+        uint64_t first = r[0].finish_ns[s];
+        uint64_t last = first;
+        printf("%s: countdown %u ended", path, s + 1);
+        for (i = 0; i < n; i++)
+        {
+            uint64_t t = r[i].finish_ns[s];
+            printf(" %.3f", t / 1e6);
+            first = t < first ? t : first;
+            last = t > last ? t : last;
+        }
+        printf(" ms, spread %.3f ms\n", (last - first) / 1e6);
+        worst = last - first > worst ? last - first : worst;
+    }
+    printf("%s: %d units, %u countdowns, worst spread %.3f ms\n", path, n,
+           sessions, worst / 1e6);
+    return failed;
+}
+
+
+int main(int argc, char **argv)
+{
+    const char *uart = NULL;
+    int verbose = 0;
+    int stack = 0;
+    int tasks = 0;
+    double skew = 0;
+    double battery = 0;
+    double bus[BUS_MAX_UNITS];
+    int units = 0;
+    int opt;
+    int failed = 0;
+    uint32_t traces = 0;
+    uint64_t sim_ns = 0;
+    uint64_t sessions = 0;
+    struct timespec t0, t1;
+    double wall;
+
+    while ((opt = getopt(argc, argv, "vstk:B:u:b:g:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'v':
+                verbose = 1;
+                break;
+            case 's':
+                stack = 1;
+                break;
+            case 't':
+                tasks = 1;
+                break;
+            case 'k':
+                skew = atof(optarg);
+                break;
+            case 'B':
+                battery = atof(optarg);
+                break;
+            case 'u':
+                uart = optarg;
+                break;
+            case 'b':
+            {
+                char *p = optarg;
+                for (units = 0; units < BUS_MAX_UNITS && *p; units++)
+                {
+                    bus[units] = strtod(p, &p);
+                    if (*p == ',')
+                    {
+                        p++;
+                    }
+                }
+                if (units < 2 || *p)
+                {
+                    fprintf(stderr, "-b expects 2 to %d rates\n",
+                            BUS_MAX_UNITS);
+                    return 2;
+                }
+                break;
+            }
+            case 'g':
+            {
+                unsigned int seed, n;
+                if (sscanf(optarg, "%u:%u", &seed, &n) != 2)
+                {
+                    fprintf(stderr, "-g expects SEED:SESSIONS\n");
+                    return 2;
+                }
+                sim_trace_generate(stdout, seed, n);
+                return 0;
+            }
+            default:
+                fprintf(stderr, "usage: %s [-v] [-s] [-t] [-k PCT] [-B MAH] [-u FILE] "
+                                "TRACE...\n"
+                                "       %s -b PCT,PCT... [-v] TRACE\n"
+                                "       %s -g SEED:SESSIONS\n",
+                        argv[0], argv[0], argv[0]);
+                return 2;
+        }
+    }
+
+    // Resolve every shared library symbol at load. Lazy binding runs the
+    // dynamic linker on the first call to each function, which would be
+    // counted in the stack of whichever ISR made that call.
+    if (stack && !getenv("LD_BIND_NOW"))
+    {
+        setenv("LD_BIND_NOW", "1", 1);
+        execv("/proc/self/exe", argv);
+    }
+    if (units)
+    {
+        sim_result_t r[BUS_MAX_UNITS];
+        if (optind + 1 != argc)
+        {
+            fprintf(stderr, "-b replays one trace\n");
+            return 2;
+        }
+        if (replay_bus(argv[optind], bus, units, r, verbose))
+        {
+            printf("%s: FAILED\n", argv[optind]);
+            return 1;
+        }
+        return report_bus(argv[optind], bus, units, r);
+    }
+    sim_isr_stack_check(stack);
+    sim_set_clock_skew((int32_t)(skew * 10000));
+    sim_set_battery((uint32_t)(battery * 1000));
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (; optind < argc; optind++)
+    {
+        sim_result_t r;
+        uint8_t i;
+        if (replay_one(argv[optind], &r, uart, verbose))
+        {
+            printf("%s: FAILED\n", argv[optind]);
+            failed = 1;
+            continue;
+        }
+        printf("%s: %.3f s, %u sessions, %u transitions, %u missed, "
+               "max wait %.3f ms, uart %u B %08x %.1f ms at %u baud, "
+               "boot display %.3f ms response %.3f ms, led %.2f%%, "
+               "tone %.1f s, alarm text %.3f ms\n",
+               argv[optind], r.sim_ns / 1e9, r.sessions, r.transitions,
+               r.missed_events, r.max_latency_ns / 1e6, r.uart_bytes,
+               r.uart_hash, r.uart_tx_ns / 1e6, r.uart_baud,
+               r.boot_display_ns / 1e6,
+               r.boot_response_ns / 1e6,
+               r.sim_ns ? 100.0 * r.led_on_ns / r.sim_ns : 0.0,
+               r.tone_ns / 1e9, r.max_alarm_ns / 1e6);
+        if (BOARD_HAS_DISPLAY)
+        {
+            printf("%s: display %s, lit %.1f%%, %.0f refresh interrupts/s\n",
+                   argv[optind], r.display,
+                   r.sim_ns ? 100.0 * r.display_lit_ns / r.sim_ns : 0.0,
+                   r.sim_ns ? r.display_irqs / (r.sim_ns / 1e9) : 0.0);
+        }
+        if (LCD_I2C)
+        {
+            printf("%s: lcd \"%s\" \"%s\", %u I2C bytes, %u early\n",
+                   argv[optind], r.lcd[0], r.lcd[1], r.i2c_bytes,
+                   r.lcd_early);
+        }
+        if (stack)
+        {
+            printf("%s: ISR stack (host bytes):", argv[optind]);
+            for (i = 0; i < SIM_NUM_VECTORS; i++)
+            {
+                if (r.isr_stack[i])
+                {
+                    printf(" %s %u", sim_vector_names[i], r.isr_stack[i]);
+                }
+            }
+            putchar('\n');
+        }
+        if (skew != 0)
+        {
+            printf("%s: fcy %u Hz, estimated %u Hz (%+.2f%%), "
+                   "%u countdowns off by %+.3f ms at worst, %+.3f ms last\n",
+                   argv[optind], r.fcy_hz, r.fcy_estimate_hz,
+                   100.0 * ((double)r.fcy_estimate_hz - r.fcy_hz) / r.fcy_hz,
+                   r.countdowns, r.max_countdown_error_ns / 1e6,
+                   r.last_countdown_error_ns / 1e6);
+        }
+        if (battery != 0)
+        {
+            printf("%s: battery %.4f mAh used, %.1f uA average, %u mV",
+                   argv[optind], r.charge_fc / 3.6e15,
+                   r.sim_ns ? r.charge_fc / (double)r.sim_ns : 0.0,
+                   r.vdd_mv);
+            if (r.brownout_ns)
+            {
+                printf(", browned out at %.1f s", r.brownout_ns / 1e9);
+            }
+            putchar('\n');
+        }
+        for (i = 0; i < SCHED_NUM_TASKS; i++)
+        {
+            const sched_stats_t *t = &r.tasks[i];
+            if (tasks && t->runs)
+            {
+                printf("%s: task %-9s %6u runs, %u merged, start wait %.3f ms, "
+                       "run wait %.3f ms, deadline %.0f ms\n",
+                       argv[optind], SCHED_task_name(i), t->runs, t->merged,
+                       t->max_latency * TIMEBASE_TICK_US / 1e3,
+                       t->max_run * TIMEBASE_TICK_US / 1e3,
+                       SCHED_task_deadline(i) * TIMEBASE_TICK_US / 1e3);
+            }
+            if (t->overruns)
+            {
+                printf("%s: task %s overran its deadline %u times\n",
+                       argv[optind], SCHED_task_name(i), t->overruns);
+                failed = 1;
+            }
+        }
+        if (r.expect.expected && skew == 0 && battery == 0
+            && (r.uart_hash != r.expect.uart_hash
+                || r.sessions != r.expect.sessions
+                || r.transitions != r.expect.transitions))
+        {
+            printf("%s: expected uart %08x, %u sessions, %u transitions "
+                   "for %s\n", argv[optind], r.expect.uart_hash,
+                   r.expect.sessions, r.expect.transitions, sim_build);
+            failed = 1;
+        }
+        if (r.alarm_cuts)
+        {
+            printf("%s: alarm text cut into a line %u times\n",
+                   argv[optind], r.alarm_cuts);
+            failed = 1;
+        }
+        if (r.stray_tone_ns)
+        {
+            printf("%s: alarm sounded for %.3f ms outside TIMER_FINISH\n",
+                   argv[optind], r.stray_tone_ns / 1e6);
+            failed = 1;
+        }
+        if (r.boot_display_ns > BOOT_BUDGET_DISPLAY_MS * 1000000ULL
+            || r.boot_response_ns > BOOT_BUDGET_RESPONSE_MS * 1000000ULL)
+        {
+            printf("%s: boot over budget (display %d ms, response %d ms)\n",
+                   argv[optind], BOOT_BUDGET_DISPLAY_MS,
+                   BOOT_BUDGET_RESPONSE_MS);
+            failed = 1;
+        }
+        traces++;
+        sim_ns += r.sim_ns;
+        sessions += r.sessions;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("%u traces, %llu sessions, %.1f s virtual in %.3f s wall "
+           "(%.0fx, %.0f sessions/s)\n",
+           traces, (unsigned long long)sessions, sim_ns / 1e9, wall,
+           wall > 0 ? sim_ns / 1e9 / wall : 0.0,
+           wall > 0 ? sessions / wall : 0.0);
+    return failed;
+}
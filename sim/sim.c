@@ -0,0 +1,2150 @@
+/*
+ * File:   sim.c
+ * Author: Andy Smit
+ *
+ * Virtual clock and peripheral models for the host simulator. See sim.h.
+ */
+
+#include <setjmp.h>
+#include <ucontext.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+#include "main.h"
+#include "boot.h"
+#include "board.h"
+#include "clock.h"
+#include "eeprom.h"
+#include "battery.h"
+#include "lcd.h"
+#include "profile.h"
+#include "bench.h"
+
+// Interrupt service routines from the firmware.
+void _T1Interrupt(void);
+void _T2Interrupt(void);
+void _CNInterrupt(void);
+void _U2TXInterrupt(void);
+void _U2RXInterrupt(void);
+void _NVMInterrupt(void);
+void _RTCCInterrupt(void);
+void _HLVDInterrupt(void);
+// Only on boards with a pot
+void _ADC1Interrupt(void) __attribute__((weak));
+// Only on boards with a 7-segment display
+void _T3Interrupt(void) __attribute__((weak));
+// Only with the LCD
+void _MI2C1Interrupt(void) __attribute__((weak));
+
+#define NS_PER_S 1000000000ULL
+#define NEVER UINT64_MAX
+
+const char sim_build[] = BOARD_NAME
+#if LCD_I2C
+    "+lcd"
+#endif
+#ifdef CLOCK_FRC_8MHZ
+    "+frc8"
+#endif
+#if !BATTERY_POLICY
+    "+nopolicy"
+#endif
+#if PROFILE
+    "+profile"
+#endif
+#if BENCH_BOOT
+    "+bench"
+#endif
+    ;
+
+// Special function registers
+volatile INTCON1BITS sim_INTCON1;
+volatile OSCCONBITS sim_OSCCON;
+volatile CLKDIVBITS sim_CLKDIV;
+volatile OSCTUNBITS sim_OSCTUN;
+volatile REFOCONBITS sim_REFOCON;
+volatile PMD1BITS sim_PMD1;
+volatile PMD2BITS sim_PMD2;
+volatile PMD3BITS sim_PMD3;
+volatile PMD4BITS sim_PMD4;
+volatile TRISABITS sim_TRISA;
+volatile PORTABITS sim_PORTA;
+volatile LATABITS sim_LATA;
+volatile TRISBBITS sim_TRISB;
+volatile PORTBBITS sim_PORTB;
+volatile LATBBITS sim_LATB;
+volatile uint16_t AD1PCFG;
+volatile AD1CON1BITS sim_AD1CON1;
+volatile AD1CON2BITS sim_AD1CON2;
+volatile AD1CON3BITS sim_AD1CON3;
+volatile AD1CHSBITS sim_AD1CHS;
+volatile uint16_t sim_adc1buf[16];
+volatile HLVDCONBITS sim_HLVDCON;
+volatile CNEN1BITS sim_CNEN1;
+volatile CNEN2BITS sim_CNEN2;
+volatile CNPU1BITS sim_CNPU1;
+volatile CNPU2BITS sim_CNPU2;
+volatile IFS0BITS sim_IFS0;
+volatile IFS1BITS sim_IFS1;
+volatile IEC0BITS sim_IEC0;
+volatile IEC1BITS sim_IEC1;
+volatile IPC0BITS sim_IPC0;
+volatile IPC1BITS sim_IPC1;
+volatile IPC2BITS sim_IPC2;
+volatile IPC3BITS sim_IPC3;
+volatile IPC4BITS sim_IPC4;
+volatile IPC7BITS sim_IPC7;
+volatile IFS3BITS sim_IFS3;
+volatile IEC3BITS sim_IEC3;
+volatile IPC15BITS sim_IPC15;
+volatile IFS4BITS sim_IFS4;
+volatile IEC4BITS sim_IEC4;
+volatile IPC18BITS sim_IPC18;
+volatile RCFGCALBITS sim_RCFGCAL;
+volatile ALCFGRPTBITS sim_ALCFGRPT;
+volatile T1CONBITS sim_T1CON;
+volatile T2CONBITS sim_T2CON;
+volatile T3CONBITS sim_T3CON;
+volatile uint16_t TMR1;
+volatile uint16_t TMR2;
+volatile uint16_t TMR3;
+volatile uint16_t PR1;
+volatile uint16_t PR2;
+volatile uint16_t PR3;
+volatile U2MODEBITS sim_U2MODE;
+volatile U2STABITS sim_U2STA;
+volatile uint16_t U2BRG;
+volatile uint16_t U2TXREG;
+volatile OC1CONBITS sim_OC1CON;
+volatile uint16_t OC1R;
+volatile uint16_t OC1RS;
+volatile NVMCONBITS sim_NVMCON;
+volatile uint16_t TBLPAG;
+volatile I2C1CONBITS sim_I2C1CON;
+volatile I2C1STATBITS sim_I2C1STAT;
+volatile uint16_t I2C1BRG;
+volatile uint16_t I2C1TRN;
+
+// U2TXREG holds this value while the transmitter is empty.
+#define TXREG_EMPTY 0xFFFF
+
+// UART transmitter model. A character written to U2TXREG is taken into a
+// 4 deep buffer at the next access to U2STA, and from there into the
+// shift register, which sends it in one character time. U2TXIF is raised
+// as UTXISEL selects.
+#define TX_FIFO_DEPTH 4
+static uint8_t tx_fifo[TX_FIFO_DEPTH];
+static uint8_t tx_count;
+// When the character in the shift register has gone, or NEVER if empty.
+static uint64_t tx_shift_ns;
+static void tx_shifted(void);
+// The last characters sent, and when the alarm state was entered if its
+// text has not been sent since, otherwise NEVER.
+#define ALARM_TEXT "ALARM"
+static char tx_recent[sizeof(ALARM_TEXT) - 1];
+static uint64_t alarm_from_ns;
+// The characters of the terminal line since the last CR or LF, as many
+// as fit, and whether the alarm text ended it so far. The text may only
+// follow the countdown's "MMm:SSs" (see app_display_time); any other
+// text on its line is a write it cut into, counted in alarm_cuts.
+static char tx_line[sizeof("00m:00s -- " ALARM_TEXT)];
+static uint16_t tx_line_len;
+static uint8_t tx_alarm_ended;
+
+// UART receiver model. Characters go through a 4 deep FIFO, each with
+// its framing error. A character sent at a rate more than RX_TOLERANCE_PCT
+// from the receiver's is received with a framing error.
+#define RX_FIFO_DEPTH 4
+#define RX_TOLERANCE_PCT 3
+static struct
+{
+    uint8_t c;
+    uint8_t ferr;
+} rx_fifo[RX_FIFO_DEPTH];
+static uint8_t rx_count;
+static uint8_t rx_overrun;
+
+// I2C master model. I2C1TRN holds I2C_TRN_EMPTY while no byte is waiting
+// to go. A start or stop condition takes a bit time and a byte nine, at
+// the rate I2C1BRG sets with the 100ns delay of the datasheet's formula,
+// and MI2C1IF is raised as each ends. The only device on the bus is an
+// LCD's PCF8574 at PCF_ADDRESS, which acknowledges its address and every
+// byte written to it; any other address is not acknowledged.
+#define I2C_TRN_EMPTY 0xFFFF
+#define I2C_DELAY_NS 100
+#define PCF_ADDRESS 0x27
+typedef enum
+{
+    I2C_IDLE = 0,
+    I2C_START,
+    I2C_BYTE,
+    I2C_STOP
+} i2c_op_t;
+static i2c_op_t i2c_op;
+static uint64_t i2c_done_ns;
+static uint8_t i2c_byte;
+// The next byte is an address, and the PCF8574 was addressed
+static uint8_t i2c_address_next;
+static uint8_t i2c_pcf;
+
+// LCD model: an HD44780 in a 16x2 module, its RS, RW and E on P0-P2 of
+// the PCF8574 and D4-D7 on P4-P7, D0-D3 left low. It takes a nibble as E
+// falls. Until it is set to 4 bit mode each nibble is an instruction of
+// its own. An instruction or character sent while the LCD is still busy
+// with the one before, or in the 40ms after power up, is counted as
+// early: on a real LCD it may be lost. The busy times are the datasheet's
+// at 270kHz. The reset sequence is in 8 bit mode; its first Function Set
+// takes 4.1ms and the rest 100us.
+#define HD_POWER_UP_NS 40000000ULL
+#define HD_E 0x04
+#define HD_RW 0x02
+#define HD_RS 0x01
+static uint8_t pcf_port;
+static uint8_t hd_ddram[0x80];
+static uint8_t hd_addr;
+static uint8_t hd_8bit;
+static uint8_t hd_on;
+// A high nibble has been taken in 4 bit mode
+static uint8_t hd_half;
+static uint8_t hd_high;
+static uint8_t hd_resets;
+static uint64_t hd_busy_ns;
+
+// Timer model. TMRx counts Fcy / prescale and sets the interrupt flag
+// on the tick after it matches PRx.
+typedef struct
+{
+    volatile T1CONBITS *con;
+    volatile uint16_t *tmr;
+    volatile uint16_t *pr;
+    volatile uint16_t *ifs;
+    uint8_t ifs_bit;
+    uint8_t pmd_bit;
+    uint16_t acc;
+} sim_timer_t;
+
+// T2CON and T3CON share T1CON's layout.
+static sim_timer_t timers[3] = {
+    {(volatile T1CONBITS *)&sim_T1CON, &TMR1, &PR1, &sim_IFS0.w, 3, 11, 0},
+    {(volatile T1CONBITS *)&sim_T2CON, &TMR2, &PR2, &sim_IFS0.w, 7, 12, 0},
+    {(volatile T1CONBITS *)&sim_T3CON, &TMR3, &PR3, &sim_IFS0.w, 8, 13, 0},
+};
+
+// Interrupt vector model.
+typedef struct
+{
+    volatile uint16_t *ifs;
+    uint8_t ifs_bit;
+    volatile uint16_t *iec;
+    uint8_t iec_bit;
+    volatile uint16_t *ipc;
+    uint8_t ipc_shift;
+    void (*isr)(void);
+} sim_vector_t;
+
+static const sim_vector_t vectors[SIM_NUM_VECTORS] = {
+    {&sim_IFS0.w, 3, &sim_IEC0.w, 3, &sim_IPC0.w, 12, _T1Interrupt},
+    {&sim_IFS0.w, 7, &sim_IEC0.w, 7, &sim_IPC1.w, 12, _T2Interrupt},
+    {&sim_IFS1.w, 3, &sim_IEC1.w, 3, &sim_IPC4.w, 12, _CNInterrupt},
+    {&sim_IFS1.w, 14, &sim_IEC1.w, 14, &sim_IPC7.w, 8, _U2RXInterrupt},
+    {&sim_IFS1.w, 15, &sim_IEC1.w, 15, &sim_IPC7.w, 12, _U2TXInterrupt},
+    {&sim_IFS0.w, 15, &sim_IEC0.w, 15, &sim_IPC3.w, 12, _NVMInterrupt},
+    {&sim_IFS3.w, 14, &sim_IEC3.w, 14, &sim_IPC15.w, 8, _RTCCInterrupt},
+    {&sim_IFS4.w, 8, &sim_IEC4.w, 8, &sim_IPC18.w, 0, _HLVDInterrupt},
+    {&sim_IFS0.w, 13, &sim_IEC0.w, 13, &sim_IPC3.w, 4, _ADC1Interrupt},
+    {&sim_IFS0.w, 8, &sim_IEC0.w, 8, &sim_IPC2.w, 0, _T3Interrupt},
+    {&sim_IFS1.w, 1, &sim_IEC1.w, 1, &sim_IPC4.w, 4, _MI2C1Interrupt},
+};
+const char *const sim_vector_names[SIM_NUM_VECTORS] = {
+    "T1", "T2", "CN", "U2RX", "U2TX", "NVM", "RTCC", "HLVD", "AD1", "T3",
+    "MI2C1"
+};
+#define VECTOR_T3 9
+#define NUM_VECTORS SIM_NUM_VECTORS
+
+// Data EEPROM model. The firmware's eedata array is host memory; the
+// table latch holds the address for the next operation.
+#define NVM_OP_NS 4000000ULL
+static volatile uint8_t *tbl_base;
+static uint16_t tbl_latch_offset;
+static uint16_t tbl_latch_data;
+static uint64_t nvm_done_ns;
+
+// Oscillator model. The RC oscillators run off nominal by the skew set
+// with sim_set_clock_skew, and each OSCTUN step moves the FRC by
+// FRC_TUN_STEP_PPM. The crystal is exact and starts SOSC_START_NS after
+// it is enabled; the RTCC alarm is then due every second.
+#define FRC_TUN_STEP_PPM 3750
+#define SOSC_START_NS 500000000ULL
+static int32_t clock_skew_ppm = 0;
+static uint64_t rtcc_next_ns;
+
+// Supply model. The current drawn is the core's idle current, which
+// scales with Fcy; the LED while lit, the piezo while sounding, each
+// segment of the 7-segment display while lit, and the HLVD and ADC while
+// enabled. These are rough typical figures for the
+// PIC24F16KA101 at 3V. Code takes no time and the firmware waits for the
+// UART in Idle, so the CPU's own current never adds to it.
+//
+// Without a battery (sim_set_battery) the supply holds at SUPPLY_MV.
+// With one it falls linearly from BATTERY_FULL_MV as the charge is
+// used, to the brown-out reset at BOR_MV once all of it is, which ends
+// the run. The supply is sampled at least every SUPPLY_STEP_NS.
+#define IDD_IDLE_UA(fcy) (20 + (fcy) / 10000)
+#define LED_UA 3000
+#define TONE_UA 500
+#define HLVD_UA 5
+#define ADC_UA 500
+#define SEGMENT_UA 2000
+#define SUPPLY_MV 3300
+#define BATTERY_FULL_MV 3000
+#define BOR_MV 2000
+#define SUPPLY_STEP_NS NS_PER_S
+// 1 mAh in fC (uA x ns)
+#define FC_PER_MAH 3600000000000000ULL
+static uint64_t battery_fc = 0;
+
+// Typical HLVD trip points in mV for each HLVDL. 0b1111 selects the
+// external input, which is not modelled.
+static const uint16_t hlvd_trip_mv[15] = {
+    1850, 1950, 2050, 2150, 2250, 2400, 2500, 2600, 2700, 2800, 2950, 3100,
+    3250, 3400, 3550
+};
+
+// ADC model. The ADC clock is its RC oscillator, the only one the
+// firmware uses. Each conversion of the pot reads its code with up to
+// ADC_NOISE codes of noise either way.
+#define ADC_TAD_NS 250
+#define ADC_NOISE 2
+static uint64_t adc_done_ns;
+static uint16_t pot_code;
+static uint32_t adc_noise_state;
+
+#if BOARD_HAS_DISPLAY
+// 7-segment display model. The digit selected and its segments are read
+// from the port latch, and each segment lit is decoded back to a digit.
+static const uint8_t display_glyphs[10] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F
+};
+static const uint8_t display_seg_bits[7] = {
+    BOARD_DISPLAY_SEG_A, BOARD_DISPLAY_SEG_B, BOARD_DISPLAY_SEG_C,
+    BOARD_DISPLAY_SEG_D, BOARD_DISPLAY_SEG_E, BOARD_DISPLAY_SEG_F,
+    BOARD_DISPLAY_SEG_G
+};
+// Where each digit goes in sim_result_t.display, "MM:SS"
+static const uint8_t display_places[4] = {0, 1, 3, 4};
+#endif
+
+// Virtual bus, see sim_bus_attach. Characters sent since the last
+// exchange, and characters from the bus waiting to arrive.
+static int bus_out = -1;
+static int bus_in = -1;
+static uint64_t bus_next_ns = UINT64_MAX;
+static sim_event_t *bus_tx;
+static uint32_t bus_tx_count;
+static uint32_t bus_tx_capacity;
+static sim_event_t *bus_rx;
+static uint32_t bus_rx_head;
+static uint32_t bus_rx_count;
+static uint32_t bus_rx_capacity;
+
+// Run state
+static const sim_trace_t *trace;
+static sim_result_t *result;
+static FILE *uart_out;
+static FILE *log_out;
+static jmp_buf done;
+static uint64_t now_ns;
+static uint64_t ns_rem;
+static uint32_t next_event;
+static uint64_t last_input_ns;
+static uint8_t in_isr;
+uint8_t sim_cpu_ipl;
+static App_State last_state;
+// Last timebase interrupt, and the countdown being timed: its start, its
+// length in seconds and whether any input arrived while it ran.
+static uint64_t last_timebase_ns;
+static uint64_t countdown_start_ns;
+static uint16_t countdown_s;
+static uint8_t countdown_clean;
+
+static const char *state_names[] = {"ENTER_TIME", "COUNTDOWN", "TIMER_FINISH"};
+
+
+/*
+ * fcy_hz
+ *
+ * Instruction clock for the currently selected oscillator.
+ */
+static uint32_t fcy_hz(void)
+{
+    uint32_t fosc;
+    int64_t ppm = clock_skew_ppm;
+    int8_t tun = sim_OSCTUN.TUN & 0x20 ? (int8_t)sim_OSCTUN.TUN - 0x40
+                                       : (int8_t)sim_OSCTUN.TUN;
+    switch (sim_OSCCON.COSC)
+    {
+        case 0b000: fosc = 8000000; ppm += tun * FRC_TUN_STEP_PPM; break;
+        case 0b101: fosc = 31000; break;
+        case 0b110: fosc = 500000; break;
+        case 0b111:
+            fosc = 8000000 >> sim_CLKDIV.RCDIV;
+            ppm += tun * FRC_TUN_STEP_PPM;
+            break;
+        default: fosc = 8000000; break;
+    }
+    return (uint32_t)(fosc * (1000000 + ppm) / 1000000) / 2;
+}
+
+
+static uint16_t prescale(uint8_t tckps)
+{
+    static const uint16_t ps[] = {1, 8, 64, 256};
+    return ps[tckps & 3];
+}
+
+
+static uint64_t ns_to_cycles(uint64_t ns)
+{
+    uint64_t fcy = fcy_hz();
+    return (ns * fcy + NS_PER_S - 1) / NS_PER_S;
+}
+
+
+/*
+ * timer_cycles_to_event
+ *
+ * Number of Fcy cycles until the timer sets its interrupt flag.
+ */
+static uint64_t timer_cycles_to_event(sim_timer_t *t)
+{
+    uint32_t ticks;
+    if (!t->con->TON)
+    {
+        return NEVER;
+    }
+    if (*t->tmr <= *t->pr)
+    {
+        ticks = (uint32_t)*t->pr - *t->tmr + 1;
+    }
+    else
+    {
+        ticks = 0x10000UL - *t->tmr + *t->pr + 1;
+    }
+    return (uint64_t)ticks * prescale(t->con->TCKPS) - t->acc;
+}
+
+
+static void timer_advance(sim_timer_t *t, uint64_t cycles)
+{
+    uint64_t total;
+    uint64_t ticks;
+    uint32_t to_match;
+    uint16_t ps;
+
+    if (!t->con->TON)
+    {
+        return;
+    }
+    ps = prescale(t->con->TCKPS);
+    total = t->acc + cycles;
+    ticks = total / ps;
+    t->acc = total % ps;
+
+    to_match = (*t->tmr <= *t->pr) ? ((uint32_t)*t->pr - *t->tmr + 1)
+                                   : (0x10000UL - *t->tmr + *t->pr + 1);
+    if (ticks < to_match)
+    {
+        *t->tmr += ticks;
+        return;
+    }
+    ticks = (ticks - to_match) % ((uint32_t)*t->pr + 1);
+    *t->tmr = ticks;
+    *t->ifs |= 1 << t->ifs_bit;
+}
+
+
+/*
+ * pending
+ *
+ * Highest priority interrupt that is flagged and enabled, regardless of
+ * the CPU priority.
+ */
+static const sim_vector_t *pending(uint8_t *priority)
+{
+    const sim_vector_t *best = NULL;
+    uint8_t best_ip = 0;
+    uint8_t i;
+    for (i = 0; i < NUM_VECTORS; i++)
+    {
+        const sim_vector_t *v = &vectors[i];
+        uint8_t ip = (*v->ipc >> v->ipc_shift) & 7;
+        if ((*v->ifs >> v->ifs_bit & 1) && (*v->iec >> v->iec_bit & 1)
+            && ip > best_ip)
+        {
+            best = v;
+            best_ip = ip;
+        }
+    }
+    *priority = best_ip;
+    return best;
+}
+
+
+/*
+ * ISR stack
+ *
+ * When enabled, each ISR runs on its own painted stack so the simulator
+ * can see how deep it went. Only the part dirtied by the previous ISR is
+ * repainted. The depth includes the small frame of isr_trampoline.
+ * Switching stacks costs a system call or two, so it is off by default.
+ */
+#define ISR_STACK_BYTES 65536
+#define ISR_STACK_FILL 0xA5
+static uint8_t isr_stack[ISR_STACK_BYTES] __attribute__((aligned(16)));
+static uint32_t isr_stack_dirty;
+static ucontext_t isr_context;
+static ucontext_t dispatch_context;
+static void (*isr_running)(void);
+static uint8_t isr_stack_check;
+
+
+static void isr_trampoline(void)
+{
+    while (1)
+    {
+        isr_running();
+        swapcontext(&isr_context, &dispatch_context);
+    }
+}
+
+
+/*
+ * run_isr
+ *
+ * Run an ISR, on the ISR stack if the check is enabled.
+ *
+ * @return The bytes of stack it used, or 0 if not measured
+ */
+static uint32_t run_isr(void (*isr)(void))
+{
+    uint32_t i;
+    if (!isr_stack_check)
+    {
+        isr();
+        return 0;
+    }
+    memset(&isr_stack[ISR_STACK_BYTES - isr_stack_dirty], ISR_STACK_FILL,
+           isr_stack_dirty);
+    isr_running = isr;
+    swapcontext(&dispatch_context, &isr_context);
+    for (i = 0; i < ISR_STACK_BYTES && isr_stack[i] == ISR_STACK_FILL; i++)
+    {
+    }
+    isr_stack_dirty = ISR_STACK_BYTES - i;
+    return isr_stack_dirty;
+}
+
+
+/*
+ * sim_isr_stack_check
+ *
+ * Measure the stack use of every ISR in the following runs.
+ */
+void sim_isr_stack_check(int enable)
+{
+    isr_stack_check = enable;
+    if (enable)
+    {
+        getcontext(&isr_context);
+        isr_context.uc_stack.ss_sp = isr_stack;
+        isr_context.uc_stack.ss_size = sizeof(isr_stack);
+        isr_context.uc_link = NULL;
+        makecontext(&isr_context, isr_trampoline, 0);
+        isr_stack_dirty = ISR_STACK_BYTES;
+    }
+}
+
+
+/*
+ * dispatch
+ *
+ * Service every pending, enabled interrupt above the CPU priority,
+ * highest priority first. Nested interrupts are not modelled; ISRs run
+ * to completion.
+ *
+ * @return number of ISRs run
+ */
+static uint16_t dispatch(void)
+{
+    uint16_t count = 0;
+    uint32_t depth;
+    if (in_isr)
+    {
+        return 0;
+    }
+    while (1)
+    {
+        uint8_t ip;
+        const sim_vector_t *v = pending(&ip);
+        if (v == NULL || ip <= sim_cpu_ipl)
+        {
+            return count;
+        }
+        if (v == &vectors[0])
+        {
+            last_timebase_ns = now_ns;
+        }
+        if (v == &vectors[VECTOR_T3])
+        {
+            result->display_irqs++;
+        }
+        in_isr = 1;
+        depth = run_isr(v->isr);
+        if (depth > result->isr_stack[v - vectors])
+        {
+            result->isr_stack[v - vectors] = depth;
+        }
+        in_isr = 0;
+        count++;
+    }
+}
+
+
+void sim_set_cpu_ipl(uint8_t ipl)
+{
+    sim_cpu_ipl = ipl;
+    dispatch();
+}
+
+
+/*
+ * apply_buttons
+ *
+ * Drive the button pins for a logical button mask and raise a change
+ * notification if an enabled CN pin changed. A CN that arrives while the
+ * previous one is still unhandled is counted as a missed event.
+ */
+static void apply_buttons(uint8_t buttons)
+{
+    // Button pins from the board descriptor: port, bit and CN number.
+    static const uint8_t pins[3][3] = {
+        {BOARD_BUTTON1_PORT, BOARD_BUTTON1_BIT, BOARD_BUTTON1_CN},
+        {BOARD_BUTTON2_PORT, BOARD_BUTTON2_BIT, BOARD_BUTTON2_CN},
+        {BOARD_BUTTON3_PORT, BOARD_BUTTON3_BIT, BOARD_BUTTON3_CN},
+    };
+    uint8_t changed = 0;
+    uint8_t i;
+    for (i = 0; i < 3; i++)
+    {
+        volatile uint16_t *port = pins[i][0] == BOARD_PORT_A ? &sim_PORTA.w
+                                                            : &sim_PORTB.w;
+        uint16_t mask = 1u << pins[i][1];
+        uint16_t cnen = pins[i][2] < 16 ? sim_CNEN1.w : sim_CNEN2.w;
+        uint16_t level = ((buttons >> i) & 1) ^ BOARD_BUTTONS_ACTIVE_LOW;
+        if (((*port & mask) != 0) != level)
+        {
+            *port ^= mask;
+            changed |= (cnen >> (pins[i][2] & 15)) & 1;
+        }
+    }
+    if (changed)
+    {
+        if (sim_IFS1.CNIF || SCHED_is_pending(SCHED_TASK_BUTTON))
+        {
+            result->missed_events++;
+        }
+        sim_IFS1.CNIF = 1;
+        if (app_state == STATE_COUNTDOWN)
+        {
+            countdown_clean = 0;
+        }
+    }
+    last_input_ns = now_ns;
+}
+
+
+/*
+ * apply_pmd
+ *
+ * Hold every disabled module at its reset state. Called before the model
+ * looks at any peripheral, so writes made while a module is disabled are
+ * lost as they are on the chip.
+ */
+static void apply_pmd(void)
+{
+    uint8_t i;
+    for (i = 0; i < 3; i++)
+    {
+        if (sim_PMD1.w >> timers[i].pmd_bit & 1)
+        {
+            timers[i].con->w = 0;
+            *timers[i].tmr = 0;
+            *timers[i].pr = 0xFFFF;
+            timers[i].acc = 0;
+        }
+    }
+    if (sim_PMD1.U2MD)
+    {
+        sim_U2MODE.w = 0;
+        sim_U2STA.w = 0;
+        tx_count = 0;
+        tx_shift_ns = NEVER;
+        U2BRG = 0;
+        rx_count = 0;
+        rx_overrun = 0;
+    }
+    if (sim_PMD2.OC1MD)
+    {
+        sim_OC1CON.w = 0;
+        OC1R = OC1RS = 0;
+    }
+    if (sim_PMD4.REFOMD)
+    {
+        sim_REFOCON.w = 0;
+    }
+    if (sim_PMD3.RTCCMD)
+    {
+        sim_RCFGCAL.w = 0;
+        sim_ALCFGRPT.w = 0;
+    }
+    if (sim_PMD1.ADC1MD)
+    {
+        sim_AD1CON1.w = sim_AD1CON2.w = sim_AD1CON3.w = sim_AD1CHS.w = 0;
+        memset((void *)sim_adc1buf, 0, sizeof(sim_adc1buf));
+    }
+    if (sim_PMD4.HLVDMD)
+    {
+        sim_HLVDCON.w = 0;
+    }
+    if (sim_PMD1.I2C1MD)
+    {
+        sim_I2C1CON.w = 0;
+        sim_I2C1STAT.w = 0;
+        I2C1BRG = 0;
+        I2C1TRN = I2C_TRN_EMPTY;
+        i2c_op = I2C_IDLE;
+        i2c_done_ns = NEVER;
+    }
+}
+
+
+/*
+ * rtcc_update
+ *
+ * Start or stop the RTCC seconds as its enables change. The first second
+ * ends once the crystal has started.
+ */
+static void rtcc_update(void)
+{
+    if (!sim_RCFGCAL.RTCEN || !sim_OSCCON.SOSCEN)
+    {
+        rtcc_next_ns = NEVER;
+    }
+    else if (rtcc_next_ns == NEVER)
+    {
+        rtcc_next_ns = now_ns + SOSC_START_NS;
+    }
+}
+
+
+/*
+ * supply_mv
+ *
+ * The supply voltage for the charge used so far.
+ */
+static uint16_t supply_mv(void)
+{
+    if (!battery_fc)
+    {
+        return SUPPLY_MV;
+    }
+    if (result->charge_fc >= battery_fc)
+    {
+        return BOR_MV;
+    }
+    return BATTERY_FULL_MV - (uint16_t)((BATTERY_FULL_MV - BOR_MV)
+                                        * result->charge_fc / battery_fc);
+}
+
+
+/*
+ * adc_update
+ *
+ * Start or stop the ADC's automatic conversions as ADON and ASAM change.
+ */
+static void adc_update(void)
+{
+    if (!sim_AD1CON1.ADON || !sim_AD1CON1.ASAM || sim_AD1CON1.SSRC != 0b111)
+    {
+        adc_done_ns = NEVER;
+    }
+    else if (adc_done_ns == NEVER)
+    {
+        adc_done_ns = now_ns + (sim_AD1CON2.SMPI + 1ULL)
+                               * (sim_AD1CON3.SAMC + 12ULL) * ADC_TAD_NS;
+    }
+}
+
+
+/*
+ * adc_convert
+ *
+ * One conversion of the selected input.
+ */
+static uint16_t adc_convert(void)
+{
+    uint32_t vdd = supply_mv();
+    int32_t code;
+
+    if (sim_AD1CHS.CH0SA == 0b1111)
+    {
+        code = (1200L * 1024 + vdd / 2) / vdd;
+    }
+#if BOARD_HAS_POT
+    else if (sim_AD1CHS.CH0SA == BOARD_POT_AN)
+    {
+        adc_noise_state = adc_noise_state * 1103515245UL + 12345;
+        code = pot_code + (int32_t)(adc_noise_state >> 16) % (2 * ADC_NOISE + 1)
+               - ADC_NOISE;
+    }
+#endif
+    else
+    {
+        code = 0;
+    }
+    return code < 0 ? 0 : code > 1023 ? 1023 : code;
+}
+
+
+static uint32_t uart_divider(void)
+{
+    return (sim_U2MODE.BRGH ? 4 : 16) * ((uint32_t)U2BRG + 1);
+}
+
+
+/*
+ * apply_rx
+ *
+ * A character from the trace arrives on U2RX. With ABAUD set it is
+ * measured instead of received: the sync character 0x55 gives the rate
+ * it was sent at; any other character, with fewer edges, is modelled as
+ * measuring half its rate. Auto-baud completion raises U2RXIF.
+ */
+static void apply_rx(const sim_event_t *e)
+{
+    uint32_t div = sim_U2MODE.BRGH ? 4 : 16;
+    uint32_t actual;
+    uint32_t diff;
+
+    apply_pmd();
+    if (!sim_U2MODE.UARTEN)
+    {
+        return;
+    }
+    if (sim_U2MODE.ABAUD)
+    {
+        uint32_t baud = e->rx == 0x55 ? e->baud : e->baud / 2;
+        U2BRG = (fcy_hz() + div * baud / 2) / (div * baud) - 1;
+        sim_U2MODE.ABAUD = 0;
+        sim_IFS1.U2RXIF = 1;
+        return;
+    }
+    // Reception stops until OERR is cleared
+    if (sim_U2STA.OERR)
+    {
+        return;
+    }
+    if (rx_count == RX_FIFO_DEPTH)
+    {
+        sim_U2STA.OERR = 1;
+        rx_overrun = 1;
+        return;
+    }
+    actual = fcy_hz() / uart_divider();
+    diff = actual > e->baud ? actual - e->baud : e->baud - actual;
+    rx_fifo[rx_count].ferr = diff * 100 > e->baud * RX_TOLERANCE_PCT;
+    rx_fifo[rx_count].c = rx_fifo[rx_count].ferr ? e->rx ^ 0x5A : e->rx;
+    rx_count++;
+    sim_IFS1.U2RXIF = 1;
+}
+
+
+/*
+ * bus_io
+ *
+ * Read or write all of a buffer on a bus pipe; a bus that goes away ends
+ * the run.
+ */
+static void bus_io(int write_fd, int fd, void *buf, size_t size)
+{
+    uint8_t *p = buf;
+    while (size)
+    {
+        ssize_t n = write_fd ? write(fd, p, size) : read(fd, p, size);
+        if (n <= 0)
+        {
+            _exit(4);
+        }
+        p += n;
+        size -= n;
+    }
+}
+
+
+/*
+ * bus_exchange
+ *
+ * End of a bus quantum: report the characters sent during it and take
+ * the ones other units sent, which all arrive after it.
+ */
+static void bus_exchange(void)
+{
+    sim_bus_header_t header = {bus_tx_count, 0};
+    uint32_t count;
+
+    bus_io(1, bus_out, &header, sizeof(header));
+    bus_io(1, bus_out, bus_tx, bus_tx_count * sizeof(sim_event_t));
+    bus_tx_count = 0;
+    bus_io(0, bus_in, &count, sizeof(count));
+    if (bus_rx_head == bus_rx_count)
+    {
+        bus_rx_head = bus_rx_count = 0;
+    }
+    if (bus_rx_count + count > bus_rx_capacity)
+    {
+        bus_rx_capacity = (bus_rx_count + count) * 2;
+        bus_rx = realloc(bus_rx, bus_rx_capacity * sizeof(sim_event_t));
+    }
+    bus_io(0, bus_in, &bus_rx[bus_rx_count], count * sizeof(sim_event_t));
+    bus_rx_count += count;
+    bus_next_ns += SIM_BUS_QUANTUM_NS;
+}
+
+
+/*
+ * i2c_update
+ *
+ * Put on the bus the start, stop or byte the firmware has asked for, if
+ * the bus is free.
+ */
+static void i2c_update(void)
+{
+    uint64_t bit_ns = ((uint64_t)I2C1BRG + 1) * NS_PER_S / fcy_hz()
+                      + I2C_DELAY_NS;
+
+    if (!sim_I2C1CON.I2CEN || i2c_op != I2C_IDLE)
+    {
+        return;
+    }
+    if (sim_I2C1CON.SEN)
+    {
+        i2c_op = I2C_START;
+        i2c_done_ns = now_ns + bit_ns;
+    }
+    else if (sim_I2C1CON.PEN)
+    {
+        i2c_op = I2C_STOP;
+        i2c_done_ns = now_ns + bit_ns;
+    }
+    else if (I2C1TRN != I2C_TRN_EMPTY)
+    {
+        i2c_byte = I2C1TRN;
+        I2C1TRN = I2C_TRN_EMPTY;
+        sim_I2C1STAT.TRSTAT = 1;
+        i2c_op = I2C_BYTE;
+        i2c_done_ns = now_ns + 9 * bit_ns;
+    }
+}
+
+
+/*
+ * hd_execute
+ *
+ * The LCD takes an instruction, or with rs a character.
+ */
+static void hd_execute(uint8_t rs, uint8_t v)
+{
+    uint64_t busy_ns = 37000;
+
+    if (now_ns < hd_busy_ns)
+    {
+        result->lcd_early++;
+    }
+    if (rs)
+    {
+        hd_ddram[hd_addr] = v;
+        hd_addr = (hd_addr + 1) & 0x7F;
+        busy_ns = 41000;
+    }
+    else if (v & 0x80)
+    {
+        hd_addr = v & 0x7F;
+    }
+    else if (v & 0x40)
+    {
+        // Set CGRAM Address: user characters are not modelled
+    }
+    else if (v & 0x20)
+    {
+        // Function Set
+        if (hd_8bit)
+        {
+            busy_ns = hd_resets++ ? 100000 : 4100000;
+        }
+        hd_8bit = v >> 4 & 1;
+        hd_half = 0;
+    }
+    else if (v & 0x08 && !(v & 0x10))
+    {
+        hd_on = v >> 2 & 1;
+    }
+    else if (v == 0x01 || (v & 0xFE) == 0x02)
+    {
+        // Clear Display, Return Home
+        if (v == 0x01)
+        {
+            memset(hd_ddram, ' ', sizeof(hd_ddram));
+        }
+        hd_addr = 0;
+        busy_ns = 1520000;
+    }
+    hd_busy_ns = now_ns + busy_ns;
+}
+
+
+/*
+ * pcf_write
+ *
+ * A byte written to the PCF8574 sets its pins, and E falling with RW low
+ * gives the LCD a nibble.
+ */
+static void pcf_write(uint8_t v)
+{
+    uint8_t fell = (pcf_port & HD_E) && !(v & HD_E);
+    uint8_t nibble = v >> 4;
+
+    pcf_port = v;
+    if (!fell || (v & HD_RW))
+    {
+        return;
+    }
+    if (hd_8bit)
+    {
+        hd_execute(v & HD_RS, nibble << 4);
+    }
+    else if (!hd_half)
+    {
+        hd_high = nibble;
+        hd_half = 1;
+    }
+    else
+    {
+        hd_half = 0;
+        hd_execute(v & HD_RS, hd_high << 4 | nibble);
+    }
+}
+
+
+/*
+ * i2c_done
+ *
+ * The start, stop or byte on the bus has ended.
+ */
+static void i2c_done(void)
+{
+    switch (i2c_op)
+    {
+        case I2C_START:
+            sim_I2C1CON.SEN = 0;
+            i2c_address_next = 1;
+            i2c_pcf = 0;
+            break;
+        case I2C_STOP:
+            sim_I2C1CON.PEN = 0;
+            i2c_pcf = 0;
+            break;
+        case I2C_BYTE:
+            result->i2c_bytes++;
+            sim_I2C1STAT.TRSTAT = 0;
+            if (i2c_address_next)
+            {
+                i2c_pcf = i2c_byte == PCF_ADDRESS << 1;
+                i2c_address_next = 0;
+            }
+            else if (i2c_pcf)
+            {
+                pcf_write(i2c_byte);
+            }
+            sim_I2C1STAT.ACKSTAT = !i2c_pcf;
+            break;
+        default:
+            break;
+    }
+    i2c_op = I2C_IDLE;
+    i2c_done_ns = NEVER;
+    sim_IFS1.MI2C1IF = 1;
+}
+
+
+static uint64_t cycles_to_next_event(void)
+{
+    uint64_t next = NEVER;
+    uint8_t i;
+
+    apply_pmd();
+    for (i = 0; i < 3; i++)
+    {
+        uint64_t c = timer_cycles_to_event(&timers[i]);
+        if (c < next)
+        {
+            next = c;
+        }
+    }
+    if (sim_NVMCON.WR)
+    {
+        uint64_t c = (nvm_done_ns > now_ns) ? ns_to_cycles(nvm_done_ns - now_ns) : 0;
+        if (c < next)
+        {
+            next = c;
+        }
+    }
+    // Take a character written since the last access to U2STA
+    sim_u2sta();
+    if (tx_shift_ns != NEVER)
+    {
+        uint64_t c = (tx_shift_ns > now_ns) ? ns_to_cycles(tx_shift_ns - now_ns) : 0;
+        if (c < next)
+        {
+            next = c;
+        }
+    }
+    i2c_update();
+    if (i2c_done_ns != NEVER)
+    {
+        uint64_t c = (i2c_done_ns > now_ns) ? ns_to_cycles(i2c_done_ns - now_ns) : 0;
+        if (c < next)
+        {
+            next = c;
+        }
+    }
+    adc_update();
+    if (adc_done_ns != NEVER)
+    {
+        uint64_t c = (adc_done_ns > now_ns) ? ns_to_cycles(adc_done_ns - now_ns) : 0;
+        if (c < next)
+        {
+            next = c;
+        }
+    }
+    rtcc_update();
+    if (rtcc_next_ns != NEVER)
+    {
+        uint64_t c = (rtcc_next_ns > now_ns) ? ns_to_cycles(rtcc_next_ns - now_ns) : 0;
+        if (c < next)
+        {
+            next = c;
+        }
+    }
+    if (bus_next_ns != NEVER)
+    {
+        uint64_t t = bus_rx_head < bus_rx_count
+                     && bus_rx[bus_rx_head].time_ns < bus_next_ns
+                     ? bus_rx[bus_rx_head].time_ns : bus_next_ns;
+        uint64_t c = (t > now_ns) ? ns_to_cycles(t - now_ns) : 0;
+        if (c < next)
+        {
+            next = c;
+        }
+    }
+    if (next_event < trace->count)
+    {
+        uint64_t t = trace->events[next_event].time_ns;
+        uint64_t c = (t > now_ns) ? ns_to_cycles(t - now_ns) : 0;
+        if (c < next)
+        {
+            next = c;
+        }
+    }
+    if (battery_fc && ns_to_cycles(SUPPLY_STEP_NS) < next)
+    {
+        next = ns_to_cycles(SUPPLY_STEP_NS);
+    }
+    return next;
+}
+
+
+/*
+ * led_on_ns
+ *
+ * Time the LED on the OC1 pin (RA6) is lit during ns of virtual time:
+ * the PWM duty when OC1 is running, otherwise the port latch.
+ */
+static uint64_t led_on_ns(uint64_t ns)
+{
+    if (sim_OC1CON.OCM == 0b110 && sim_T2CON.TON)
+    {
+        uint32_t period = (uint32_t)PR2 + 1;
+        uint32_t duty = OC1RS < period ? OC1RS : period;
+        return ns * duty / period;
+    }
+    if (sim_OC1CON.OCM == 0 && !sim_TRISA.TRISA6 && sim_LATA.LATA6)
+    {
+        return ns;
+    }
+    return 0;
+}
+
+
+#if BOARD_HAS_DISPLAY
+/*
+ * display_lit
+ *
+ * Number of segments of the 7-segment display lit, and record the digit
+ * they show.
+ */
+static uint8_t display_lit(void)
+{
+    uint16_t out = sim_LATB.w & ~sim_TRISB.w;
+    uint8_t segs = 0;
+    uint8_t count = 0;
+    uint8_t digit;
+    uint8_t i;
+
+    for (i = 0; i < 7; i++)
+    {
+        if (out >> display_seg_bits[i] & 1)
+        {
+            segs |= 1 << i;
+            count++;
+        }
+    }
+    if (!count)
+    {
+        return 0;
+    }
+    digit = (out >> BOARD_DISPLAY_SEL0 & 1) | (out >> BOARD_DISPLAY_SEL1 & 1) << 1;
+    result->display[display_places[digit]] = '?';
+    for (i = 0; i < 10; i++)
+    {
+        if (segs == display_glyphs[i])
+        {
+            result->display[display_places[digit]] = '0' + i;
+        }
+    }
+    return count;
+}
+#endif
+
+
+/*
+ * supply_ua
+ *
+ * Current drawn besides the LED and the piezo.
+ */
+static uint32_t supply_ua(void)
+{
+    uint32_t fcy = fcy_hz();
+    uint32_t ua = IDD_IDLE_UA(fcy);
+    if (sim_HLVDCON.HLVDEN)
+    {
+        ua += HLVD_UA;
+    }
+    if (sim_AD1CON1.ADON)
+    {
+        ua += ADC_UA;
+    }
+    return ua;
+}
+
+
+/*
+ * step
+ *
+ * Move the virtual clock forward without dispatching interrupts and
+ * apply any trace events that have come due.
+ */
+static void step(uint64_t cycles)
+{
+    uint64_t fcy = fcy_hz();
+    uint64_t num;
+    uint64_t led_ns;
+#if BOARD_HAS_DISPLAY
+    uint8_t segments;
+#endif
+    uint8_t i;
+
+    for (i = 0; i < 3; i++)
+    {
+        timer_advance(&timers[i], cycles);
+    }
+    num = cycles * NS_PER_S + ns_rem;
+    led_ns = led_on_ns(num / fcy);
+    result->led_on_ns += led_ns;
+    result->charge_fc += (uint64_t)supply_ua() * (num / fcy) + LED_UA * led_ns;
+#if BOARD_HAS_DISPLAY
+    segments = display_lit();
+    if (segments)
+    {
+        result->display_lit_ns += num / fcy;
+        result->charge_fc += (uint64_t)SEGMENT_UA * segments * (num / fcy);
+    }
+#endif
+    // Reference clock output on RB15 drives the piezo
+    if (sim_REFOCON.ROEN && !sim_TRISB.TRISB15)
+    {
+        result->tone_ns += num / fcy;
+        result->charge_fc += TONE_UA * (num / fcy);
+        if (app_state != STATE_TIMER_FINISH)
+        {
+            result->stray_tone_ns += num / fcy;
+        }
+    }
+    now_ns += num / fcy;
+    ns_rem = num % fcy;
+
+    result->vdd_mv = supply_mv();
+    if (battery_fc && result->vdd_mv <= BOR_MV && !result->brownout_ns)
+    {
+        result->brownout_ns = now_ns;
+    }
+    if (sim_HLVDCON.HLVDEN && !sim_HLVDCON.VDIR && sim_HLVDCON.HLVDL < 15
+        && result->vdd_mv < hlvd_trip_mv[sim_HLVDCON.HLVDL])
+    {
+        sim_IFS4.HLVDIF = 1;
+    }
+
+    if (sim_NVMCON.WR && nvm_done_ns <= now_ns)
+    {
+        sim_NVMCON.WR = 0;
+        sim_IFS0.NVMIF = 1;
+    }
+
+    if (rtcc_next_ns <= now_ns)
+    {
+        rtcc_next_ns += NS_PER_S;
+        if (sim_ALCFGRPT.ALRMEN && sim_ALCFGRPT.AMASK == 0b0001)
+        {
+            sim_IFS3.RTCIF = 1;
+            if (!sim_ALCFGRPT.CHIME && sim_ALCFGRPT.ARPT-- == 0)
+            {
+                sim_ALCFGRPT.ALRMEN = 0;
+            }
+        }
+    }
+
+    if (tx_shift_ns <= now_ns)
+    {
+        tx_shifted();
+    }
+
+    if (i2c_done_ns <= now_ns)
+    {
+        i2c_done();
+    }
+
+    if (adc_done_ns <= now_ns)
+    {
+        uint8_t n;
+        for (n = 0; n <= sim_AD1CON2.SMPI; n++)
+        {
+            sim_adc1buf[n] = adc_convert();
+        }
+        sim_IFS0.AD1IF = 1;
+        adc_done_ns = NEVER;
+        adc_update();
+    }
+
+    while (next_event < trace->count
+           && trace->events[next_event].time_ns <= now_ns)
+    {
+        const sim_event_t *e = &trace->events[next_event];
+        if (e->baud)
+        {
+            apply_rx(e);
+        }
+        else if (e->analog)
+        {
+            pot_code = e->pot;
+        }
+        else
+        {
+            apply_buttons(e->buttons);
+        }
+        next_event++;
+    }
+
+    while (bus_rx_head < bus_rx_count && bus_rx[bus_rx_head].time_ns <= now_ns)
+    {
+        apply_rx(&bus_rx[bus_rx_head++]);
+    }
+    while (bus_next_ns <= now_ns)
+    {
+        bus_exchange();
+    }
+}
+
+
+/*
+ * countdown_finished
+ *
+ * Time a countdown that ran without input, from the button that started
+ * it to the timebase interrupt that released its last second.
+ */
+static void countdown_finished(void)
+{
+    int64_t error = (int64_t)(last_timebase_ns - countdown_start_ns)
+                    - (int64_t)countdown_s * (int64_t)NS_PER_S;
+    result->countdowns++;
+    result->last_countdown_error_ns = error;
+    if ((error < 0 ? -error : error) > (result->max_countdown_error_ns < 0
+                                        ? -result->max_countdown_error_ns
+                                        : result->max_countdown_error_ns))
+    {
+        result->max_countdown_error_ns = error;
+    }
+    if (log_out)
+    {
+        fprintf(log_out, "%10.3f ms  countdown of %u s off by %+.3f ms\n",
+                now_ns / 1e6, countdown_s, error / 1e6);
+    }
+}
+
+
+static void sample_state(void)
+{
+    if (app_state != last_state)
+    {
+        uint64_t latency = now_ns - last_input_ns;
+        result->transitions++;
+        // The alarm is driven by the countdown timer, every other
+        // transition by a button.
+        if (app_state == STATE_TIMER_FINISH)
+        {
+            alarm_from_ns = now_ns;
+            if (result->sessions < SIM_MAX_FINISHES)
+            {
+                result->finish_ns[result->sessions] = last_timebase_ns;
+            }
+            result->sessions++;
+            if (last_state == STATE_COUNTDOWN && countdown_clean)
+            {
+                countdown_finished();
+            }
+        }
+        else if (latency > result->max_latency_ns)
+        {
+            result->max_latency_ns = latency;
+        }
+        if (log_out)
+        {
+            fprintf(log_out, "%10.3f ms  %s -> %s", now_ns / 1e6,
+                    state_names[last_state], state_names[app_state]);
+            if (app_state != STATE_TIMER_FINISH)
+            {
+                fprintf(log_out, "  (%.3f ms after input)", latency / 1e6);
+            }
+            fputc('\n', log_out);
+        }
+        if (app_state == STATE_COUNTDOWN && last_state == STATE_ENTER_TIME)
+        {
+            countdown_start_ns = last_input_ns;
+            countdown_s = EEPROM_get_last();
+            countdown_clean = 1;
+        }
+        last_state = app_state;
+    }
+}
+
+
+/*
+ * sim_idle
+ *
+ * Idle(): wait for the next interrupt. Like the CPU, wakes on an enabled
+ * interrupt even when the CPU priority masks it. Ends the run once the
+ * trace is exhausted and nothing is due before its end time, or once the
+ * battery has browned out.
+ */
+void sim_idle(void)
+{
+    uint8_t ip;
+    sample_state();
+    while (!dispatch() && pending(&ip) == NULL)
+    {
+        uint64_t c = cycles_to_next_event();
+        if (c == NEVER || now_ns + c * NS_PER_S / fcy_hz() > trace->end_ns
+            || result->brownout_ns)
+        {
+            longjmp(done, 1);
+        }
+        step(c);
+    }
+}
+
+
+/*
+ * sim_sleep
+ *
+ * Sleep() is treated like Idle(). Timers on the internal clock stop in
+ * Sleep, which the firmware does not rely on.
+ */
+void sim_sleep(void)
+{
+    sim_idle();
+}
+
+
+/*
+ * bus_send
+ *
+ * Put a character that is starting to go out on the bus, to arrive at
+ * the end of its stop bit.
+ */
+static void bus_send(uint8_t c)
+{
+    sim_event_t e = {0, fcy_hz() / uart_divider(), 0, c, 0, 0};
+    e.time_ns = now_ns + 10ULL * uart_divider() * NS_PER_S / fcy_hz();
+    if (bus_tx_count == bus_tx_capacity)
+    {
+        bus_tx_capacity = bus_tx_capacity ? bus_tx_capacity * 2 : 64;
+        bus_tx = realloc(bus_tx, bus_tx_capacity * sizeof(sim_event_t));
+    }
+    bus_tx[bus_tx_count++] = e;
+}
+
+
+/*
+ * tx_line_check
+ *
+ * Follow the terminal line through a character sent, counting the alarm
+ * text as cut into a line if anything but the countdown comes before it
+ * or anything but a CR or LF after it.
+ */
+static void tx_line_check(uint8_t c)
+{
+    uint16_t before;
+
+    // NULs show nothing on a terminal
+    if (c == 0)
+    {
+        return;
+    }
+    if (tx_alarm_ended)
+    {
+        tx_alarm_ended = 0;
+        if (c != '\r' && c != '\n')
+        {
+            result->alarm_cuts++;
+        }
+    }
+    if (c == '\r' || c == '\n')
+    {
+        tx_line_len = 0;
+        return;
+    }
+    if (tx_line_len < sizeof(tx_line))
+    {
+        tx_line[tx_line_len] = c;
+    }
+    tx_line_len++;
+    if (memcmp(tx_recent, ALARM_TEXT, sizeof(tx_recent)))
+    {
+        return;
+    }
+    tx_alarm_ended = 1;
+    before = tx_line_len - sizeof(tx_recent);
+    if (before != sizeof(" -- ") - 1
+        && (before != sizeof("00m:00s -- ") - 1 || tx_line[2] != 'm'
+            || tx_line[3] != ':' || tx_line[6] != 's'))
+    {
+        result->alarm_cuts++;
+    }
+}
+
+
+/*
+ * tx_load
+ *
+ * Move the next buffered character into an empty shift register, which
+ * puts it on the virtual wire for one character time at the configured
+ * baud rate.
+ */
+static void tx_load(void)
+{
+    uint8_t c;
+
+    if (tx_shift_ns != NEVER || tx_count == 0)
+    {
+        return;
+    }
+    c = tx_fifo[0];
+    tx_count--;
+    memmove(&tx_fifo[0], &tx_fifo[1], tx_count);
+    result->uart_bytes++;
+    result->uart_hash = (result->uart_hash ^ c) * 16777619UL;
+    if (uart_out && c)
+    {
+        fputc(c, uart_out);
+    }
+    if (bus_out >= 0)
+    {
+        bus_send(c);
+    }
+    result->uart_tx_ns += 10ULL * uart_divider() * NS_PER_S / fcy_hz();
+    tx_shift_ns = now_ns + 10ULL * uart_divider() * NS_PER_S / fcy_hz();
+    memmove(&tx_recent[0], &tx_recent[1], sizeof(tx_recent) - 1);
+    tx_recent[sizeof(tx_recent) - 1] = c;
+    tx_line_check(c);
+    if (alarm_from_ns != NEVER
+        && !memcmp(tx_recent, ALARM_TEXT, sizeof(tx_recent)))
+    {
+        if (tx_shift_ns - alarm_from_ns > result->max_alarm_ns)
+        {
+            result->max_alarm_ns = tx_shift_ns - alarm_from_ns;
+        }
+        alarm_from_ns = NEVER;
+    }
+    // UTXISEL 00: a character moved to the shift register; 10: and the
+    // buffer is left empty
+    if (!sim_U2STA.UTXISEL1 && !sim_U2STA.UTXISEL0)
+    {
+        sim_IFS1.U2TXIF = 1;
+    }
+    else if (sim_U2STA.UTXISEL1 && !sim_U2STA.UTXISEL0 && tx_count == 0)
+    {
+        sim_IFS1.U2TXIF = 1;
+    }
+}
+
+
+/*
+ * tx_shifted
+ *
+ * The character in the shift register has gone.
+ */
+static void tx_shifted(void)
+{
+    tx_shift_ns = NEVER;
+    // UTXISEL 01: the last character has gone
+    if (!sim_U2STA.UTXISEL1 && sim_U2STA.UTXISEL0 && tx_count == 0)
+    {
+        sim_IFS1.U2TXIF = 1;
+    }
+    tx_load();
+}
+
+
+/*
+ * sim_u2sta
+ *
+ * Access to U2STA. Takes any character written to U2TXREG into the
+ * transmit buffer; one written to a full buffer is lost, as on the part.
+ */
+volatile U2STABITS *sim_u2sta(void)
+{
+    // Note a change of state before any text it sends
+    sample_state();
+    apply_pmd();
+    // Clearing OERR empties the receive FIFO
+    if (rx_overrun && !sim_U2STA.OERR)
+    {
+        rx_overrun = 0;
+        rx_count = 0;
+    }
+    if (U2TXREG != TXREG_EMPTY)
+    {
+        uint8_t c = U2TXREG;
+        U2TXREG = TXREG_EMPTY;
+        if (sim_U2MODE.UARTEN && sim_U2STA.UTXEN && tx_count < TX_FIFO_DEPTH)
+        {
+            tx_fifo[tx_count++] = c;
+            tx_load();
+        }
+    }
+    sim_U2STA.UTXBF = tx_count == TX_FIFO_DEPTH;
+    sim_U2STA.TRMT = tx_count == 0 && tx_shift_ns == NEVER;
+    sim_U2STA.URXDA = rx_count != 0;
+    sim_U2STA.FERR = rx_count && rx_fifo[0].ferr;
+    return &sim_U2STA;
+}
+
+
+/*
+ * sim_ad1con1
+ *
+ * Access to AD1CON1. A single conversion started by setting SAMP
+ * completes at once.
+ */
+volatile AD1CON1BITS *sim_ad1con1(void)
+{
+    apply_pmd();
+    if (sim_AD1CON1.ADON && sim_AD1CON1.SAMP && sim_AD1CON1.SSRC == 0b111
+        && !sim_AD1CON1.ASAM)
+    {
+        ADC1BUF0 = adc_convert();
+        sim_AD1CON1.SAMP = 0;
+        sim_AD1CON1.DONE = 1;
+    }
+    return &sim_AD1CON1;
+}
+
+
+/*
+ * sim_u2rxreg
+ *
+ * Read of U2RXREG: the oldest character in the receive FIFO.
+ */
+uint16_t sim_u2rxreg(void)
+{
+    uint8_t c;
+    if (rx_count == 0)
+    {
+        return 0;
+    }
+    c = rx_fifo[0].c;
+    rx_count--;
+    memmove(&rx_fifo[0], &rx_fifo[1], rx_count * sizeof(rx_fifo[0]));
+    return c;
+}
+
+
+void sim_write_oscconh(uint8_t value)
+{
+    sim_OSCCON.NOSC = value & 7;
+}
+
+
+/*
+ * sim_write_oscconl
+ *
+ * Write the low byte of OSCCON. Setting OSWEN switches to the NOSC
+ * oscillator immediately.
+ */
+void sim_write_oscconl(uint8_t value)
+{
+    sim_OSCCON.w = (sim_OSCCON.w & 0xFF00) | value;
+    if (sim_OSCCON.OSWEN)
+    {
+        sim_OSCCON.COSC = sim_OSCCON.NOSC;
+        sim_OSCCON.OSWEN = 0;
+        ns_rem = 0;
+    }
+}
+
+
+uint16_t sim_tbloffset(const volatile void *p)
+{
+    tbl_base = (volatile uint8_t *)p;
+    return 0;
+}
+
+
+uint16_t sim_tblrdl(uint16_t offset)
+{
+    if (sim_PMD4.EEMD)
+    {
+        return 0;
+    }
+    return *(volatile uint16_t *)(tbl_base + offset);
+}
+
+
+void sim_tblwtl(uint16_t offset, uint16_t data)
+{
+    tbl_latch_offset = offset;
+    tbl_latch_data = data;
+}
+
+
+/*
+ * sim_write_nvm
+ *
+ * Start the data EEPROM operation selected by NVMCON on the latched
+ * address: erase 1, 4 or 8 words, or write one word.
+ */
+void sim_write_nvm(void)
+{
+    volatile uint16_t *word = (volatile uint16_t *)(tbl_base + tbl_latch_offset);
+    if (!sim_NVMCON.WREN || sim_NVMCON.WR || sim_PMD4.EEMD)
+    {
+        return;
+    }
+    if (sim_NVMCON.ERASE)
+    {
+        uint8_t n = (sim_NVMCON.NVMOP == 0x1A) ? 8 : (sim_NVMCON.NVMOP == 0x19) ? 4 : 1;
+        uint8_t i;
+        for (i = 0; i < n; i++)
+        {
+            word[i] = 0xFFFF;
+        }
+    }
+    else
+    {
+        *word = tbl_latch_data;
+    }
+    sim_NVMCON.WR = 1;
+    nvm_done_ns = now_ns + NVM_OP_NS;
+}
+
+
+uint64_t sim_now_ns(void)
+{
+    return now_ns;
+}
+
+
+void sim_set_clock_skew(int32_t ppm)
+{
+    clock_skew_ppm = ppm;
+}
+
+
+void sim_set_battery(uint32_t uah)
+{
+    battery_fc = uah * (FC_PER_MAH / 1000);
+}
+
+
+void sim_bus_attach(int out_fd, int in_fd)
+{
+    bus_out = out_fd;
+    bus_in = in_fd;
+}
+
+
+/*
+ * reset_registers
+ *
+ * Put the modelled registers in their power-on reset state.
+ */
+static void reset_registers(void)
+{
+    uint8_t i;
+    sim_OSCCON.w = 0;
+    sim_OSCCON.COSC = 0b110; // FNOSC = LPFRC
+    sim_CLKDIV.w = 0x3100;
+    sim_OSCTUN.w = 0;
+    sim_TRISA.w = 0xFFFF;
+    sim_TRISB.w = 0xFFFF;
+    sim_PORTA.w = 0;
+    sim_PORTB.w = 0;
+    sim_IFS0.w = sim_IFS1.w = 0;
+    sim_IEC0.w = sim_IEC1.w = 0;
+    sim_IPC0.w = sim_IPC1.w = sim_IPC2.w = sim_IPC3.w = sim_IPC4.w = 0x4444;
+    sim_IPC7.w = 0x4444;
+    sim_IFS3.w = sim_IEC3.w = 0;
+    sim_IPC15.w = 0x4444;
+    sim_IFS4.w = sim_IEC4.w = 0;
+    sim_IPC18.w = 0x0004;
+    sim_AD1CON1.w = sim_AD1CON2.w = sim_AD1CON3.w = sim_AD1CHS.w = 0;
+    memset((void *)sim_adc1buf, 0, sizeof(sim_adc1buf));
+    adc_done_ns = NEVER;
+    sim_HLVDCON.w = 0;
+    sim_RCFGCAL.w = 0;
+    sim_ALCFGRPT.w = 0;
+    rtcc_next_ns = NEVER;
+    sim_NVMCON.w = 0;
+    sim_OC1CON.w = 0;
+    OC1R = OC1RS = 0;
+    sim_PMD1.w = sim_PMD2.w = sim_PMD3.w = sim_PMD4.w = 0;
+    sim_T1CON.w = sim_T2CON.w = sim_T3CON.w = 0;
+    TMR1 = TMR2 = TMR3 = 0;
+    PR1 = PR2 = PR3 = 0xFFFF;
+    sim_U2MODE.w = 0;
+    sim_U2STA.w = 0;
+    U2TXREG = TXREG_EMPTY;
+    sim_I2C1CON.w = 0;
+    sim_I2C1STAT.w = 0;
+    I2C1BRG = 0;
+    I2C1TRN = I2C_TRN_EMPTY;
+    i2c_op = I2C_IDLE;
+    i2c_done_ns = NEVER;
+    tx_count = 0;
+    tx_shift_ns = NEVER;
+    rx_count = 0;
+    rx_overrun = 0;
+    for (i = 0; i < 3; i++)
+    {
+        timers[i].acc = 0;
+    }
+}
+
+
+/*
+ * sim_run
+ *
+ * Replay a trace through firmware_main(). Firmware globals are not reset
+ * between runs, so run each trace in a fresh process.
+ */
+void sim_run(const sim_trace_t *t, sim_result_t *r, FILE *uart, FILE *log)
+{
+    uint32_t i;
+
+    trace = t;
+    result = r;
+    uart_out = uart;
+    log_out = log;
+    memset(r, 0, sizeof(*r));
+    strcpy(r->display, "  :  ");
+    r->uart_hash = 2166136261UL;
+    r->vdd_mv = supply_mv();
+    now_ns = ns_rem = last_input_ns = last_timebase_ns = 0;
+    countdown_clean = 0;
+    alarm_from_ns = NEVER;
+    memset(tx_recent, 0, sizeof(tx_recent));
+    tx_line_len = 0;
+    tx_alarm_ended = 0;
+    next_event = 0;
+    bus_next_ns = bus_out >= 0 ? SIM_BUS_QUANTUM_NS : NEVER;
+    bus_tx_count = bus_rx_head = bus_rx_count = 0;
+    in_isr = 0;
+    pot_code = 0;
+    adc_noise_state = 1;
+    sim_cpu_ipl = 0;
+    last_state = app_state;
+    pcf_port = 0;
+    memset(hd_ddram, ' ', sizeof(hd_ddram));
+    hd_addr = hd_on = hd_half = hd_resets = 0;
+    hd_8bit = 1;
+    hd_busy_ns = HD_POWER_UP_NS;
+    reset_registers();
+    apply_buttons(0);
+    sim_IFS1.CNIF = 0;
+
+    if (!setjmp(done))
+    {
+        firmware_main();
+    }
+    r->sim_ns = now_ns;
+    r->expect = t->expect;
+    for (i = 0; i < 16; i++)
+    {
+        uint8_t c0 = hd_on ? hd_ddram[i] : ' ';
+        uint8_t c1 = hd_on ? hd_ddram[0x40 + i] : ' ';
+        r->lcd[0][i] = c0 >= ' ' && c0 < 0x7F ? c0 : '?';
+        r->lcd[1][i] = c1 >= ' ' && c1 < 0x7F ? c1 : '?';
+    }
+    for (i = 0; i < SCHED_NUM_TASKS; i++)
+    {
+        r->tasks[i] = *SCHED_get_stats(i);
+    }
+    r->uart_baud = fcy_hz() / uart_divider();
+    r->fcy_hz = fcy_hz();
+    r->fcy_estimate_hz = CLOCK_get_fcy();
+    r->boot_display_ns = boot_ticks[BOOT_STAGE_DISPLAY] * BOOT_TICK_US * 1000ULL;
+    for (i = 0; i < t->count && (t->events[i].baud || t->events[i].analog);
+         i++)
+    {
+    }
+    if (boot_ticks[BOOT_STAGE_RESPONSE] && i < t->count)
+    {
+        uint64_t response = boot_ticks[BOOT_STAGE_RESPONSE] * BOOT_TICK_US * 1000ULL;
+        r->boot_response_ns = response > t->events[i].time_ns
+                              ? response - t->events[i].time_ns : 0;
+    }
+}
+
+
+/*
+ * trace_add
+ *
+ * Append an event, keeping the trace in time order. Characters spread
+ * out over their transmission time can land after later lines.
+ */
+static void trace_add(sim_trace_t *t, uint32_t *capacity, sim_event_t e)
+{
+    uint32_t i;
+    if (t->count == *capacity)
+    {
+        *capacity *= 2;
+        t->events = realloc(t->events, *capacity * sizeof(sim_event_t));
+    }
+    for (i = t->count; i > 0 && t->events[i - 1].time_ns > e.time_ns; i--)
+    {
+        t->events[i] = t->events[i - 1];
+    }
+    t->events[i] = e;
+    t->count++;
+}
+
+
+/*
+ * trace_add_rx
+ *
+ * Append the characters of an rx line, back to back from time_ns. text
+ * may use the escapes \r, \n, \\ and \xHH.
+ *
+ * @return 0 on success, -1 on a bad escape
+ */
+static int trace_add_rx(sim_trace_t *t, uint32_t *capacity,
+                        uint64_t time_ns, uint32_t baud, const char *text)
+{
+    sim_event_t e = {0, baud, 0, 0, 0, 0};
+    uint64_t char_ns = 10 * NS_PER_S / baud;
+    while (*text && *text != '\n')
+    {
+        char c = *text++;
+        if (c == '\\')
+        {
+            unsigned int hex;
+            c = *text++;
+            if (c == 'r')
+            {
+                c = '\r';
+            }
+            else if (c == 'n')
+            {
+                c = '\n';
+            }
+            else if (c == 'x' && sscanf(text, "%2x", &hex) == 1)
+            {
+                c = hex;
+                text += 2;
+            }
+            else if (c != '\\')
+            {
+                return -1;
+            }
+        }
+        time_ns += char_ns;
+        e.time_ns = time_ns;
+        e.rx = c;
+        trace_add(t, capacity, e);
+    }
+    return 0;
+}
+
+
+/*
+ * sim_trace_load
+ *
+ * Read a trace file. Each line is "<time ms> <button mask>",
+ * "<time ms> rx <baud> <text>" or "<time ms> pot <ADC code>", with an
+ * optional "end <time ms>" line; '#' starts a comment. An "expect <build>
+ * uart <hash> sessions <n> transitions <n>" line gives what a run must
+ * produce in a build; the lines for other builds are skipped.
+ *
+ * @return 0 on success, -1 on error
+ */
+int sim_trace_load(const char *path, sim_trace_t *t)
+{
+    char line[128];
+    uint32_t capacity = 256;
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        return -1;
+    }
+    t->events = malloc(capacity * sizeof(sim_event_t));
+    t->count = 0;
+    t->end_ns = 0;
+    memset(&t->expect, 0, sizeof(t->expect));
+    while (fgets(line, sizeof(line), f))
+    {
+        double ms;
+        unsigned int mask;
+        unsigned int baud;
+        unsigned int code;
+        unsigned int hash;
+        unsigned int sessions;
+        unsigned int transitions;
+        char build[32];
+        int text;
+        if (line[0] == '#' || line[0] == '\n')
+        {
+            continue;
+        }
+        if (sscanf(line, "end %lf", &ms) == 1)
+        {
+            t->end_ns = (uint64_t)(ms * 1e6);
+        }
+        else if (sscanf(line, "expect %31s uart %x sessions %u transitions %u",
+                        build, &hash, &sessions, &transitions) == 4)
+        {
+            if (strcmp(build, sim_build) == 0)
+            {
+                t->expect.expected = 1;
+                t->expect.uart_hash = hash;
+                t->expect.sessions = sessions;
+                t->expect.transitions = transitions;
+            }
+        }
+        else if (sscanf(line, "%lf rx %u %n", &ms, &baud, &text) == 2 && baud)
+        {
+            if (trace_add_rx(t, &capacity, (uint64_t)(ms * 1e6), baud,
+                             &line[text]))
+            {
+                fclose(f);
+                return -1;
+            }
+        }
+        else if (sscanf(line, "%lf pot %u", &ms, &code) == 2)
+        {
+            sim_event_t e = {(uint64_t)(ms * 1e6), 0, 0, 0, 1,
+                             code > 1023 ? 1023 : code};
+            trace_add(t, &capacity, e);
+        }
+        else if (sscanf(line, "%lf %u", &ms, &mask) == 2)
+        {
+            sim_event_t e = {(uint64_t)(ms * 1e6), 0, mask & 7, 0, 0, 0};
+            trace_add(t, &capacity, e);
+        }
+        else
+        {
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+    if (t->end_ns == 0 && t->count)
+    {
+        t->end_ns = t->events[t->count - 1].time_ns + NS_PER_S;
+    }
+    return 0;
+}
+
+
+static uint32_t rng_next(uint32_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+
+/*
+ * sim_trace_generate
+ *
+ * Write a synthetic trace of complete countdown sessions: a few second
+ * increments, start, wait for the alarm, acknowledge.
+ */
+void sim_trace_generate(FILE *out, uint32_t seed, uint16_t sessions)
+{
+    uint32_t s = seed ? seed : 1;
+    double t = 500;
+    uint16_t i;
+    fprintf(out, "# generated: seed %u, %u sessions\n", seed, sessions);
+    for (i = 0; i < sessions; i++)
+    {
+        uint8_t secs = 1 + rng_next(&s) % 5;
+        uint8_t j;
+        for (j = 0; j < secs; j++)
+        {
+            fprintf(out, "%.1f 2\n", t);
+            t += 60 + rng_next(&s) % 80;
+            fprintf(out, "%.1f 0\n", t);
+            t += 100 + rng_next(&s) % 150;
+        }
+        fprintf(out, "%.1f 4\n", t);
+        t += 80 + rng_next(&s) % 80;
+        fprintf(out, "%.1f 0\n", t);
+        t += secs * 1000.0 + 300 + rng_next(&s) % 400;
+        fprintf(out, "%.1f 1\n", t);
+        t += 80 + rng_next(&s) % 80;
+        fprintf(out, "%.1f 0\n", t);
+        t += 3200;
+    }
+    fprintf(out, "end %.1f\n", t);
+}
@@ -0,0 +1,186 @@
+/*
+ * File:   sim.h
+ * Author: Andy Smit
+ *
+ * Host simulator for the countdown firmware. Runs the real sources from
+ * src/ against a virtual clock. Timers, change notification and the UART
+ * transmitter are modelled closely enough that interrupts fire at the
+ * same virtual times they would on the PIC24F16KA101.
+ *
+ * Firmware code between Idle() calls takes no virtual time. Only Idle()
+ * moves the clock forward; the UART sends in the background meanwhile.
+ * Every time measured in a run is therefore time the firmware waited on
+ * the hardware or the trace, never time it spent computing.
+ *
+ * A trace can also send characters to U2RX at a given baud rate. The
+ * receiver samples them at its own rate, so a mismatch shows up as
+ * framing errors, and auto-baud measures the sync character.
+ */
+
+#ifndef SIM_H
+#define	SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "xc.h"
+#include "sched.h"
+
+// A single button edge, received character or turn of the pot from a
+// trace. buttons is the logical mask of pressed buttons (BUTTON1 = 1,
+// BUTTON2 = 2, BUTTON3 = 4). For a character, baud is the rate the peer
+// sent it at and time_ns the end of its stop bit; baud is 0 otherwise.
+// For a turn of the pot, analog is set and pot is the ADC code it reads
+// from then on.
+typedef struct
+{
+    uint64_t time_ns;
+    uint32_t baud;
+    uint8_t buttons;
+    uint8_t rx;
+    uint8_t analog;
+    uint16_t pot;
+} sim_event_t;
+
+// What a run of the trace must produce in this build (see sim_build),
+// from its "expect" line; expected is 0 if it has none for the build.
+typedef struct
+{
+    uint8_t expected;
+    uint32_t uart_hash;
+    uint32_t sessions;
+    uint32_t transitions;
+} sim_expect_t;
+
+typedef struct
+{
+    sim_event_t *events;
+    uint32_t count;
+    uint64_t end_ns;
+    sim_expect_t expect;
+} sim_trace_t;
+
+// The build, as a trace's "expect" lines name it: the board, then
+// "+lcd", "+frc8", "+nopolicy", "+profile" and "+bench" for each option
+// that changes the output.
+extern const char sim_build[];
+
+// Interrupt vectors modelled, in the order of sim_vector_names.
+#define SIM_NUM_VECTORS 11
+extern const char *const sim_vector_names[SIM_NUM_VECTORS];
+
+// Countdown end times kept per run.
+#define SIM_MAX_FINISHES 32
+
+// Results of replaying one trace.
+typedef struct
+{
+    uint64_t sim_ns;
+    uint32_t transitions;
+    uint32_t sessions;
+    uint32_t missed_events;
+    uint32_t uart_bytes;
+    uint32_t uart_hash;
+    // Time spent transmitting, and the baud rate at the end of the run.
+    uint64_t uart_tx_ns;
+    uint32_t uart_baud;
+    // Longest time from a button to the state change it made. Only waits
+    // on the hardware count, as code takes no time.
+    uint64_t max_latency_ns;
+    // Longest time from the alarm state to the end of its text on the
+    // wire.
+    uint64_t max_alarm_ns;
+    // Times the alarm text went out on a line with other text than the
+    // countdown.
+    uint32_t alarm_cuts;
+    // From the firmware's boot timestamps. Response is measured from the
+    // first button event in the trace; 0 if there was none.
+    uint64_t boot_display_ns;
+    uint64_t boot_response_ns;
+    // Time the LED was lit, weighted by PWM duty.
+    uint64_t led_on_ns;
+    // Time the piezo was sounding, in total and outside the alarm state.
+    uint64_t tone_ns;
+    uint64_t stray_tone_ns;
+    // On boards with a 7-segment display: the digits it last lit, as
+    // "MM:SS", the time any digit was lit and the refresh interrupts.
+    char display[6];
+    uint64_t display_lit_ns;
+    uint32_t display_irqs;
+    // The LCD on I2C1: its two rows at the end of the run, blank if it is
+    // off, the bytes sent on the bus and the instructions and characters
+    // the LCD was sent while still busy (see the LCD model in sim.c).
+    char lcd[2][17];
+    uint32_t i2c_bytes;
+    uint32_t lcd_early;
+    // Deepest host stack use of each ISR in bytes, 0 if it never ran or
+    // sim_isr_stack_check is off. The host's frames are larger than the
+    // PIC24's, so compare ISRs and runs rather than reading these as
+    // target sizes.
+    uint32_t isr_stack[SIM_NUM_VECTORS];
+    // The instruction clock at the end of the run, and the firmware's own
+    // estimate of it (CLOCK_get_fcy).
+    uint32_t fcy_hz;
+    uint32_t fcy_estimate_hz;
+    // Charge drawn from the supply in fC (uA x ns), the supply at the
+    // end of the run, and when the battery browned out, 0 if it did not.
+    // See sim_set_battery.
+    uint64_t charge_fc;
+    uint32_t vdd_mv;
+    uint64_t brownout_ns;
+    // Countdowns that ran without input, and how far their length was
+    // from the seconds set: the last one, and the largest either way.
+    uint32_t countdowns;
+    int64_t last_countdown_error_ns;
+    int64_t max_countdown_error_ns;
+    // When each countdown ended: the timebase interrupt that released its
+    // last second.
+    uint64_t finish_ns[SIM_MAX_FINISHES];
+    // The firmware's scheduler statistics at the end of the run.
+    sched_stats_t tasks[SCHED_NUM_TASKS];
+    // The trace's expectations for this build.
+    sim_expect_t expect;
+} sim_result_t;
+
+// The firmware's main(), renamed by the simulator's xc.h.
+int firmware_main(void);
+
+int sim_trace_load(const char *path, sim_trace_t *trace);
+
+void sim_trace_generate(FILE *out, uint32_t seed, uint16_t sessions);
+
+void sim_run(const sim_trace_t *trace, sim_result_t *result, FILE *uart_out,
+             FILE *log);
+
+void sim_isr_stack_check(int enable);
+
+uint64_t sim_now_ns(void);
+
+// Virtual bus between units, each replayed in its own process. Every
+// SIM_BUS_QUANTUM_NS of virtual time a unit writes a sim_bus_header_t to
+// out_fd followed by the characters it started sending during the
+// quantum, as rx events at the other end (time of the stop bit, rate),
+// and reads from in_fd a uint32_t count and that many characters to
+// receive. A character takes longer than a quantum up to 9600 baud, so
+// everything sent in a quantum arrives after it and the units can run
+// the quantum in parallel. At the end of its run the unit writes a
+// header with done set, followed by its sim_result_t (see replay.c).
+#define SIM_BUS_QUANTUM_NS 1000000ULL
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t done;
+} sim_bus_header_t;
+
+void sim_bus_attach(int out_fd, int in_fd);
+
+// Run the RC oscillators off nominal by ppm, as temperature and supply
+// do. Set before sim_run.
+void sim_set_clock_skew(int32_t ppm);
+
+// Run from a battery of uah uAh, which browns out once it is used up
+// (see the supply model in sim.c). 0, the default, is a fixed supply.
+// Set before sim_run.
+void sim_set_battery(uint32_t uah);
+
+#endif	/* SIM_H */
@@ -1,8 +1,74 @@
 #include "xc.h"
 #include "UART2.h"
 #include "string.h"
+#include "main.h"
+#include "power.h"
+#include "clock.h"
+#include "atomic.h"
+#include "sched.h"
+#include "timebase.h"
+#include "profile.h"
 
 unsigned int clkval;
+static uint8_t uart2_ready = 0;
+
+// Receive ring, filled by the RX ISR and drained from main.
+#define UART2_RX_SIZE 16
+static volatile uint8_t uart2_rx_buf[UART2_RX_SIZE];
+static volatile uint8_t uart2_rx_head = 0;
+static uint8_t uart2_rx_tail = 0;
+// Framing and overrun errors since UART2_take_errors.
+static volatile uint8_t uart2_errors = 0;
+// Set while an auto-baud measurement is armed, and once it completes.
+static volatile uint8_t uart2_autobaud = 0;
+static volatile uint8_t uart2_synced = 0;
+// Rate the divider was last set for, kept to recompute the divider when
+// the clock rate is recalibrated.
+static uint32_t uart2_baud = UART2_DEFAULT_BAUD;
+// Character whose arrival is timestamped, 0 for none, and the time the
+// last one arrived.
+static uint8_t uart2_mark = 0;
+static volatile uint32_t uart2_mark_time = 0;
+// Transmit queues, filled by the writers and emptied into the FIFO by
+// uart2_feed. The indices run freely and wrap with their uint8_t.
+// Bulk bytes, and the length of each frame of them still to start.
+static uint8_t uart2_tx_buf[UART2_TX_SIZE];
+static volatile uint8_t uart2_tx_head = 0;
+static volatile uint8_t uart2_tx_tail = 0;
+static uint8_t uart2_frame_len[UART2_TX_FRAMES];
+static volatile uint8_t uart2_frame_head = 0;
+static volatile uint8_t uart2_frame_tail = 0;
+// Bytes of the frame being sent still to go, 0 at a frame boundary.
+static volatile uint8_t uart2_frame_left = 0;
+// The last frame queued is a refresh.
+static uint8_t uart2_last_refresh = 0;
+static uint8_t uart2_urgent_buf[UART2_URGENT_SIZE];
+static volatile uint8_t uart2_urgent_head = 0;
+static volatile uint8_t uart2_urgent_tail = 0;
+// What the terminal line holds, so urgent text is kept off lines of
+// other text: it may follow a display line, begun with '\r', but starts a
+// line of its own otherwise, and bulk text after it does the same unless
+// it rewrites the line.
+typedef enum
+{
+    UART2_LINE_START = 0,
+    UART2_LINE_DISPLAY,
+    UART2_LINE_TEXT,
+    UART2_LINE_URGENT
+} uart2_line_t;
+static uart2_line_t uart2_line = UART2_LINE_START;
+// Bytes of the CR LF still to send before the next frame or urgent byte.
+static uint8_t uart2_newline = 0;
+// Transmit statistics, kept by the writers for the stream selected.
+static uart2_stream_t uart2_stream = UART2_STREAM_CONSOLE;
+static uart2_stats_t uart2_stats[UART2_NUM_STREAMS];
+static uint32_t uart2_stats_start = 0;
+static const char *const uart2_stream_names[UART2_NUM_STREAMS] = {
+    [UART2_STREAM_CONSOLE] = "console",
+    [UART2_STREAM_DISPLAY] = "display",
+    [UART2_STREAM_ALARM] = "alarm",
+    [UART2_STREAM_DEBUG] = "debug",
+};
 
 
 ///// Initialization of UART 2 module.
@@ -12,6 +78,9 @@ unsigned int clkval;
 
 void InitUART2(void) 
 {
+    // The console stays powered from its first use.
+    uart2_ready = 1;
+    POWER_acquire(POWER_UART2);
 
 	TRISBbits.TRISB0=0; // Set U2TX/RB0/pin 4 as UART TX
 	TRISBbits.TRISB1=1; // Set U2RX/RB1/pin 5 as UART RX
@@ -35,24 +104,13 @@ void InitUART2(void)
  */
     
     //configure baud rate based on sys clock
-	if (OSCCONbits.COSC == 0b110)
-	{
-		U2BRG = 12;	// gives a baud rate of 4807.7 Baud with 500kHz clock; Set Baud to 4800 on realterm
-	}
-	else if (OSCCONbits.COSC == 0b101)
-	{
-		U2BRG = 12;	// gives a baud rate of 300 Baud with 32kHz clock; set Baud to 300 on realterm
-	}
-	else if (OSCCONbits.COSC == 0b000)
-	{
-		U2BRG=103;	// gives a baud rate of 9600 with 8MHz clock; set Baud to 9600 on real term
-	}
+    UART2_set_baud(UART2_DEFAULT_BAUD);
 	// Initialize UART Status reg - Tx interrupt control
-	U2STA = 0b0010000000000000;
+	U2STA = 0b1000000000000000;
     
     /*
-    U2STAbits.UTXISEL1 = 1;	//Bit15 Int when Char is transferred (1/2 config!)
-    U2STAbits.UTXISEL0 = 1;	//Generate interrupt with last character shifted out of U2TXREG buffer
+    U2STAbits.UTXISEL1 = 1;	//Bit15 Int when the transmit buffer becomes empty
+    U2STAbits.UTXISEL0 = 0;	//(UART2_flush waits with 01, the last character shifted out)
 	U2STAbits.UTXINV = 0;	//Bit14 N/A, IRDA config
 	U2STAbits.UTXBRK = 0;	//Bit11 Disabled
 	U2STAbits.UTXEN = 0;	//Bit10 TX pins controlled by periph
@@ -69,13 +127,13 @@ void InitUART2(void)
 	
     //Configure Interrupts (for Tx)
     IFS1bits.U2TXIF = 0;	// Clear the Transmit Interrupt Flag
-    IPC7bits.U2TXIP = 3; // UART2 TX interrupt has interrupt priority 3-4th highest priority
-    IEC1bits.U2TXIE = 0;	// Disable Transmit Interrupts
+    IPC7bits.U2TXIP = IPL_UART_TX; // UART2 TX interrupt has interrupt priority 3-4th highest priority
+    IEC1bits.U2TXIE = 0;	// Enabled by uart2_feed while anything is queued
 	
     //Configure Interrupts (for Rx)
     IFS1bits.U2RXIF = 0;	// Clear the Recieve Interrupt Flag
-	IPC7bits.U2RXIP = 4; //UART2 Rx interrupt has 2nd highest priority
-    IEC1bits.U2RXIE = 0;	// Enable Recieve Interrupts
+	IPC7bits.U2RXIP = IPL_UART_RX; //UART2 Rx interrupt has 2nd highest priority
+    IEC1bits.U2RXIE = 1;	// Enable Recieve Interrupts
 
 	U2MODEbits.UARTEN = 1;	// And turn the peripheral on
 
@@ -85,30 +143,626 @@ void InitUART2(void)
 
 
 
+/*
+ * uart2_divider
+ *
+ * Compute U2BRG + 1 for a baud rate with 4 clocks per bit (BRGH = 1),
+ * rounded to the nearest divider.
+ *
+ * @return The divider, or 0 if it is out of range
+ */
+static uint32_t uart2_divider(uint32_t baud)
+{
+    uint32_t brg = (CLOCK_get_fcy() / 4 + baud / 2) / baud;
+
+    if (brg == 0 || brg > 0x10000UL)
+    {
+        return 0;
+    }
+    return brg;
+}
+
+
+/*
+ * uart2_brg
+ *
+ * Compute U2BRG + 1 for a baud rate with 4 clocks per bit (BRGH = 1).
+ *
+ * @return The divider, or 0 if the rate cannot be reached within
+ *         UART2_BAUD_TOLERANCE_PCT
+ */
+static uint32_t uart2_brg(uint32_t baud)
+{
+    uint32_t brg = uart2_divider(baud);
+    uint32_t actual;
+
+    if (brg == 0)
+    {
+        return 0;
+    }
+    actual = CLOCK_get_fcy() / 4 / brg;
+    if ((actual > baud ? actual - baud : baud - actual) * 100
+        > baud * UART2_BAUD_TOLERANCE_PCT)
+    {
+        return 0;
+    }
+    return brg;
+}
+
+
+/*
+ * UART2_baud_ok
+ *
+ * @param baud The rate in bits per second
+ * @return 1 if the instruction clock can generate the rate
+ */
+uint8_t UART2_baud_ok(uint32_t baud)
+{
+    return uart2_brg(baud) != 0;
+}
+
+
+/*
+ * UART2_set_baud
+ *
+ * Set the baud rate once the output queued so far has been sent. Rates
+ * the instruction clock cannot reach within UART2_BAUD_TOLERANCE_PCT are
+ * refused and the rate is left alone.
+ *
+ * @param baud The rate in bits per second
+ * @return 0 on success, -1 if the rate is out of tolerance
+ */
+int8_t UART2_set_baud(uint32_t baud)
+{
+    uint32_t brg = uart2_brg(baud);
+    if (!brg)
+    {
+        return -1;
+    }
+    // What is queued goes out at the old rate
+    if (U2STAbits.UTXEN)
+    {
+        UART2_flush();
+    }
+    U2BRG = brg - 1;
+    uart2_baud = baud;
+    return 0;
+}
+
+
+/*
+ * UART2_retune
+ *
+ * Recompute the divider for the current rate after the clock rate has
+ * been recalibrated. The rate was agreed with the other end, so it is
+ * kept even if the measured clock can no longer reach it within
+ * UART2_BAUD_TOLERANCE_PCT; the nearest divider is still the best.
+ *
+ * @param None
+ * @return None
+ */
+void UART2_retune(void)
+{
+    uint32_t brg;
+
+    // Not powered yet: InitUART2 computes the divider with the new rate.
+    if (!uart2_ready)
+    {
+        return;
+    }
+    brg = uart2_divider(uart2_baud);
+    if (brg)
+    {
+        U2BRG = brg - 1;
+    }
+}
+
+
+/*
+ * UART2_get_baud
+ *
+ * The rate set by UART2_set_baud or measured by auto-baud.
+ *
+ * @return The rate in bits per second
+ */
+uint32_t UART2_get_baud(void)
+{
+    return CLOCK_get_fcy() / 4 / ((uint32_t)U2BRG + 1);
+}
+
+
+/*
+ * UART2_autobaud
+ *
+ * Measure the baud rate on the next received character, which must be
+ * the sync character 0x55. UART2_take_sync reports when it has been
+ * measured; the sync character itself is not received.
+ *
+ * @param None
+ * @return None
+ */
+void UART2_autobaud(void)
+{
+    uart2_synced = 0;
+    uart2_autobaud = 1;
+    U2MODEbits.ABAUD = 1;
+}
+
+
+/*
+ * UART2_take_sync
+ *
+ * @return 1 once if an auto-baud measurement has completed, otherwise 0
+ */
+uint8_t UART2_take_sync(void)
+{
+    uint8_t synced = uart2_synced;
+    uart2_synced = 0;
+    if (synced)
+    {
+        uart2_baud = UART2_get_baud();
+    }
+    return synced;
+}
+
+
+/*
+ * UART2_set_mark
+ *
+ * Timestamp the arrival of a character. The stamp is taken in the
+ * receive ISR, at the end of the character's stop bit give or take the
+ * ISR latency, so it is as precise as the time a task sees the
+ * character is not.
+ *
+ * @param c The character, or 0 for none
+ * @return None
+ */
+void UART2_set_mark(uint8_t c)
+{
+    uart2_mark = c;
+}
+
+
+/*
+ * UART2_get_mark_time
+ *
+ * @return The system time the marked character last arrived
+ */
+uint32_t UART2_get_mark_time(void)
+{
+    uint16_t ipl;
+    uint32_t at;
+    CRITICAL_ENTER(ipl, IPL_UART_RX);
+    at = uart2_mark_time;
+    CRITICAL_EXIT(ipl);
+    return at;
+}
+
+
+/*
+ * UART2_read
+ *
+ * Take the next received character.
+ *
+ * @param c Where to store the character
+ * @return 1 if a character was taken, 0 if none was waiting
+ */
+uint8_t UART2_read(uint8_t *c)
+{
+    if (uart2_rx_tail == uart2_rx_head)
+    {
+        return 0;
+    }
+    *c = uart2_rx_buf[uart2_rx_tail];
+    uart2_rx_tail = (uart2_rx_tail + 1) % UART2_RX_SIZE;
+    return 1;
+}
+
+
+/*
+ * UART2_take_errors
+ *
+ * @return The number of framing and overrun errors since the last call
+ */
+uint8_t UART2_take_errors(void)
+{
+    uint16_t ipl;
+    uint8_t errors;
+    CRITICAL_ENTER(ipl, IPL_UART_RX);
+    errors = uart2_errors;
+    uart2_errors = 0;
+    CRITICAL_EXIT(ipl);
+    return errors;
+}
+
+
+
+/*
+ * UART2_select
+ *
+ * Charge the output from now on to a stream. Producers other than the
+ * console select their stream around their output and then select the
+ * one they found again, so that output from an ISR in between is charged
+ * to the right stream.
+ *
+ * @param stream The stream
+ * @return The stream selected until now
+ */
+uart2_stream_t UART2_select(uart2_stream_t stream)
+{
+    uart2_stream_t prev = uart2_stream;
+    uart2_stream = stream;
+    return prev;
+}
+
+
+/*
+ * UART2_get_stats
+ *
+ * @param stream The stream
+ * @return The stream's transmit statistics since they were last cleared
+ */
+const uart2_stats_t *UART2_get_stats(uart2_stream_t stream)
+{
+    return &uart2_stats[stream];
+}
+
+
+/*
+ * UART2_stream_name
+ *
+ * @param stream The stream
+ * @return The stream's name, for the console
+ */
+const char *UART2_stream_name(uart2_stream_t stream)
+{
+    return uart2_stream_names[stream];
+}
+
+
+/*
+ * UART2_stats_since
+ *
+ * @param None
+ * @return The system time the statistics were last cleared, 0 if never
+ */
+uint32_t UART2_stats_since(void)
+{
+    return uart2_stats_start;
+}
+
+
+/*
+ * UART2_clear_stats
+ *
+ * Start the statistics of every stream again from 0.
+ *
+ * @param None
+ * @return None
+ */
+void UART2_clear_stats(void)
+{
+    memset(uart2_stats, 0, sizeof(uart2_stats));
+    uart2_stats_start = TIMEBASE_now();
+}
+
+
+/*
+ * uart2_feed
+ *
+ * Move queued bytes into the transmit FIFO until it is full: urgent ones
+ * first whenever a bulk frame has been sent in full, each run of them
+ * and the bulk text after it on a new line as uart2_line says. Leaves the
+ * TX interrupt enabled while anything is left. Runs as the TX ISR, and
+ * from writers at IPL_UART_TX.
+ */
+static void uart2_feed(void)
+{
+    while (!U2STAbits.UTXBF)
+    {
+        uint8_t c;
+
+        if (uart2_newline)
+        {
+            U2TXREG = uart2_newline == 2 ? '\r' : '\n';
+            if (--uart2_newline == 0)
+            {
+                uart2_line = UART2_LINE_START;
+            }
+            continue;
+        }
+        if (uart2_frame_left == 0)
+        {
+            if (uart2_urgent_tail != uart2_urgent_head)
+            {
+                if (uart2_line == UART2_LINE_TEXT)
+                {
+                    uart2_newline = 2;
+                    continue;
+                }
+                U2TXREG = uart2_urgent_buf[uart2_urgent_tail
+                                           & (UART2_URGENT_SIZE - 1)];
+                uart2_urgent_tail++;
+                uart2_line = UART2_LINE_URGENT;
+                continue;
+            }
+            if (uart2_frame_tail == uart2_frame_head)
+            {
+                break;
+            }
+            uart2_frame_left = uart2_frame_len[uart2_frame_tail
+                                               & (UART2_TX_FRAMES - 1)];
+            uart2_frame_tail++;
+            if (uart2_tx_buf[uart2_tx_tail & (UART2_TX_SIZE - 1)] == '\r')
+            {
+                uart2_line = UART2_LINE_DISPLAY;
+            }
+            else if (uart2_line == UART2_LINE_URGENT)
+            {
+                uart2_newline = 2;
+                continue;
+            }
+            else if (uart2_line == UART2_LINE_DISPLAY)
+            {
+                uart2_line = UART2_LINE_TEXT;
+            }
+        }
+        c = uart2_tx_buf[uart2_tx_tail & (UART2_TX_SIZE - 1)];
+        U2TXREG = c;
+        uart2_tx_tail++;
+        uart2_frame_left--;
+        if (c == '\n')
+        {
+            uart2_line = UART2_LINE_START;
+        }
+        else if (uart2_line == UART2_LINE_START)
+        {
+            uart2_line = UART2_LINE_TEXT;
+        }
+    }
+    IEC1bits.U2TXIE = uart2_frame_left || uart2_newline
+                      || uart2_urgent_tail != uart2_urgent_head
+                      || uart2_frame_tail != uart2_frame_head;
+}
+
+
+/*
+ * uart2_wait
+ *
+ * Wait in Idle for the next event of the transmitter. Called at
+ * IPL_UART_TX or above from a critical section entered from priority
+ * ipl, having found the transmitter busy: its interrupt, masked, still
+ * wakes the core, so it cannot come between the test and Idle() unseen.
+ * Pending ISRs then run before the test is made again; a writer in an
+ * ISR that masks the TX ISR stays above it and feeds the UART itself.
+ */
+static void uart2_wait(uint16_t ipl)
+{
+    Idle();
+    CRITICAL_EXIT(ipl);
+    CRITICAL_ENTER(ipl, IPL_UART_TX);
+    if (IFS1bits.U2TXIF && IEC1bits.U2TXIE)
+    {
+        IFS1bits.U2TXIF = 0;
+        uart2_feed();
+    }
+}
+
+
+/*
+ * uart2_room
+ *
+ * @return 1 if the queue for the selected stream has room for a frame of
+ *         n bytes
+ */
+static uint8_t uart2_room(uint8_t urgent, uint8_t n)
+{
+    if (urgent)
+    {
+        return (uint8_t)(uart2_urgent_head - uart2_urgent_tail)
+               <= UART2_URGENT_SIZE - n;
+    }
+    return (uint8_t)(uart2_tx_head - uart2_tx_tail) <= UART2_TX_SIZE - n
+           && (uint8_t)(uart2_frame_head - uart2_frame_tail) < UART2_TX_FRAMES;
+}
+
+
+/*
+ * uart2_queue
+ *
+ * Queue a write for the selected stream, waiting for room as needed. Bulk
+ * writes are split into frames of up to UART2_FRAME_MAX bytes. A refresh
+ * first drops the refresh before it if that is still waiting at the end
+ * of the queue.
+ *
+ * @param data The bytes, or NULL to send fill len times
+ * @param fill The byte to repeat if data is NULL
+ * @param len Bytes to send
+ * @param refresh 1 if the write is a refresh
+ */
+static void uart2_queue(const char *data, char fill, unsigned int len,
+                        uint8_t refresh)
+{
+    uart2_stats_t *stats = &uart2_stats[uart2_stream];
+    uint8_t urgent = uart2_stream == UART2_STREAM_ALARM;
+    uint8_t max = urgent ? UART2_URGENT_SIZE : UART2_FRAME_MAX;
+    uint32_t start = 0;
+    uint8_t waited = 0;
+    uint8_t queued;
+    uint16_t ipl;
+
+    // The UART is brought up on first use so it stays out of the boot path
+    if (!uart2_ready)
+    {
+        InitUART2();
+    }
+    stats->bytes += len;
+
+    CRITICAL_ENTER(ipl, IPL_UART_TX);
+    if (refresh && uart2_last_refresh
+        && uart2_frame_tail != uart2_frame_head)
+    {
+        uint8_t n;
+        uart2_frame_head--;
+        n = uart2_frame_len[uart2_frame_head & (UART2_TX_FRAMES - 1)];
+        uart2_tx_head -= n;
+        stats->dropped = (uint32_t)stats->dropped + n > 0xFFFF
+                         ? 0xFFFF : stats->dropped + n;
+    }
+    while (len)
+    {
+        uint8_t n = len > max ? max : len;
+        uint8_t i;
+
+        while (!uart2_room(urgent, n))
+        {
+            if (!waited)
+            {
+                waited = 1;
+                start = TIMEBASE_now();
+                if (stats->full != 0xFFFF)
+                {
+                    stats->full++;
+                }
+            }
+            uart2_wait(ipl);
+        }
+        // The space after the head is the writer's until it is published
+        CRITICAL_EXIT(ipl);
+        for (i = 0; i < n; i++)
+        {
+            char c = data ? data[i] : fill;
+            if (urgent)
+            {
+                uart2_urgent_buf[(uint8_t)(uart2_urgent_head + i)
+                                 & (UART2_URGENT_SIZE - 1)] = c;
+            }
+            else
+            {
+                uart2_tx_buf[(uint8_t)(uart2_tx_head + i)
+                             & (UART2_TX_SIZE - 1)] = c;
+            }
+        }
+        CRITICAL_ENTER(ipl, IPL_UART_TX);
+        if (urgent)
+        {
+            uart2_urgent_head += n;
+        }
+        else
+        {
+            uart2_frame_len[uart2_frame_head & (UART2_TX_FRAMES - 1)] = n;
+            uart2_frame_head++;
+            uart2_tx_head += n;
+            uart2_last_refresh = refresh;
+        }
+        uart2_feed();
+        if (data)
+        {
+            data += n;
+        }
+        len -= n;
+    }
+    queued = urgent ? uart2_urgent_head - uart2_urgent_tail
+                    : uart2_tx_head - uart2_tx_tail;
+    CRITICAL_EXIT(ipl);
+
+    if (queued > stats->max_queued)
+    {
+        stats->max_queued = queued;
+    }
+    if (waited)
+    {
+        stats->blocked += TIMEBASE_elapsed(start);
+    }
+}
+
+
+/*
+ * UART2_refresh
+ *
+ * Queue a redraw of the display, replacing the previous one if that has
+ * not started to go out and nothing has been queued since.
+ *
+ * @param str The redraw
+ * @return None
+ */
+void UART2_refresh(char *str)
+{
+    uart2_queue(str, 0, strlen(str), 1);
+}
+
+
+/*
+ * UART2_flush
+ *
+ * Wait in Idle until everything queued has been sent, to the end of the
+ * last stop bit. A line the urgent text left open is ended first, so what
+ * is written next goes out as soon as it is written.
+ *
+ * @param None
+ * @return None
+ */
+void UART2_flush(void)
+{
+    uint16_t ipl;
+
+    if (!uart2_ready)
+    {
+        return;
+    }
+    CRITICAL_ENTER(ipl, IPL_UART_TX);
+    while (IEC1bits.U2TXIE || uart2_line == UART2_LINE_URGENT)
+    {
+        if (!IEC1bits.U2TXIE)
+        {
+            uart2_newline = 2;
+            uart2_feed();
+            continue;
+        }
+        uart2_wait(ipl);
+    }
+    // Interrupt once the last character has been shifted out instead
+    IFS1bits.U2TXIF = 0;
+    U2STAbits.UTXISEL0 = 1;
+    U2STAbits.UTXISEL1 = 0;
+    IEC1bits.U2TXIE = 1;
+    while (!U2STAbits.TRMT)
+    {
+        uart2_wait(ipl);
+    }
+    IEC1bits.U2TXIE = 0;
+    IFS1bits.U2TXIF = 0;
+    U2STAbits.UTXISEL0 = 0;
+    U2STAbits.UTXISEL1 = 1;
+    CRITICAL_EXIT(ipl);
+}
+
+
+/*
+ * UART2_is_idle
+ *
+ * @param None
+ * @return 1 if everything queued has been sent, to the end of the last
+ *         stop bit
+ */
+uint8_t UART2_is_idle(void)
+{
+    return !uart2_ready || (!IEC1bits.U2TXIE && U2STAbits.TRMT);
+}
+
+
 ///// Xmit UART2: 
 ///// Displays 'DispData' on PC terminal 'repeatNo' of times using UART to PC. 
-///// Adjust Baud on real term as per clock: 
-////  32kHz clock - Baud=300 ; 500kHz clock - Baud=4800; 8MHz clock - Baud=9600 
+///// Starts at UART2_DEFAULT_BAUD (4800) on any clock; see link.c for
+///// changing it. Queued; see UART2.h.
 
 void XmitUART2(char CharNum, unsigned int repeatNo)
 {	
-   // InitUART2();	//Initialize UART2 module at start of main()
-   
-	while(repeatNo!=0) 
-	{
-		while(U2STAbits.UTXBF==1)	//Just loop here till the FIFO buffers have room for one more entry
-		{
-//			Idle();
-		}	
-		U2TXREG=CharNum;	//Move Data to be displayed in UART FIFO buffer
-		repeatNo--;
-	}
-	while(U2STAbits.TRMT==0)	//Turn off UART2 upon transmission of last character; also can be Verified in interrupt subroutine U2TXInterrupt()
-	{
-		
-	}
+    PROFILE_ENTER();
+    uart2_queue(NULL, CharNum, repeatNo, 0);
 	// U2MODEbits.UARTEN = 0;	// turn off UART module to save power - OPTIONAL
 
+    PROFILE_EXIT(PROFILE_XMITUART2);
 	return;
 }
 
@@ -117,11 +771,55 @@ void XmitUART2(char CharNum, unsigned int repeatNo)
 
 
 
-// Interrupt service routine for UART TX
+// Interrupt service routine for UART RX. Moves every received character
+// into the ring; characters with a framing error, and overruns, are only
+// counted.
+void ISR _U2RXInterrupt(void)
+{
+    PROFILE_ISR_ENTER();
 
-void __attribute__ ((interrupt, no_auto_psv)) _U2TXInterrupt(void) {
-	IFS1bits.U2TXIF = 0;
+    IFS1bits.U2RXIF = 0;
+    if (uart2_autobaud && !U2MODEbits.ABAUD)
+    {
+        uart2_autobaud = 0;
+        uart2_synced = 1;
+    }
+    while (U2STAbits.URXDA)
+    {
+        uint8_t ferr = U2STAbits.FERR;
+        uint8_t c = U2RXREG;
+        uint8_t next = (uart2_rx_head + 1) % UART2_RX_SIZE;
+        if (ferr || next == uart2_rx_tail)
+        {
+            uart2_errors++;
+            continue;
+        }
+        if (c == uart2_mark && c)
+        {
+            uart2_mark_time = TIMEBASE_now();
+        }
+        uart2_rx_buf[uart2_rx_head] = c;
+        uart2_rx_head = next;
+    }
+    if (U2STAbits.OERR)
+    {
+        // Clearing OERR empties the receive FIFO
+        uart2_errors++;
+        U2STAbits.OERR = 0;
+    }
+    SCHED_post(SCHED_TASK_LINK);
+    PROFILE_ISR_EXIT(PROFILE_ISR_UART_RX);
+}
 
+
+// Interrupt service routine for UART TX: the FIFO has emptied, refill it.
+
+void ISR _U2TXInterrupt(void) {
+	PROFILE_ISR_ENTER();
+
+	IFS1bits.U2TXIF = 0;
+	uart2_feed();
+	PROFILE_ISR_EXIT(PROFILE_ISR_UART_TX);
 }
 
 
@@ -213,17 +911,15 @@ void Disp2Dec(unsigned int DispNum)
 //Displays String of characters in str using UART
 void Disp2String(char *str) 
 {
-    unsigned int i;
+    PROFILE_ENTER();
    // XmitUART2(0x0A,2);  //LF
    // XmitUART2(0x0D,1);  //CR 
-    for (i=0; i<= strlen(str); i++)
-    {
-          
-        XmitUART2(str[i],1);
-    }
+    // With its terminator, as it always has been
+    uart2_queue(str, 0, strlen(str) + 1, 0);
     // XmitUART2(0x0A,2);  //LF
     // XmitUART2(0x0D,1);  //CR 
     
+    PROFILE_EXIT(PROFILE_DISP2STRING);
     return;
 }
 
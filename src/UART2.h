@@ -8,6 +8,55 @@
 #ifndef UART2_H
 #define	UART2_H
 
+#include <stdint.h>
+
+// Rate after reset, and how far the actual rate may be from the one
+// asked for.
+#define UART2_DEFAULT_BAUD 4800UL
+#define UART2_BAUD_TOLERANCE_PCT 2
+
+// Transmit queue. A write returns once it is queued, and the TX interrupt
+// sends it. Bulk output goes out in order, in frames of one write or of
+// UART2_FRAME_MAX bytes of a longer one. Urgent output, from the alarm
+// stream, goes ahead of it at the next frame boundary, so it waits at
+// most one frame and the FIFO, plus a CR LF where it would otherwise
+// land on a line of other output. A display refresh that is still waiting
+// at the end of the queue when the next one is written is dropped.
+// UART2_TX_SIZE and UART2_URGENT_SIZE are powers of 2 up to 128.
+#define UART2_TX_SIZE 128
+#define UART2_TX_FRAMES 16
+#define UART2_URGENT_SIZE 16
+#define UART2_FRAME_MAX 64
+
+// Producers of transmitted bytes, counted apart. Output is charged to
+// the stream last selected with UART2_select; the console stream takes
+// everything not selected otherwise: answers to commands, sync and
+// battery reports.
+typedef enum
+{
+    UART2_STREAM_CONSOLE = 0,
+    UART2_STREAM_DISPLAY,
+    UART2_STREAM_ALARM,
+    UART2_STREAM_DEBUG,
+    UART2_NUM_STREAMS
+} uart2_stream_t;
+
+// Transmit statistics of a stream since they were last cleared. A write
+// is one call of XmitUART2 or one string. The counts of 16 bits
+// saturate at 0xFFFF.
+typedef struct
+{
+    uint32_t bytes;
+    // Timebase ticks the writer spent waiting for room in the queue.
+    uint32_t blocked;
+    // Writes that found the queue full.
+    uint16_t full;
+    // Bytes of refreshes dropped for a newer one.
+    uint16_t dropped;
+    // The most bytes waiting in the queue after a write.
+    uint16_t max_queued;
+} uart2_stats_t;
+
 #ifdef	__cplusplus
 extern "C" {
 #endif
@@ -23,6 +72,26 @@ void InitUART2(void);
 void XmitUART2(char, unsigned int);
 
 void __attribute__ ((interrupt, no_auto_psv)) _U2TXInterrupt(void); 
+void __attribute__ ((interrupt, no_auto_psv)) _U2RXInterrupt(void);
+
+uint8_t UART2_baud_ok(uint32_t baud);
+int8_t UART2_set_baud(uint32_t baud);
+uint32_t UART2_get_baud(void);
+void UART2_retune(void);
+void UART2_autobaud(void);
+uint8_t UART2_take_sync(void);
+void UART2_set_mark(uint8_t c);
+uint32_t UART2_get_mark_time(void);
+uint8_t UART2_read(uint8_t *c);
+uint8_t UART2_take_errors(void);
+void UART2_refresh(char *str);
+void UART2_flush(void);
+uint8_t UART2_is_idle(void);
+uart2_stream_t UART2_select(uart2_stream_t stream);
+const uart2_stats_t *UART2_get_stats(uart2_stream_t stream);
+const char *UART2_stream_name(uart2_stream_t stream);
+uint32_t UART2_stats_since(void);
+void UART2_clear_stats(void);
 
 void Disp2Hex(unsigned int);
 void Disp2Hex32(unsigned long int);
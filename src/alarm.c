@@ -0,0 +1,166 @@
+/*
+ * File:   alarm.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Audible alarm for a piezo on RB15. The PIC24F16KA101 has a single
+ * output compare, which runs the LED, so the tone comes from the
+ * reference clock output: the system clock divided by a power of two is
+ * a square wave with no CPU involvement. The on/off cadence is a timed
+ * task, so the core idles between steps while the alarm sounds.
+ *
+ * A pattern is a const table of steps, each a tone (or silence) and how
+ * long it lasts. The table repeats until ALARM_stop. On a board without
+ * a piezo (BOARD_HAS_PIEZO) the 7-segment display flashes instead, lit
+ * for the tones and blank for the silences.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "alarm.h"
+#include "io.h"
+#include "clock.h"
+#include "sched.h"
+#include "timebase.h"
+#include "display.h"
+#include "board.h"
+
+// RODIV for the tones: Fosc / 2^RODIV
+#define ALARM_SILENT 0xFF
+#define ALARM_TONE_3906HZ (7 + CLOCK_FOSC_SHIFT)
+#define ALARM_TONE_1953HZ (8 + CLOCK_FOSC_SHIFT)
+
+typedef struct
+{
+    uint8_t rodiv;
+    uint16_t ticks;
+} alarm_step_t;
+
+typedef struct
+{
+    uint8_t num_steps;
+    const alarm_step_t *steps;
+} alarm_pattern_t;
+
+#define ALARM_STEP(rodiv, ms) {rodiv, TIMEBASE_MS_TO_TICKS(ms)}
+
+// Four short beeps and a pause
+static const alarm_step_t alarm_steps_beeps[] = {
+    ALARM_STEP(ALARM_TONE_3906HZ, 100), ALARM_STEP(ALARM_SILENT, 100),
+    ALARM_STEP(ALARM_TONE_3906HZ, 100), ALARM_STEP(ALARM_SILENT, 100),
+    ALARM_STEP(ALARM_TONE_3906HZ, 100), ALARM_STEP(ALARM_SILENT, 100),
+    ALARM_STEP(ALARM_TONE_3906HZ, 100), ALARM_STEP(ALARM_SILENT, 600),
+};
+// Two tones alternating
+static const alarm_step_t alarm_steps_warble[] = {
+    ALARM_STEP(ALARM_TONE_3906HZ, 250), ALARM_STEP(ALARM_TONE_1953HZ, 250),
+};
+static const alarm_step_t alarm_steps_continuous[] = {
+    ALARM_STEP(ALARM_TONE_3906HZ, 1000),
+};
+
+static const alarm_pattern_t alarm_patterns[ALARM_NUM_PATTERNS] = {
+    [ALARM_PATTERN_BEEPS] = {sizeof(alarm_steps_beeps) / sizeof(alarm_step_t),
+                             alarm_steps_beeps},
+    [ALARM_PATTERN_WARBLE] = {sizeof(alarm_steps_warble) / sizeof(alarm_step_t),
+                              alarm_steps_warble},
+    [ALARM_PATTERN_CONTINUOUS] = {sizeof(alarm_steps_continuous) / sizeof(alarm_step_t),
+                                  alarm_steps_continuous},
+};
+
+static const alarm_pattern_t *alarm_pattern = NULL;
+static uint8_t alarm_step = 0;
+
+
+static void alarm_apply_step(void)
+{
+    const alarm_step_t *step = &alarm_pattern->steps[alarm_step];
+#if BOARD_HAS_PIEZO
+    REFOCONbits.ROEN = 0;
+    if (step->rodiv != ALARM_SILENT)
+    {
+        REFOCONbits.RODIV = step->rodiv;
+        REFOCONbits.ROEN = 1;
+    }
+#else
+    DISPLAY_blank(step->rodiv == ALARM_SILENT);
+#endif
+}
+
+
+/*
+ * ALARM_handle_step_event
+ *
+ * Move to the next step of the pattern. Runs as the alarm task at the end
+ * of each step. The end of the new step is timed from when this run was
+ * due, so the cadence does not drift.
+ *
+ * @param None
+ * @return None
+ */
+void ALARM_handle_step_event(void)
+{
+    if (!alarm_pattern)
+    {
+        return;
+    }
+    if (++alarm_step >= alarm_pattern->num_steps)
+    {
+        alarm_step = 0;
+    }
+    alarm_apply_step();
+    SCHED_post_at(SCHED_TASK_ALARM, SCHED_release_time(SCHED_TASK_ALARM)
+                  + alarm_pattern->steps[alarm_step].ticks);
+}
+
+
+/*
+ * ALARM_start
+ *
+ * Start sounding an alarm pattern until ALARM_stop.
+ *
+ * @param id The pattern
+ * @return None
+ */
+void ALARM_start(alarm_pattern_id_t id)
+{
+    if (alarm_pattern)
+    {
+        ALARM_stop();
+    }
+    alarm_pattern = &alarm_patterns[id];
+    alarm_step = 0;
+
+#if BOARD_HAS_PIEZO
+    REFO_start(ALARM_TONE_3906HZ);
+#endif
+    alarm_apply_step();
+    SCHED_post_at(SCHED_TASK_ALARM,
+                  TIMEBASE_now() + alarm_pattern->steps[0].ticks);
+}
+
+
+/*
+ * ALARM_stop
+ *
+ * Silence the alarm and release the reference clock.
+ *
+ * @param None
+ * @return None
+ */
+void ALARM_stop(void)
+{
+    if (!alarm_pattern)
+    {
+        return;
+    }
+    SCHED_cancel(SCHED_TASK_ALARM);
+#if BOARD_HAS_PIEZO
+    REFOCONbits.ROEN = 0;
+    REFO_stop();
+#else
+    DISPLAY_blank(0);
+#endif
+    alarm_pattern = NULL;
+}
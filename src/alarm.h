@@ -0,0 +1,38 @@
+/*
+ * File: alarm.h
+ * Author: Andy Smit
+ * Comments: Piezo alarm on the REFO pin (RB15).
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef ALARM_H
+#define	ALARM_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+typedef enum
+{
+    ALARM_PATTERN_BEEPS = 0,
+    ALARM_PATTERN_WARBLE,
+    ALARM_PATTERN_CONTINUOUS,
+    ALARM_NUM_PATTERNS
+} alarm_pattern_id_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void ALARM_start(alarm_pattern_id_t id);
+
+void ALARM_stop(void);
+
+void ALARM_handle_step_event(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* ALARM_H */
@@ -7,18 +7,27 @@
 #include <xc.h>
 #include <stdio.h>
 #include "main.h"
-#include "timer.h"
 #include "app.h"
 #include "io.h"
 #include "UART2.h"
+#include "sched.h"
+#include "timebase.h"
+#include "eeprom.h"
+#include "led.h"
+#include "alarm.h"
+#include "calib.h"
+#include "sync.h"
+#include "battery.h"
+#include "pot.h"
+#include "display.h"
+#include "lcd.h"
+#include "profile.h"
+#include "bcd.h"
 
 
 // Private function prototypes
-void app_state_enter_time_main(void);
-void app_state_countdown_main(void);
-void app_state_timer_finish_main(void);
-
 void app_state_countdown_init(void);
+void app_countdown_resume(void);
 void app_state_timer_finish_init(void);
 
 void app_enter_time_button_press(button_t buttons);
@@ -26,12 +35,132 @@ void app_countdown_button_press(button_t buttons);
 void app_timer_finish_button_press(button_t buttons);
 void app_display_time(void);
 void app_clear_term_line(void);
+uint8_t app_on_interval(void);
 
 
 // Private variables
-static uint16_t countdown_s = 0;
+// The countdown, as BCD minutes and seconds
+static bcd_time_t countdown = 0;
+
+// Fraction of a tick carried between the seconds of the countdown, see
+// CALIB_next_second
+static uint8_t second_residue = 0;
+
+// On a low battery the countdown is shown less often, but always for
+// its last seconds.
+#define APP_DISPLAY_FINAL BCD_TIME(0x00, 0x10)
+// Seconds until the terminal shows the countdown again, and the display
+// interval they count; 0 to start counting again from the countdown
+static uint8_t display_wait = 0;
+static uint8_t display_interval = 0;
+
+// Sound of the alarm when the countdown expires
+#define APP_ALARM_PATTERN ALARM_PATTERN_BEEPS
+
+// Preset recalled during time entry, or APP_NO_PRESET
+#define APP_NO_PRESET 0xFF
+static uint8_t preset = APP_NO_PRESET;
+static const char *const preset_names[EEPROM_NUM_PRESETS] = {
+    " [Preset 1]", " [Preset 2]", " [Preset 3]", " [Preset 4]"
+};
 
 // Public Functions
+/*
+ * APP_init
+ *
+ * Enter STATE_ENTER_TIME with the countdown last started before the unit
+ * was powered off. Nothing is displayed, so buttons are live as soon as
+ * this returns.
+ *
+ * @param None
+ * @returns None
+ */
+void APP_init(void)
+{
+    countdown = BCD_from_seconds(EEPROM_get_last());
+    app_state = STATE_ENTER_TIME;
+    preset = APP_NO_PRESET;
+    IO_set_button_callback(&app_enter_time_button_press);
+    LED_set_pattern(LED_PATTERN_OFF);
+    POT_start();
+}
+
+
+/*
+ * APP_display_boot
+ *
+ * First display after reset. Starts a new terminal line instead of
+ * clearing the current one, which is 10 characters instead of 90.
+ *
+ * @param None
+ * @returns None
+ */
+void APP_display_boot(void)
+{
+    uart2_stream_t prev = UART2_select(UART2_STREAM_DISPLAY);
+
+    Disp2String("\n");
+    UART2_select(prev);
+    app_display_time();
+}
+
+
+/*
+ * APP_display_status
+ *
+ * Print the state, the countdown in seconds and the presets on their own
+ * line, for the status dump.
+ *
+ * @param None
+ * @returns None
+ */
+void APP_display_status(void)
+{
+    char s[40];
+    uint8_t i;
+
+    snprintf(s, sizeof(s), "state %d countdown %u presets", app_state,
+             BCD_to_seconds(countdown));
+    Disp2String(s);
+    for (i = 0; i < EEPROM_NUM_PRESETS; i++)
+    {
+        snprintf(s, sizeof(s), " %u", EEPROM_get_preset(i));
+        Disp2String(s);
+    }
+    Disp2String("\r\n");
+}
+
+
+/*
+ * APP_clear_line
+ *
+ * Clear the terminal line, for output that wrote over it without ending
+ * it.
+ *
+ * @param None
+ * @returns None
+ */
+void APP_clear_line(void)
+{
+    app_clear_term_line();
+}
+
+
+/*
+ * APP_redisplay
+ *
+ * Show the countdown at the start of the terminal line again, after
+ * other output.
+ *
+ * @param None
+ * @returns None
+ */
+void APP_redisplay(void)
+{
+    app_display_time();
+}
+
+
 /*
  * APP_state_enter_time_init
  *
@@ -44,124 +173,215 @@ static uint16_t countdown_s = 0;
 void APP_state_enter_time_init(void)
 {
     app_state = STATE_ENTER_TIME;
+    preset = APP_NO_PRESET;
     IO_set_button_callback(&app_enter_time_button_press);
-    LED_off();
+    LED_set_pattern(LED_PATTERN_OFF);
     app_clear_term_line();
     app_display_time();
+    POT_start();
 }
 
 
 /*
- * APP_state_machine_main
+ * APP_set_time
  *
- * Main function to be run every main loop for the state machine. Calls
- * current states main functions.
+ * Set the countdown during time entry, and show it. Called by pot.c when
+ * the pot is turned to a new setting.
+ *
+ * @param seconds The countdown in seconds
+ * @returns None
+ */
+void APP_set_time(uint16_t seconds)
+{
+    if (app_state != STATE_ENTER_TIME)
+    {
+        return;
+    }
+    countdown = BCD_from_seconds(seconds);
+    if (preset != APP_NO_PRESET)
+    {
+        // Clear the preset's name
+        preset = APP_NO_PRESET;
+        app_clear_term_line();
+    }
+    app_display_time();
+}
+
+
+/*
+ * APP_handle_hold_event
+ *
+ * Auto-repeat of a held button 1 or 2 during time entry. Runs as the
+ * hold task, posted by io.c when a button goes down, and every
+ * IO_HOLD_TICK_MS after until it is released while it repeats.
  *
  * @param None
  * @returns None
  */
-void APP_state_machine_main(void)
+void APP_handle_hold_event(void)
 {
-    switch (app_state)
+    if (app_state != STATE_ENTER_TIME)
     {
-        case STATE_ENTER_TIME:
-        {
-            app_state_enter_time_main();
-            break;
-        }
-        case STATE_COUNTDOWN:
+        return;
+    }
+    switch (Io_get_buttons())
+    {
+        // Button 1 increment minutes
+        case BUTTON1:
         {
-            app_state_countdown_main();
+            // Past 59 minutes the minutes go back to 0.
+            countdown = BCD_inc_minute(countdown);
             break;
         }
-        case STATE_TIMER_FINISH:
+        // Button 2 increment seconds
+        case BUTTON2:
         {
-            app_state_timer_finish_main();
+            countdown = BCD_inc_second(countdown);
             break;
         }
+        // Nothing else repeats
         default:
-            break;
+            return;
     }
+    SCHED_post_at(SCHED_TASK_HOLD, SCHED_release_time(SCHED_TASK_HOLD)
+                                   + TIMEBASE_MS_TO_TICKS(IO_HOLD_TICK_MS));
+    app_display_time();
 }
 
 
-// Private functions
+/*
+ * APP_handle_countdown_event
+ *
+ * One second of the countdown: decrement it and update the display. Runs
+ * as the countdown task, which reposts itself a second after each release
+ * so the seconds do not drift however late a run starts. The second is
+ * measured against the crystal where the board has one (see calib.c), or
+ * ends with the leader's when following one (see sync.c). The LED
+ * flashes on its own. On a low battery only every few seconds are shown
+ * on the terminal (see battery.c); the 7-segment display shows them
+ * all.
+ *
+ * @param None
+ * @returns None
+ */
+void APP_handle_countdown_event(void)
+{
+    uint32_t due;
+
+    if (app_state != STATE_COUNTDOWN)
+    {
+        return;
+    }
+    if (!SYNC_next_due(&due))
+    {
+        due = SCHED_release_time(SCHED_TASK_COUNTDOWN)
+              + CALIB_next_second(&second_residue);
+    }
+    SCHED_post_at(SCHED_TASK_COUNTDOWN, due);
+    countdown = BCD_dec_second(countdown);
+    // app_on_interval first: it counts every second
+    if (app_on_interval() || countdown <= APP_DISPLAY_FINAL)
+    {
+        app_display_time();
+    }
+    else
+    {
+        // The 7-segment display and the LCD cost no CPU time to update
+        DISPLAY_show_time(countdown);
+        LCD_show_time(countdown);
+    }
+
+    if (countdown == 0)
+    {
+        app_state_timer_finish_init();
+    }
+}
+
 
 /*
- * app_state_enter_time_main
+ * APP_sync_run
+ *
+ * Run the countdown from a number of seconds on the leader's time, from
+ * any state. Called by sync.c for the leader's @C.
  *
- * Main function for STATE_ENTER_TIME
-*/
-void app_state_enter_time_main(void)
+ * @param seconds Seconds left
+ * @returns None
+ */
+void APP_sync_run(uint16_t seconds)
 {
-    // If the timer has gone off increment the countdown
-    if(interrupt_state.timer3_trig)
+    uint32_t due;
+
+    if (app_state == STATE_TIMER_FINISH)
     {
-        interrupt_state.timer3_trig = 0;
-        switch (Io_get_buttons())
-        {
-            // Button 1 increment minutes
-            case BUTTON1:
-            {
-                countdown_s += 60;
-                // If the countdown timer goes above 59 minutes reset
-                // minutes to 0.
-                if ((countdown_s / 60) > 59)
-                {
-                    countdown_s %= 60;
-                }
-                break;
-            }
-            // Button 2 increment seconds
-            case BUTTON2:
-            {
-                countdown_s ++;
-                break;
-            }
-        }
+        ALARM_stop();
     }
+    app_state = STATE_COUNTDOWN;
+    IO_set_button_callback(&app_countdown_button_press);
+    countdown = BCD_from_seconds(seconds);
+    display_interval = 0;
+    SYNC_next_due(&due);
+    SCHED_post_at(SCHED_TASK_COUNTDOWN, due);
+    LED_set_pattern(LED_PATTERN_COUNTDOWN);
     app_display_time();
 }
 
 
 /*
- * app_state_countdown_main
+ * APP_sync_hold
+ *
+ * Pause the countdown at a number of seconds, from any state. Called by
+ * sync.c for the leader's @P.
  *
- * Main function for STATE_COUNTDOWN
+ * @param seconds Seconds left
+ * @returns None
  */
-void app_state_countdown_main(void)
+void APP_sync_hold(uint16_t seconds)
 {
-    // When the timer trigers, decrement countdown, update display,
-    // toggle LED
-    if(interrupt_state.timer1_trig)
+    if (app_state == STATE_TIMER_FINISH)
     {
-        interrupt_state.timer1_trig = 0;
-        countdown_s--;
-        app_display_time();
-        LED_toggle();
-
-        if (countdown_s == 0)
-        {
-            app_state_timer_finish_init();
-        }
+        ALARM_stop();
     }
+    app_state = STATE_COUNTDOWN;
+    IO_set_button_callback(&app_countdown_button_press);
+    SCHED_cancel(SCHED_TASK_COUNTDOWN);
+    countdown = BCD_from_seconds(seconds);
+    LED_set_pattern(LED_PATTERN_PAUSED);
+    app_display_time();
 }
 
+
 /*
- * app_state_timer_finish_main
+ * APP_sync_cancel
+ *
+ * Cancel the countdown and go back to time entry. Called by sync.c for
+ * the leader's @X.
  *
- * Main function for STATE_TIMER_FINISH
+ * @param None
+ * @returns None
  */
-void app_state_timer_finish_main(void)
+void APP_sync_cancel(void)
 {
-
+    if (app_state == STATE_ENTER_TIME)
+    {
+        return;
+    }
+    if (app_state == STATE_TIMER_FINISH)
+    {
+        ALARM_stop();
+    }
+    SCHED_cancel(SCHED_TASK_COUNTDOWN);
+    countdown = 0;
+    APP_state_enter_time_init();
 }
 
+
+// Private functions
+
 /*
  * app_state_countdown_init
  *
- * Initialize STATE_COUNTDOWN. Start a 1000ms timer to keep track of the
- * countdown and sets appropriate button callback.
+ * Initialize STATE_COUNTDOWN. Schedule the first second of the countdown
+ * and set the appropriate button callback.
  *
  * @param None
  * @returns None
@@ -170,8 +390,28 @@ void app_state_countdown_init(void)
 {
     app_state = STATE_COUNTDOWN;
     IO_set_button_callback(&app_countdown_button_press);
-    // Start a 1000ms timeSet a callback to be used when a button is pressed.
-    timer_start(TIMER1, 1000);
+    app_countdown_resume();
+}
+
+
+/*
+ * app_countdown_resume
+ *
+ * Schedule the end of a full second from now, and tell any followers.
+ *
+ * @param None
+ * @returns None
+ */
+void app_countdown_resume(void)
+{
+    uint32_t due;
+
+    second_residue = 0;
+    display_interval = 0;
+    due = TIMEBASE_now() + CALIB_next_second(&second_residue);
+    SCHED_post_at(SCHED_TASK_COUNTDOWN, due);
+    LED_set_pattern(LED_PATTERN_COUNTDOWN);
+    SYNC_countdown_run(BCD_to_seconds(countdown), due, second_residue);
 }
 
 
@@ -179,18 +419,25 @@ void app_state_countdown_init(void)
  * app_state_countdown_init
  *
  * Initialize STATE_TIMER_FINISH. Stops the countdown timer, displays
- * the alarm text, and sets appropriate button callback. Turns LED on.
+ * the alarm text, and sets appropriate button callback. Strobes the LED
+ * and sounds the alarm.
  *
  * @param None
  * @returns None
  */
 void app_state_timer_finish_init(void)
 {
+    uart2_stream_t prev;
+
     app_state = STATE_TIMER_FINISH;
-    timer_stop(TIMER1);
+    SCHED_cancel(SCHED_TASK_COUNTDOWN);
+    prev = UART2_select(UART2_STREAM_ALARM);
     Disp2String(" -- ALARM");
+    UART2_select(prev);
+    LCD_show_text("ALARM");
     IO_set_button_callback(&app_timer_finish_button_press);
-    LED_on();
+    LED_set_pattern(LED_PATTERN_ALARM);
+    ALARM_start(APP_ALARM_PATTERN);
 }
 
 
@@ -209,36 +456,60 @@ void app_enter_time_button_press(button_t buttons)
         // Button 1 increment minutes
         case BUTTON1:
         {
-            countdown_s += 60;
-            // If the countdown timer goes above 59 minutes reset
-            // minutes to 0.
-            if ((countdown_s / 60) > 59)
-            {
-                countdown_s %= 60;
-            }
+            // Past 59 minutes the minutes go back to 0.
+            countdown = BCD_inc_minute(countdown);
             app_display_time();
             break;
         }
         // Button 2 increment seconds
         case BUTTON2:
         {
-            countdown_s ++;
+            countdown = BCD_inc_second(countdown);
             app_display_time();
             break;
         }
+        // Buttons 1 and 2 together recall the next preset. A long button 1
+        // would count the minutes up as it is held.
+        case BUTTON1_2:
+        {
+            uart2_stream_t prev;
+
+            preset = (preset + 1) % EEPROM_NUM_PRESETS;
+            countdown = BCD_from_seconds(EEPROM_get_preset(preset));
+            app_clear_term_line();
+            app_display_time();
+            prev = UART2_select(UART2_STREAM_DISPLAY);
+            Disp2String((char *)preset_names[preset]);
+            UART2_select(prev);
+            LCD_show_text(preset_names[preset] + 1);
+            break;
+        }
         // Short button 3 start countdown
         case BUTTON3:
         {
-            if(countdown_s != 0)
+            if(countdown != 0)
             {
+                uint16_t seconds = BCD_to_seconds(countdown);
+
+                // Remember the time, and update the recalled preset if
+                // it was adjusted. The write finishes in the background,
+                // started after the start is sent to any followers.
+                EEPROM_set_last(seconds);
+                if(preset != APP_NO_PRESET)
+                {
+                    EEPROM_set_preset(preset, seconds);
+                }
                 app_state_countdown_init();
+                EEPROM_commit();
             }
             break;
         }
         // Long button reset countdown
         case BUTTON3_LONG:
         {
-            countdown_s = 0;
+            countdown = 0;
+            preset = APP_NO_PRESET;
+            app_display_time();
             break;
         }
         default:
@@ -261,20 +532,24 @@ void app_countdown_button_press(button_t buttons)
         case BUTTON3:
         {
             // If PB3 is pressed, pause the timer until PB3 is pressed
-            // again
-            if(timer_flags.timer1_flag)
+            // again. The second restarts in full on resume.
+            if(SCHED_is_pending(SCHED_TASK_COUNTDOWN))
             {
-                timer_stop(TIMER1);
+                SCHED_cancel(SCHED_TASK_COUNTDOWN);
+                LED_set_pattern(LED_PATTERN_PAUSED);
+                SYNC_countdown_hold(BCD_to_seconds(countdown));
             }
             else
             {
-                timer_start(TIMER1, 1000);
+                app_countdown_resume();
             }
             break;
         }
         case BUTTON3_LONG:
         {
-            countdown_s = 0;
+            SCHED_cancel(SCHED_TASK_COUNTDOWN);
+            SYNC_countdown_cancel();
+            countdown = 0;
             APP_state_enter_time_init();
             break;
         }
@@ -293,58 +568,94 @@ void app_countdown_button_press(button_t buttons)
  */
 void app_timer_finish_button_press(button_t buttons)
 {
+    ALARM_stop();
     APP_state_enter_time_init();
 }
 
 
+/*
+ * app_on_interval
+ *
+ * Count a second of the countdown towards the next display on the
+ * terminal, due when the countdown is a whole number of the battery
+ * level's display intervals. A down-counter reloaded with the interval
+ * keeps the tick free of division; only a start of the countdown or a
+ * change of level lines it up again, from the countdown's seconds. The
+ * intervals divide a minute, so the minutes need not be looked at.
+ *
+ * @param none
+ * @returns 1 if the countdown is to be shown on the terminal
+ */
+uint8_t app_on_interval(void)
+{
+    uint8_t interval = BATTERY_display_interval();
+
+    if (interval != display_interval)
+    {
+        display_interval = interval;
+        display_wait = BCD_to_seconds(countdown & 0xFF) % interval;
+    }
+    else
+    {
+        display_wait--;
+    }
+    if (display_wait == 0)
+    {
+        display_wait = interval;
+        return 1;
+    }
+    return 0;
+}
+
+
 /*
  * app_display_time
  *
  * Display the current time remaining in the countdown to the UART
- * terminal
+ * terminal, and on the 7-segment display or the LCD if there is one
  *
  * @param none
  * @returns none
  */
 void app_display_time()
 {
-    // Convert the current countdown value to minutes and seconds
-    uint8_t minutes = countdown_s / 60;
-    uint8_t seconds = countdown_s % 60;
-
-    // Create a string with the countdown value displayed as specified
-    // in the project document
-    char time_display[10];
-    Disp2String("\r");
-    snprintf(time_display, 10, "%02dm:%02ds", minutes, seconds);
-    debug_hex(countdown_s);
-
-    // Use UART interface to display the time
-    Disp2String(time_display);
+    // The countdown as specified in the project document, "MMm:SSs", at
+    // the start of the line
+    char time_display[1 + BCD_RENDER_SIZE];
+    uart2_stream_t prev = UART2_select(UART2_STREAM_DISPLAY);
+    PROFILE_ENTER();
+
+    time_display[0] = '\r';
+    BCD_render(countdown, &time_display[1]);
+    debug_hex(countdown);
+    DISPLAY_show_time(countdown);
+    LCD_show_time(countdown);
+
+    // Use UART interface to display the time. A redraw still waiting to
+    // go out is replaced.
+    UART2_refresh(time_display);
+    UART2_select(prev);
+    PROFILE_EXIT(PROFILE_APP_DISPLAY_TIME);
 }
 
 
 /*
  * app_clear_term_line
  *
- * Clear a line on the UART console. Assumes a standard 80 character
- * terminal width.
+ * Clear a line on the UART console, and the note on the LCD. Assumes a
+ * standard 80 character terminal width.
  *
  * @param none
  * @returns none
  */
 void app_clear_term_line()
 {
-    // Create an 80 character string of spaces to use to clear the line.
-    char tmp[80] = {0};
-    int i;
-    for(i = 0; i < 79; i++)
-    {
-        tmp[i] = ' ';
-    }
+    uart2_stream_t prev = UART2_select(UART2_STREAM_DISPLAY);
 
-    // Use the UART interface to write the line and move the cursor.
+    // Overwrite the line with spaces and move the cursor back.
     Disp2String("\r");
-    Disp2String(tmp);
+    XmitUART2(' ', 79);
     Disp2String("\r");
+    UART2_select(prev);
+    LCD_show_text("");
 }
@@ -11,20 +11,77 @@
 #define	APP_H
 
 #include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
 
 #ifdef	__cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
     /**
-     * \b app_state_machine_main \b
+     * \b APP_init \b
      *
-     * Fuction that runs every loop of main in the state machine. Responsible for
+     * Enter time entry with the last used countdown from EEPROM. Call
+     * once at boot; produces no output.
      */
-    void APP_state_machine_main(void);
+    void APP_init(void);
+
+    /**
+     * \b APP_display_boot \b
+     *
+     * Show the countdown for the first time after APP_init.
+     */
+    void APP_display_boot(void);
+
+    /**
+     * \b APP_display_status \b
+     *
+     * Print the state, the countdown and the presets on one line.
+     */
+    void APP_display_status(void);
+
+    /**
+     * \b APP_clear_line, APP_redisplay \b
+     *
+     * Clear the terminal line, and show the countdown at its start, for
+     * output that took the line over.
+     */
+    void APP_clear_line(void);
+    void APP_redisplay(void);
 
     void APP_state_enter_time_init(void);
 
+    /**
+     * \b APP_set_time \b
+     *
+     * Set the countdown during time entry, from the pot.
+     */
+    void APP_set_time(uint16_t seconds);
+
+    /**
+     * \b APP_handle_hold_event \b
+     *
+     * Hold task: auto-repeat of a held button during time entry.
+     */
+    void APP_handle_hold_event(void);
+
+    /**
+     * \b APP_handle_countdown_event \b
+     *
+     * Countdown task: one second of the countdown.
+     */
+    void APP_handle_countdown_event(void);
+
+    /**
+     * \b APP_sync_run, APP_sync_hold, APP_sync_cancel \b
+     *
+     * Run, pause or cancel the countdown as the sync leader did.
+     */
+    void APP_sync_run(uint16_t seconds);
+
+    void APP_sync_hold(uint16_t seconds);
+
+    void APP_sync_cancel(void);
+
 #ifdef	__cplusplus
 }
 #endif /* __cplusplus */
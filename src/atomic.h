@@ -0,0 +1,99 @@
+/*
+ * File: atomic.h
+ * Author: Andy Smit
+ * Comments: Flag and critical section primitives for state shared
+ *           between ISRs and main.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef ATOMIC_H
+#define	ATOMIC_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+/*
+ * Flag words
+ *
+ * Flags shared with ISRs live in 16 bit words so they can be changed with
+ * a single BSET/BCLR on the word. A C bitfield assignment compiles to a
+ * read-modify-write of the whole byte, and an ISR that sets another flag
+ * in the middle of it has its flag silently cleared.
+ *
+ * word must be a 16 bit lvalue (use the .all member of a flag union) and
+ * bit a constant from 0 to 15.
+ */
+#ifdef __XC16__
+#define ATOMIC_SET_BIT(word, bit) \
+    __asm__ volatile ("bset [%0], #%1" : : "r"(&(word)), "i"(bit) : "memory")
+
+#define ATOMIC_CLEAR_BIT(word, bit) \
+    __asm__ volatile ("bclr [%0], #%1" : : "r"(&(word)), "i"(bit) : "memory")
+
+// Evaluates to 1 and clears the bit if it was set, otherwise 0. The bit
+// is only cleared on the path where BTSS saw it set, so a flag raised by
+// an ISR after the test is never lost.
+#define ATOMIC_TEST_AND_CLEAR_BIT(word, bit) \
+({ \
+    uint16_t was_set_; \
+    __asm__ volatile ("clr %0\n\t" \
+                      "btss [%1], #%2\n\t" \
+                      "bra 1f\n\t" \
+                      "bclr [%1], #%2\n\t" \
+                      "mov #1, %0\n" \
+                      "1:" \
+                      : "=&r"(was_set_) : "r"(&(word)), "i"(bit) : "memory"); \
+    was_set_; \
+})
+#else
+// Host simulator builds.
+#define ATOMIC_SET_BIT(word, bit) \
+    ((void)__atomic_fetch_or(&(word), 1u << (bit), __ATOMIC_SEQ_CST))
+
+#define ATOMIC_CLEAR_BIT(word, bit) \
+    ((void)__atomic_fetch_and(&(word), ~(1u << (bit)), __ATOMIC_SEQ_CST))
+
+#define ATOMIC_TEST_AND_CLEAR_BIT(word, bit) \
+    ((__atomic_fetch_and(&(word), ~(1u << (bit)), __ATOMIC_SEQ_CST) \
+      >> (bit)) & 1u)
+#endif
+
+/*
+ * Critical sections
+ *
+ * CRITICAL_ENTER raises the CPU priority to ipl, masking only interrupts
+ * at or below that level; higher priority ISRs keep their latency. Pick
+ * the priority of the highest ISR that touches the shared state. It only
+ * ever raises it: entered at or above ipl, as in a higher priority ISR,
+ * it leaves the priority as it is. The previous level is kept in saved
+ * (a uint16_t) for CRITICAL_EXIT.
+ *
+ * DISI_ENTER masks priorities 1 to 6 for a fixed number of instruction
+ * cycles and is meant for sequences of a few instructions, such as the
+ * unlock sequences. DISI_EXIT ends it early.
+ */
+#ifdef __XC16__
+#define CRITICAL_CPU_IPL() (SRbits.IPL)
+#else
+#define CRITICAL_CPU_IPL() (sim_cpu_ipl)
+#endif
+
+#define CRITICAL_ENTER(saved, ipl) \
+    do \
+    { \
+        (saved) = CRITICAL_CPU_IPL(); \
+        if ((ipl) > (saved)) \
+        { \
+            SET_CPU_IPL(ipl); \
+        } \
+    } while (0)
+
+#define CRITICAL_EXIT(saved) RESTORE_CPU_IPL(saved)
+
+#define DISI_ENTER(cycles) __builtin_disi(cycles)
+
+#define DISI_EXIT() __builtin_disi(0)
+
+#endif	/* ATOMIC_H */
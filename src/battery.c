@@ -0,0 +1,387 @@
+/*
+ * File:   battery.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Battery monitor and power policy. The supply is measured by converting
+ * the band gap reference with the ADC referenced to VDD: the lower the
+ * supply, the higher the code. A measurement runs every
+ * BATTERY_PERIOD_MS, and as soon as the HLVD interrupt says the supply
+ * has fallen past the next level. The ADC is powered only for the few
+ * milliseconds of a measurement, and a measurement that finds it in use
+ * by the pot (see pot.c) waits for it. The HLVD, which costs a few uA, is
+ * powered only while there is a lower level to warn of.
+ *
+ * Each level below BATTERY_OK sheds load for runtime (battery_policies):
+ *
+ *  - The LED patterns go off. At 3mA lit, the flash of a countdown is
+ *    the largest load the unit has after the piezo.
+ *  - The 7-segment display, where there is one, dims and then goes off.
+ *    Its segments draw a few mA each while lit, and dozed its refresh
+ *    interrupts take several times the CPU (see display.c).
+ *  - The countdown is shown every few seconds instead of every second,
+ *    as the CPU runs for the whole of each line it sends. The last
+ *    seconds are always shown (see app.c).
+ *  - The CPU dozes. Doze slows only the CPU: the timers, the UART and
+ *    the output compare keep their clock, so the time, the baud rate and
+ *    the pitch of the alarm are unchanged while the CPU draws less. ROI
+ *    is clear, so ISRs run dozed too and their latencies in main.h grow
+ *    by the doze ratio.
+ *
+ * A change of level is reported on the console, and the last measurement
+ * is in the status dump. The levels have BATTERY_HYSTERESIS_MV of
+ * hysteresis, so the supply recovering as load is shed cannot make them
+ * flap.
+ */
+
+#include <xc.h>
+#include <stdio.h>
+#include "main.h"
+#include "battery.h"
+#include "sched.h"
+#include "timebase.h"
+#include "power.h"
+#include "led.h"
+#include "display.h"
+#include "UART2.h"
+#include "profile.h"
+
+// Band gap reference, nominal. Parts vary by a few percent, which moves
+// every threshold by as much.
+#define BATTERY_VBG_MV 1200UL
+
+// AD1CHS CH0SA for the band gap reference
+#define BATTERY_CH_VBG 0b1111
+
+// Full scale of the 10 bit ADC
+#define BATTERY_ADC_SCALE 1024UL
+
+// DOZE ratios
+#define BATTERY_DOZE_4 0b010
+#define BATTERY_DOZE_8 0b011
+
+typedef struct
+{
+    uint8_t led;
+    // Brightness of the 7-segment display
+    uint8_t display;
+    // DOZE ratio, or 0 to run the CPU at Fcy
+    uint8_t doze;
+    // Seconds between displays of the countdown, a divisor of 60
+    uint8_t display_s;
+    const char *name;
+} battery_policy_t;
+
+static const battery_policy_t battery_policies[BATTERY_NUM_LEVELS] = {
+    [BATTERY_OK] = {1, DISPLAY_BRIGHTNESS, 0, 1, "ok"},
+    [BATTERY_LOW] = {0, 2, BATTERY_DOZE_4, 10, "low"},
+    [BATTERY_CRITICAL] = {0, 0, BATTERY_DOZE_8, 60, "critical"},
+};
+
+// Supply below which each level is left for the next one down.
+static const uint16_t battery_thresholds[BATTERY_NUM_LEVELS - 1] = {
+    BATTERY_LOW_MV, BATTERY_CRITICAL_MV
+};
+
+// HLVDL for a trip point near the threshold below each level: about 2.7V
+// and 2.4V, from the typical figures of the datasheet's HLVD table.
+static const uint8_t battery_hlvdl[BATTERY_NUM_LEVELS - 1] = {0b1000, 0b0101};
+
+static battery_level_t battery_level = BATTERY_OK;
+static uint16_t battery_mv = 0;
+static uint8_t battery_hlvd_on = 0;
+// Set by the HLVD ISR.
+static volatile uint8_t battery_tripped = 0;
+// A measurement is waiting for the ADC to settle.
+static uint8_t battery_measuring = 0;
+// Set the HLVD again once the measurement is done.
+static uint8_t battery_rearm = 0;
+static uint32_t battery_settled;
+static uint32_t battery_next;
+
+
+/*
+ * BATTERY_init
+ *
+ * Measure the battery now, and every BATTERY_PERIOD_MS from then on.
+ *
+ * @param None
+ * @return None
+ */
+void BATTERY_init(void)
+{
+    IPC18bits.HLVDIP = IPL_HLVD;
+    SCHED_post(SCHED_TASK_BATTERY);
+}
+
+
+/*
+ * battery_hlvd_arm
+ *
+ * Set the HLVD to interrupt once the supply falls below the next level,
+ * or power it down at the lowest level. A reference that is still
+ * settling can trip it at once, which costs one early measurement.
+ */
+static void battery_hlvd_arm(void)
+{
+    IEC4bits.HLVDIE = 0;
+    if (battery_level == BATTERY_CRITICAL)
+    {
+        if (battery_hlvd_on)
+        {
+            HLVDCON = 0;
+            POWER_release(POWER_HLVD);
+            battery_hlvd_on = 0;
+        }
+        return;
+    }
+    if (!battery_hlvd_on)
+    {
+        POWER_acquire(POWER_HLVD);
+        battery_hlvd_on = 1;
+    }
+    HLVDCON = 0; // Falling VDD, stop in idle off
+    HLVDCONbits.HLVDL = battery_hlvdl[battery_level];
+    HLVDCONbits.HLVDEN = 1;
+    IFS4bits.HLVDIF = 0;
+    IEC4bits.HLVDIE = 1;
+}
+
+
+/*
+ * battery_adc_start
+ *
+ * Power up the ADC on the band gap reference, to convert once it has
+ * settled.
+ *
+ * @return 1 if started, 0 if the ADC is in use
+ */
+static uint8_t battery_adc_start(void)
+{
+    if (!POWER_acquire(POWER_ADC1))
+    {
+        POWER_release(POWER_ADC1);
+        return 0;
+    }
+    AD1CON1 = 0;                // Integer result
+    AD1CON1bits.SSRC = 0b111;   // Convert when sampling ends
+    AD1CON2 = 0;                // AVDD and AVSS references
+    AD1CON3 = 0;
+    AD1CON3bits.ADRC = 1;       // ADC RC clock, at any Fcy
+    AD1CON3bits.SAMC = 31;      // Longest sample, for the reference
+    AD1CHS = 0;
+    AD1CHSbits.CH0SA = BATTERY_CH_VBG;
+    AD1CON1bits.ADON = 1;
+    return 1;
+}
+
+
+/*
+ * battery_adc_read
+ *
+ * Convert the band gap and power the ADC down again. The sample and
+ * conversion take 43 ADC clocks, a few tens of microseconds, so this
+ * waits for them.
+ *
+ * @return The supply in mV
+ */
+static uint16_t battery_adc_read(void)
+{
+    uint16_t code;
+
+    AD1CON1bits.SAMP = 1;
+    while (!AD1CON1bits.DONE)
+    {
+    }
+    code = ADC1BUF0;
+    AD1CON1bits.ADON = 0;
+    POWER_release(POWER_ADC1);
+    if (code == 0)
+    {
+        return 0xFFFF;
+    }
+    return BATTERY_VBG_MV * BATTERY_ADC_SCALE / code;
+}
+
+
+/*
+ * battery_level_for
+ *
+ * The level for a measurement: down as soon as the supply is below a
+ * threshold, up only once it is clear of it.
+ */
+static battery_level_t battery_level_for(uint16_t mv)
+{
+    battery_level_t level = battery_level;
+
+    while (level < BATTERY_CRITICAL && mv < battery_thresholds[level])
+    {
+        level++;
+    }
+    while (level > BATTERY_OK
+           && mv >= battery_thresholds[level - 1] + BATTERY_HYSTERESIS_MV)
+    {
+        level--;
+    }
+    return level;
+}
+
+
+/*
+ * battery_apply
+ *
+ * Shed or restore load for the current level.
+ */
+static void battery_apply(void)
+{
+#if BATTERY_POLICY
+    const battery_policy_t *policy = &battery_policies[battery_level];
+
+    LED_enable(policy->led);
+    DISPLAY_set_brightness(policy->display);
+    CLKDIVbits.DOZEN = 0;
+    if (policy->doze)
+    {
+        CLKDIVbits.DOZE = policy->doze;
+        CLKDIVbits.DOZEN = 1;
+    }
+#endif
+}
+
+
+/*
+ * BATTERY_handle_event
+ *
+ * Measure the supply and apply the policy for its level. Runs as the
+ * battery task, posted by BATTERY_init, the HLVD ISR and itself: once to
+ * power up the ADC, and again once it has settled to convert.
+ *
+ * @param None
+ * @return None
+ */
+void BATTERY_handle_event(void)
+{
+    battery_level_t level;
+    char s[40];
+
+    if (!battery_measuring)
+    {
+        if (!battery_adc_start())
+        {
+            SCHED_post_at(SCHED_TASK_BATTERY,
+                          TIMEBASE_deadline(BATTERY_SETTLE_MS));
+            return;
+        }
+        // A trip of the HLVD brings the measurement forward but leaves
+        // the period alone. The HLVD is set again by the next periodic
+        // measurement, so a supply sitting at the trip point costs at
+        // most one extra measurement a period.
+        IEC4bits.HLVDIE = 0;
+        battery_rearm = !battery_tripped;
+        battery_tripped = 0;
+        if (battery_rearm)
+        {
+            battery_next = SCHED_release_time(SCHED_TASK_BATTERY)
+                           + TIMEBASE_MS_TO_TICKS(BATTERY_PERIOD_MS);
+        }
+        battery_measuring = 1;
+        battery_settled = TIMEBASE_deadline(BATTERY_SETTLE_MS);
+        SCHED_post_at(SCHED_TASK_BATTERY, battery_settled);
+        return;
+    }
+    if (!TIMEBASE_reached(battery_settled))
+    {
+        // Posted again by the HLVD while settling
+        SCHED_post_at(SCHED_TASK_BATTERY, battery_settled);
+        return;
+    }
+
+    battery_measuring = 0;
+    battery_mv = battery_adc_read();
+    level = battery_level_for(battery_mv);
+    if (level != battery_level)
+    {
+        battery_level = level;
+        battery_apply();
+        snprintf(s, sizeof(s), "\r\nbattery %s %u mV\r\n",
+                 battery_policies[level].name, battery_mv);
+        Disp2String(s);
+    }
+    if (battery_rearm)
+    {
+        battery_hlvd_arm();
+    }
+    SCHED_post_at(SCHED_TASK_BATTERY, battery_next);
+}
+
+
+/*
+ * BATTERY_get_level
+ *
+ * @param None
+ * @return The level of the last measurement
+ */
+battery_level_t BATTERY_get_level(void)
+{
+    return battery_level;
+}
+
+
+/*
+ * BATTERY_get_mv
+ *
+ * @param None
+ * @return The supply at the last measurement in mV, 0 before the first
+ */
+uint16_t BATTERY_get_mv(void)
+{
+    return battery_mv;
+}
+
+
+/*
+ * BATTERY_display_interval
+ *
+ * @param None
+ * @return Seconds between displays of the countdown at the current level
+ */
+uint8_t BATTERY_display_interval(void)
+{
+#if BATTERY_POLICY
+    return battery_policies[battery_level].display_s;
+#else
+    return 1;
+#endif
+}
+
+
+/*
+ * BATTERY_display_status
+ *
+ * Print the last measurement and its level on their own line.
+ *
+ * @param None
+ * @return None
+ */
+void BATTERY_display_status(void)
+{
+    char s[32];
+
+    snprintf(s, sizeof(s), "battery %u mV %s\r\n", battery_mv,
+             battery_policies[battery_level].name);
+    Disp2String(s);
+}
+
+
+// The supply has fallen below the HLVD trip point.
+void ISR _HLVDInterrupt(void)
+{
+    PROFILE_ISR_ENTER();
+
+    IFS4bits.HLVDIF = 0;
+    IEC4bits.HLVDIE = 0;
+    battery_tripped = 1;
+    SCHED_post(SCHED_TASK_BATTERY);
+    PROFILE_ISR_EXIT(PROFILE_ISR_HLVD);
+}
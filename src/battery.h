@@ -0,0 +1,64 @@
+/*
+ * File: battery.h
+ * Author: Andy Smit
+ * Comments: Battery monitor on the HLVD and the ADC, and the power policy
+ *           that sheds load as the battery drains.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef BATTERY_H
+#define	BATTERY_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// Time between measurements of the supply. The HLVD interrupt brings the
+// next one forward when the supply falls past the next level.
+#define BATTERY_PERIOD_MS 60000UL
+
+// Time the ADC and band gap are given to settle before a conversion.
+#define BATTERY_SETTLE_MS 2
+
+// The supply below which each level is entered. A level is left upwards
+// once the supply is BATTERY_HYSTERESIS_MV above its threshold.
+#define BATTERY_LOW_MV 2700
+#define BATTERY_CRITICAL_MV 2400
+#define BATTERY_HYSTERESIS_MV 100
+
+// Set to 0 to measure and report the battery without shedding any load,
+// for comparing the runtime per charge with and without the policy.
+#ifndef BATTERY_POLICY
+#define BATTERY_POLICY 1
+#endif
+
+typedef enum
+{
+    BATTERY_OK = 0,
+    BATTERY_LOW,
+    BATTERY_CRITICAL,
+    BATTERY_NUM_LEVELS
+} battery_level_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void BATTERY_init(void);
+
+void BATTERY_handle_event(void);
+
+battery_level_t BATTERY_get_level(void);
+
+uint16_t BATTERY_get_mv(void);
+
+uint8_t BATTERY_display_interval(void);
+
+void BATTERY_display_status(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* BATTERY_H */
@@ -0,0 +1,177 @@
+/*
+ * File:   bcd.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * The countdown is kept as packed BCD minutes and seconds (see bcd.h),
+ * so a second of the countdown, a press of the buttons during time entry
+ * and every redraw are nibble tests, adds and copies. A binary count of
+ * seconds took a divide by 60 and a modulo for each redraw, and the
+ * 7-segment display and the LCD two more each; the PIC24 divides in 18
+ * cycles plus the call into the runtime library around it, which at -O0
+ * is most of the cost of a tick.
+ *
+ * Seconds are still what the EEPROM keeps, the pot sets and sync messages
+ * carry, so those formats are unchanged; BCD_from_seconds and
+ * BCD_to_seconds convert at those edges only.
+ */
+
+#include <xc.h>
+#include "bcd.h"
+
+
+/*
+ * bcd_inc_digits
+ *
+ * Two BCD digits plus one, 0x59 at most in.
+ */
+static uint8_t bcd_inc_digits(uint8_t digits)
+{
+    if ((digits & 0x0F) == 9)
+    {
+        return (digits & 0xF0) + 0x10;
+    }
+    return digits + 1;
+}
+
+
+/*
+ * bcd_dec_digits
+ *
+ * Two BCD digits less one, 0x01 at least in.
+ */
+static uint8_t bcd_dec_digits(uint8_t digits)
+{
+    if ((digits & 0x0F) == 0)
+    {
+        // Borrow from the tens: 0x40 less one is 0x39
+        return digits - 0x10 + 9;
+    }
+    return digits - 1;
+}
+
+
+/*
+ * BCD_from_seconds
+ *
+ * A time in seconds as BCD. Divides, so is only for times coming in as
+ * seconds.
+ *
+ * @param seconds The time in seconds; over 59:59 gives 59:59
+ * @return The time
+ */
+bcd_time_t BCD_from_seconds(uint16_t seconds)
+{
+    uint8_t minutes;
+
+    if (seconds >= 60 * 60)
+    {
+        return BCD_TIME_MAX;
+    }
+    minutes = seconds / 60;
+    seconds %= 60;
+    return BCD_TIME((minutes / 10) << 4 | minutes % 10,
+                    (seconds / 10) << 4 | seconds % 10);
+}
+
+
+/*
+ * BCD_to_seconds
+ *
+ * @param time The time
+ * @return The time in seconds
+ */
+uint16_t BCD_to_seconds(bcd_time_t time)
+{
+    uint16_t minutes = (time >> 12) * 10 + (time >> 8 & 0x0F);
+    uint16_t seconds = (time >> 4 & 0x0F) * 10 + (time & 0x0F);
+    return minutes * 60 + seconds;
+}
+
+
+/*
+ * BCD_dec_second
+ *
+ * One second less. 00:00 wraps to 59:59.
+ *
+ * @param time The time
+ * @return The time a second earlier
+ */
+bcd_time_t BCD_dec_second(bcd_time_t time)
+{
+    uint8_t minutes = time >> 8;
+    uint8_t seconds = time & 0xFF;
+
+    if (seconds != 0)
+    {
+        return BCD_TIME(minutes, bcd_dec_digits(seconds));
+    }
+    if (minutes != 0)
+    {
+        return BCD_TIME(bcd_dec_digits(minutes), 0x59);
+    }
+    return BCD_TIME_MAX;
+}
+
+
+/*
+ * BCD_inc_second
+ *
+ * One second more, carried into the minutes. 59:59 wraps to 00:00.
+ *
+ * @param time The time
+ * @return The time a second later
+ */
+bcd_time_t BCD_inc_second(bcd_time_t time)
+{
+    uint8_t seconds = time & 0xFF;
+
+    if (seconds != 0x59)
+    {
+        return BCD_TIME(time >> 8, bcd_inc_digits(seconds));
+    }
+    return BCD_inc_minute(time) & 0xFF00;
+}
+
+
+/*
+ * BCD_inc_minute
+ *
+ * One minute more, the seconds unchanged. 59 minutes wraps to 0.
+ *
+ * @param time The time
+ * @return The time a minute later
+ */
+bcd_time_t BCD_inc_minute(bcd_time_t time)
+{
+    uint8_t minutes = time >> 8;
+
+    if (minutes == 0x59)
+    {
+        return time & 0x00FF;
+    }
+    return BCD_TIME(bcd_inc_digits(minutes), time & 0xFF);
+}
+
+
+/*
+ * BCD_render
+ *
+ * Write a time as the terminal shows it, "MMm:SSs", a digit per nibble.
+ *
+ * @param time The time
+ * @param s BCD_RENDER_SIZE characters
+ * @return None
+ */
+void BCD_render(bcd_time_t time, char *s)
+{
+    s[0] = '0' + (time >> 12);
+    s[1] = '0' + (time >> 8 & 0x0F);
+    s[2] = 'm';
+    s[3] = ':';
+    s[4] = '0' + (time >> 4 & 0x0F);
+    s[5] = '0' + (time & 0x0F);
+    s[6] = 's';
+    s[7] = '\0';
+}
@@ -0,0 +1,51 @@
+/*
+ * File: bcd.h
+ * Author: Andy Smit
+ * Comments: Countdown time as packed BCD minutes and seconds, counted
+ *           and shown without dividing.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef BCD_H
+#define	BCD_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// A time of 00:00 to 59:59 as 0xMMSS, each digit a nibble: 12:34 is
+// 0x1234. Times compare as the numbers they are, so < and == work on
+// them directly.
+typedef uint16_t bcd_time_t;
+
+#define BCD_TIME(minutes_bcd, seconds_bcd) \
+    ((bcd_time_t)(((minutes_bcd) << 8) | (seconds_bcd)))
+
+// Characters BCD_render writes: "MMm:SSs" and its terminator
+#define BCD_RENDER_SIZE 8
+
+// The longest time
+#define BCD_TIME_MAX BCD_TIME(0x59, 0x59)
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+bcd_time_t BCD_from_seconds(uint16_t seconds);
+
+uint16_t BCD_to_seconds(bcd_time_t time);
+
+bcd_time_t BCD_dec_second(bcd_time_t time);
+
+bcd_time_t BCD_inc_second(bcd_time_t time);
+
+bcd_time_t BCD_inc_minute(bcd_time_t time);
+
+void BCD_render(bcd_time_t time, char *s);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* BCD_H */
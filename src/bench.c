@@ -0,0 +1,323 @@
+/*
+ * File:   bench.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Cycle benchmarks of firmware kernels, built in with PROFILE, whose
+ * Timer 3 cycle count (see profile.c) times them. The suite is fixed, so
+ * tables from different units, clocks and builds line up. Each kernel is
+ * called its number of runs back to back, and the cycles per call are
+ * printed less those of as many calls of an empty kernel, so the loop and
+ * the call are not counted.
+ *
+ * The kernels:
+ *
+ *  - tick and redraw, in pairs: the countdown as it is kept now, in BCD
+ *    (see bcd.c), and as it was, a binary count of seconds split with a
+ *    divide and a modulo by 60. "tick" is a second of the countdown with
+ *    the split every display of it needed, "redraw" the text of a redraw
+ *    of the terminal line.
+ *  - Disp2String and Disp2Dec of a redraw's worth of text, into an empty
+ *    transmit queue, few enough times not to fill it.
+ *  - SCHED_post_at, which arms every timed event now that the timers are
+ *    gone, on a task of its own that does nothing, a minute out so it
+ *    stays armed for the whole suite.
+ *  - dispatch, a button event through IO_dispatch to the callback of
+ *    time entry, which ignores it.
+ *
+ * The profiled functions among them (see profile.h) include the
+ * profiler's hooks, a few dozen cycles a call.
+ *
+ * The suite runs as the bench task, a kernel a run, and the task waits
+ * for the console output to be sent before each kernel. No run is much
+ * longer than a task's deadline, and only the kernel's own output, the
+ * timebase and the buttons interrupt it. What Disp2String and Disp2Dec
+ * write takes over the terminal line, so the last kernel's run clears the
+ * line. The table is then printed there a line a run, each once the one
+ * before it has been sent, so no run waits for room in the transmit
+ * queue, and the countdown is shown again after it. The suite is started
+ * with "K" on the console, and with BENCH_BOOT at the end of boot, and is
+ * only run in time entry: the dispatch would end an alarm. A countdown
+ * started while it runs stops it.
+ *
+ * The host simulator runs the same suite. As code takes no time there,
+ * its table has only the time the kernels spend waiting on the hardware,
+ * and its first line ends in "host" so it is not read as a measurement
+ * of the code. What a kernel takes on a unit over what it takes in the
+ * simulator is what the simulator's timing leaves out.
+ */
+
+#include <xc.h>
+#include <stdio.h>
+#include "main.h"
+#include "bench.h"
+#include "app.h"
+#include "profile.h"
+#include "clock.h"
+#include "bcd.h"
+#include "io.h"
+#include "sched.h"
+#include "timebase.h"
+#include "UART2.h"
+
+#if BENCH_BOOT && !PROFILE
+#error "The benchmarks are timed with the profiler: BENCH_BOOT needs PROFILE"
+#endif
+
+#if PROFILE
+// Marks the table from the simulator, which times no code
+#ifdef __XC16__
+#define BENCH_TARGET ""
+#else
+#define BENCH_TARGET " host"
+#endif
+
+// bench_next when the suite is not running. After the last kernel it is
+// BENCH_NUM_KERNELS plus the line of the table to print next.
+#define BENCH_IDLE 0xFF
+
+typedef struct
+{
+    const char *name;
+    void (*kernel)(void);
+    uint8_t runs;
+} bench_t;
+
+// The next kernel to time, and the cycles per call of those timed
+static uint8_t bench_next = BENCH_IDLE;
+static uint32_t bench_cycles[BENCH_NUM_KERNELS];
+
+// Kernel state. Volatile so the compiler keeps every result.
+static volatile uint16_t bench_seconds;
+static volatile bcd_time_t bench_time;
+static volatile uint8_t bench_sink;
+static char bench_text[16];
+static uint32_t bench_due;
+
+
+static void bench_empty(void)
+{
+}
+
+
+static void bench_tick_seconds(void)
+{
+    bench_seconds--;
+    bench_sink = bench_seconds / 60;
+    bench_sink = bench_seconds % 60;
+}
+
+
+static void bench_tick_bcd(void)
+{
+    bench_time = BCD_dec_second(bench_time);
+}
+
+
+static void bench_redraw_seconds(void)
+{
+    snprintf(bench_text, sizeof(bench_text), "\r%02dm:%02ds",
+             bench_seconds / 60, bench_seconds % 60);
+}
+
+
+static void bench_redraw_bcd(void)
+{
+    bench_text[0] = '\r';
+    BCD_render(bench_time, &bench_text[1]);
+}
+
+
+static void bench_disp2string(void)
+{
+    Disp2String("\r59m:59s");
+}
+
+
+static void bench_disp2dec(void)
+{
+    Disp2Dec(bench_seconds);
+}
+
+
+static void bench_sched_post_at(void)
+{
+    SCHED_post_at(SCHED_TASK_BENCH_POST, bench_due);
+}
+
+
+static void bench_dispatch(void)
+{
+    IO_dispatch(NO_BUTTONS);
+}
+
+
+// The suite. Disp2String writes a frame of the transmit queue a call,
+// Disp2Dec seven, and the queue holds UART2_TX_FRAMES.
+static const bench_t bench_kernels[BENCH_NUM_KERNELS] = {
+    {"tick_seconds", bench_tick_seconds, BENCH_RUNS},
+    {"tick_bcd", bench_tick_bcd, BENCH_RUNS},
+    {"redraw_seconds", bench_redraw_seconds, BENCH_RUNS},
+    {"redraw_bcd", bench_redraw_bcd, BENCH_RUNS},
+    {"Disp2String", bench_disp2string, 8},
+    {"Disp2Dec", bench_disp2dec, 2},
+    {"SCHED_post_at", bench_sched_post_at, BENCH_RUNS},
+    {"dispatch", bench_dispatch, BENCH_RUNS},
+};
+
+
+/*
+ * bench_time_kernel
+ *
+ * Cycles of a number of calls of a kernel, from 59:59 down.
+ */
+static uint32_t bench_time_kernel(void (*kernel)(void), uint8_t runs)
+{
+    uint32_t start;
+    uint8_t i;
+
+    bench_seconds = 60 * 60 - 1;
+    bench_time = BCD_TIME_MAX;
+    start = PROFILE_now();
+    for (i = 0; i < runs; i++)
+    {
+        kernel();
+    }
+    return PROFILE_now() - start;
+}
+
+
+/*
+ * bench_report
+ *
+ * Print a line of the table: "bench <Fcy> <kernels>", with " host" in the
+ * simulator, then a line per kernel: its name, its runs and its cycles
+ * per call. The first starts a cleared line.
+ *
+ * @return 0 once past the last line, otherwise 1
+ */
+static uint8_t bench_report(uint8_t line)
+{
+    char s[40];
+
+    if (line == 0)
+    {
+        snprintf(s, sizeof(s), "bench %lu %u%s\r\n",
+                 (unsigned long)CLOCK_get_fcy(), (unsigned)BENCH_NUM_KERNELS,
+                 BENCH_TARGET);
+    }
+    else if (line <= BENCH_NUM_KERNELS)
+    {
+        snprintf(s, sizeof(s), "%s %u %lu\r\n", bench_kernels[line - 1].name,
+                 bench_kernels[line - 1].runs,
+                 (unsigned long)bench_cycles[line - 1]);
+    }
+    else
+    {
+        return 0;
+    }
+    Disp2String(s);
+    return 1;
+}
+#endif
+
+
+/*
+ * BENCH_start
+ *
+ * Start the suite, if the unit is in time entry and not already running
+ * it.
+ *
+ * @param None
+ * @return 1 if started, otherwise 0
+ */
+uint8_t BENCH_start(void)
+{
+#if PROFILE
+    if (app_state != STATE_ENTER_TIME || bench_next != BENCH_IDLE)
+    {
+        return 0;
+    }
+    bench_next = 0;
+    bench_due = TIMEBASE_deadline(60000);
+    SCHED_post(SCHED_TASK_BENCH);
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * BENCH_handle_event
+ *
+ * Time the next kernel of the suite once the console output has gone,
+ * then print the table a line at a time the same way. Runs as the bench
+ * task, posted by BENCH_start and itself.
+ *
+ * @param None
+ * @return None
+ */
+void BENCH_handle_event(void)
+{
+#if PROFILE
+    const bench_t *bench;
+    uint32_t empty;
+
+    if (bench_next == BENCH_IDLE)
+    {
+        return;
+    }
+    if (app_state != STATE_ENTER_TIME)
+    {
+        bench_next = BENCH_IDLE;
+        SCHED_cancel(SCHED_TASK_BENCH_POST);
+        return;
+    }
+    if (!UART2_is_idle())
+    {
+        SCHED_post_at(SCHED_TASK_BENCH, TIMEBASE_deadline(BENCH_POLL_MS));
+        return;
+    }
+    if (bench_next >= BENCH_NUM_KERNELS)
+    {
+        if (bench_report(bench_next - BENCH_NUM_KERNELS))
+        {
+            bench_next++;
+            SCHED_post_at(SCHED_TASK_BENCH, TIMEBASE_deadline(BENCH_POLL_MS));
+            return;
+        }
+        bench_next = BENCH_IDLE;
+        SCHED_cancel(SCHED_TASK_BENCH_POST);
+        APP_redisplay();
+        return;
+    }
+    bench = &bench_kernels[bench_next];
+    empty = bench_time_kernel(bench_empty, bench->runs);
+    bench_cycles[bench_next] = bench_time_kernel(bench->kernel, bench->runs);
+    bench_cycles[bench_next] = bench_cycles[bench_next] > empty
+                               ? (bench_cycles[bench_next] - empty)
+                                 / bench->runs
+                               : 0;
+    if (++bench_next == BENCH_NUM_KERNELS)
+    {
+        APP_clear_line();
+    }
+    SCHED_post(SCHED_TASK_BENCH);
+#endif
+}
+
+
+/*
+ * BENCH_handle_post_event
+ *
+ * The task the SCHED_post_at kernel arms. It is cancelled when the suite
+ * ends, and does nothing should it run.
+ *
+ * @param None
+ * @return None
+ */
+void BENCH_handle_post_event(void)
+{
+}
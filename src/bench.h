@@ -0,0 +1,49 @@
+/*
+ * File: bench.h
+ * Author: Andy Smit
+ * Comments: Cycle benchmarks of a fixed suite of firmware kernels, run
+ *           with "K" on the console in a PROFILE build, or at boot with
+ *           BENCH_BOOT.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef BENCH_H
+#define	BENCH_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// 1 to run the suite at the end of boot, before any task. Builds in the
+// profiler (see profile.h), which times it.
+#ifndef BENCH_BOOT
+#define BENCH_BOOT 0
+#endif
+
+// Kernels in the suite (see bench.c)
+#define BENCH_NUM_KERNELS 8
+
+// Calls of each kernel timed, but those writing to the console. Ten
+// redraws take about 0.1s on the LPFRC at -O0, well within any task's
+// deadline.
+#define BENCH_RUNS 10
+
+// Time between looks at the console while its output is sent
+#define BENCH_POLL_MS 10
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+uint8_t BENCH_start(void);
+
+void BENCH_handle_event(void);
+
+void BENCH_handle_post_event(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* BENCH_H */
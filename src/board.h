@@ -0,0 +1,116 @@
+/*
+ * File: board.h
+ * Author: Andy Smit
+ * Comments: Compile time board descriptors. Select the board with
+ *           -DBOARD_LAB (or the define of any other board below) on the
+ *           compiler command line; Andy's board is the default.
+ *
+ *           A board header describes each button (port, bit and CN
+ *           number), the button polarity and pull-ups, the initial TRIS
+ *           and AD1PCFG values, the crystal, potentiometer, piezo and
+ *           display if it has them, and its configuration bits inside
+ *           #ifdef BOARD_CONFIG_BITS. Everything the drivers use is
+ *           derived from that here, so adding a board is a new header and
+ *           a line in the list below.
+ * Revision history:
+ */
+
+#ifndef BOARD_PORTS_H
+#define	BOARD_PORTS_H
+
+#define BOARD_PORT_A 0
+#define BOARD_PORT_B 1
+
+#endif	/* BOARD_PORTS_H */
+
+// Outside the guard so main.c can include this file a second time with
+// BOARD_CONFIG_BITS defined to emit the configuration bits.
+#if defined(BOARD_LAB)
+#include "board_lab.h"
+#elif defined(BOARD_PANEL)
+#include "board_panel.h"
+#else
+#include "board_andy.h"
+#endif
+
+#ifndef BOARD_H
+#define	BOARD_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// Pins of the buttons on a port, as a mask
+#define BOARD_PIN_MASK(n, port) \
+    (BOARD_BUTTON##n##_PORT == (port) ? 1u << BOARD_BUTTON##n##_BIT : 0)
+#define BOARD_BUTTON_MASK(port) \
+    (BOARD_PIN_MASK(1, port) | BOARD_PIN_MASK(2, port) | BOARD_PIN_MASK(3, port))
+
+// CN enable (and pull-up) masks for CNEN1/CNPU1 (reg 0, CN0-CN15) and
+// CNEN2/CNPU2 (reg 1, CN16-CN31)
+#define BOARD_CN_BIT(n, reg) \
+    ((BOARD_BUTTON##n##_CN >> 4) == (reg) ? 1u << (BOARD_BUTTON##n##_CN & 15) : 0)
+#define BOARD_CN_MASK(reg) \
+    (BOARD_CN_BIT(1, reg) | BOARD_CN_BIT(2, reg) | BOARD_CN_BIT(3, reg))
+
+// A port value with pressed buttons reading 1
+#if BOARD_BUTTONS_ACTIVE_LOW
+#define BOARD_PRESSED(port_value) (~(port_value))
+#else
+#define BOARD_PRESSED(port_value) (port_value)
+#endif
+
+/*
+ * BOARD_READ_BUTTONS
+ *
+ * Logical button mask, PB1 in bit 0. When the buttons are consecutive
+ * bits of one port in PB1-PB3 order this is a single port read, shift and
+ * mask. Otherwise each port with a button on it is read once and the
+ * bits are moved into place; every port and bit choice is a constant.
+ */
+#if BOARD_BUTTON1_PORT == BOARD_BUTTON2_PORT \
+    && BOARD_BUTTON2_PORT == BOARD_BUTTON3_PORT \
+    && BOARD_BUTTON2_BIT == BOARD_BUTTON1_BIT + 1 \
+    && BOARD_BUTTON3_BIT == BOARD_BUTTON1_BIT + 2
+#if BOARD_BUTTON1_PORT == BOARD_PORT_A
+#define BOARD_READ_BUTTONS() \
+    ((uint8_t)((BOARD_PRESSED(PORTA) >> BOARD_BUTTON1_BIT) & 0x7))
+#else
+#define BOARD_READ_BUTTONS() \
+    ((uint8_t)((BOARD_PRESSED(PORTB) >> BOARD_BUTTON1_BIT) & 0x7))
+#endif
+#else
+#define BOARD_BUTTON_BIT(n, a, b) \
+    (((BOARD_BUTTON##n##_PORT == BOARD_PORT_A ? (a) : (b)) \
+      >> BOARD_BUTTON##n##_BIT) & 1)
+
+static inline uint8_t board_read_buttons(void)
+{
+    uint16_t a = BOARD_BUTTON_MASK(BOARD_PORT_A) ? BOARD_PRESSED(PORTA) : 0;
+    uint16_t b = BOARD_BUTTON_MASK(BOARD_PORT_B) ? BOARD_PRESSED(PORTB) : 0;
+    return BOARD_BUTTON_BIT(1, a, b)
+           | (BOARD_BUTTON_BIT(2, a, b) << 1)
+           | (BOARD_BUTTON_BIT(3, a, b) << 2);
+}
+#define BOARD_READ_BUTTONS() board_read_buttons()
+#endif
+
+#if BOARD_HAS_DISPLAY
+// PORTB bits of a segment pattern, segment a in bit 0 to g in bit 6
+#define BOARD_DISPLAY_BIT(segs, n, bit) (((segs) >> (n) & 1u) << (bit))
+#define BOARD_DISPLAY_SEGMENTS(segs) \
+    (BOARD_DISPLAY_BIT(segs, 0, BOARD_DISPLAY_SEG_A) \
+     | BOARD_DISPLAY_BIT(segs, 1, BOARD_DISPLAY_SEG_B) \
+     | BOARD_DISPLAY_BIT(segs, 2, BOARD_DISPLAY_SEG_C) \
+     | BOARD_DISPLAY_BIT(segs, 3, BOARD_DISPLAY_SEG_D) \
+     | BOARD_DISPLAY_BIT(segs, 4, BOARD_DISPLAY_SEG_E) \
+     | BOARD_DISPLAY_BIT(segs, 5, BOARD_DISPLAY_SEG_F) \
+     | BOARD_DISPLAY_BIT(segs, 6, BOARD_DISPLAY_SEG_G))
+// PORTB bits selecting a digit
+#define BOARD_DISPLAY_SELECT(digit) \
+    (BOARD_DISPLAY_BIT(digit, 0, BOARD_DISPLAY_SEL0) \
+     | BOARD_DISPLAY_BIT(digit, 1, BOARD_DISPLAY_SEL1))
+#define BOARD_DISPLAY_SEG_MASK BOARD_DISPLAY_SEGMENTS(0x7F)
+#define BOARD_DISPLAY_MASK (BOARD_DISPLAY_SEG_MASK | BOARD_DISPLAY_SELECT(3))
+#endif
+
+#endif	/* BOARD_H */
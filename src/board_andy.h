@@ -0,0 +1,67 @@
+/*
+ * File: board_andy.h
+ * Author: Andy Smit
+ * Comments: Board descriptor for Andy's board. Included through board.h.
+ *           Buttons PB1-PB3 on RA0-RA2 with external pull-downs, so they
+ *           read 1 when pressed.
+ * Revision history:
+ */
+
+#ifndef BOARD_ANDY_H
+#define	BOARD_ANDY_H
+
+#define BOARD_NAME "andy"
+
+#define BOARD_BUTTON1_PORT BOARD_PORT_A
+#define BOARD_BUTTON1_BIT 0
+#define BOARD_BUTTON1_CN 2
+#define BOARD_BUTTON2_PORT BOARD_PORT_A
+#define BOARD_BUTTON2_BIT 1
+#define BOARD_BUTTON2_CN 3
+#define BOARD_BUTTON3_PORT BOARD_PORT_A
+#define BOARD_BUTTON3_BIT 2
+#define BOARD_BUTTON3_CN 30
+#define BOARD_BUTTONS_ACTIVE_LOW 0
+#define BOARD_BUTTONS_PULLUP 0
+
+// Pull-up on RA3 (CN29), which is not connected
+#define BOARD_CNPU1_EXTRA 0x0000
+#define BOARD_CNPU2_EXTRA (1u << (29 - 16))
+
+// PORT A<3:0> and RB12 inputs, everything else output. AN6-AN9, AN12
+// and AN13 analog.
+#define BOARD_TRISA 0x000F
+#define BOARD_TRISB 0x1000
+#define BOARD_AD1PCFG 0xCC3F
+
+// 100k potentiometer between VDD and VSS with its wiper on AN12 (RB12),
+// for setting the time (see pot.c).
+#define BOARD_HAS_POT 1
+#define BOARD_POT_AN 12
+
+// 32.768kHz crystal on SOSCI/SOSCO (RB4/RA4), clocking the RTCC. The
+// oscillator takes the pins over from the port once enabled.
+#define BOARD_HAS_SOSC 1
+
+// Piezo on RB15, sounded by the reference clock output (see alarm.c).
+#define BOARD_HAS_PIEZO 1
+
+// No 7-segment display; the time is shown on the UART terminal only.
+#define BOARD_HAS_DISPLAY 0
+
+#endif	/* BOARD_ANDY_H */
+
+#ifdef BOARD_CONFIG_BITS
+// CLOCK CONTROL
+#pragma config IESO = OFF    // 2 Speed Startup disabled
+#pragma config FNOSC = LPFRC//FRC  // Start up CLK = 31 KHz
+#pragma config FCKSM = CSECMD // Clock switching is enabled, clock monitor disabled
+#pragma config SOSCSEL = SOSCLP // Secondary oscillator for Low Power Operation
+#pragma config RTCOSC = SOSC // RTCC uses the 32.768kHz crystal
+#pragma config POSCFREQ = MS  //Primary Oscillator/External clk freq betwn 100kHz and 8 MHz. Options: LS, MS, HS
+#pragma config OSCIOFNC = ON  //CLKO output disabled on pin 8, use as IO.
+#pragma config POSCMOD = NONE  // Primary oscillator mode is disabled
+
+// Set the PGx3 port as the programmer
+#pragma config ICS = PGx3
+#endif
@@ -0,0 +1,93 @@
+/*
+ * File: board_lab.h
+ * Author: Andy Smit
+ * Comments: Board descriptor for the lab board. Included through board.h.
+ *           Buttons PB1 on RA2, PB2 on RB4 and PB3 on RA4, switching to
+ *           ground with the internal pull-ups.
+ * Revision history:
+ */
+
+#ifndef BOARD_LAB_H
+#define	BOARD_LAB_H
+
+#define BOARD_NAME "lab"
+
+#define BOARD_BUTTON1_PORT BOARD_PORT_A
+#define BOARD_BUTTON1_BIT 2
+#define BOARD_BUTTON1_CN 30
+#define BOARD_BUTTON2_PORT BOARD_PORT_B
+#define BOARD_BUTTON2_BIT 4
+#define BOARD_BUTTON2_CN 1
+#define BOARD_BUTTON3_PORT BOARD_PORT_A
+#define BOARD_BUTTON3_BIT 4
+#define BOARD_BUTTON3_CN 0
+#define BOARD_BUTTONS_ACTIVE_LOW 1
+#define BOARD_BUTTONS_PULLUP 1
+
+#define BOARD_CNPU1_EXTRA 0x0000
+#define BOARD_CNPU2_EXTRA 0x0000
+
+// Pins left as inputs, except RB8 which drove the LED before it moved to
+// OC1 and is held low. All pins digital.
+#define BOARD_TRISA 0xFFFF
+#define BOARD_TRISB 0xFEFF
+#define BOARD_AD1PCFG 0xFFFF
+
+// No crystal: PB2 and PB3 sit on the SOSC pins.
+#define BOARD_HAS_SOSC 0
+
+// No potentiometer; the time is set with the buttons only.
+#define BOARD_HAS_POT 0
+
+// Piezo on RB15, sounded by the reference clock output (see alarm.c).
+#define BOARD_HAS_PIEZO 1
+
+// No 7-segment display; the time is shown on the UART terminal only.
+#define BOARD_HAS_DISPLAY 0
+
+#endif	/* BOARD_LAB_H */
+
+#ifdef BOARD_CONFIG_BITS
+//// CONFIGURATION BITS - PRE-PROCESSOR DIRECTIVES ////
+
+// Code protection
+#pragma config BSS = OFF // Boot segment code protect disabled
+#pragma config BWRP = OFF // Boot sengment flash write protection off
+#pragma config GCP = OFF // general segment code protecion off
+#pragma config GWRP = OFF
+
+// CLOCK CONTROL
+#pragma config IESO = OFF    // 2 Speed Startup disabled
+#pragma config FNOSC = LPFRC//FRC  // Start up CLK = 31 KHz
+#pragma config FCKSM = CSECMD // Clock switching is enabled, clock monitor disabled
+#pragma config SOSCSEL = SOSCLP // Secondary oscillator for Low Power Operation
+#pragma config POSCFREQ = HS  //Primary Oscillator/External clk freq betwn 100kHz and 8 MHz. Options: LS, MS, HS
+#pragma config OSCIOFNC = ON  //CLKO output disabled on pin 8, use as IO.
+#pragma config POSCMOD = NONE  // Primary oscillator mode is disabled
+
+// WDT
+#pragma config FWDTEN = OFF // WDT is off
+#pragma config WINDIS = OFF // STANDARD WDT/. Applicable if WDT is on
+#pragma config FWPSA = PR32 // WDT is selected uses prescaler of 32
+#pragma config WDTPS = PS1 // WDT postscler is 1 if WDT selected
+
+//MCLR/RA5 CONTROL
+#pragma config MCLRE = OFF // RA5 pin configured as input, MCLR reset on RA5 diabled
+
+//BOR  - FPOR Register
+#pragma config BORV = LPBOR // LPBOR value=2V is BOR enabled
+#pragma config BOREN = BOR0 // BOR controlled using SBOREN bit
+#pragma config PWRTEN = OFF // Powerup timer disabled
+#pragma config I2C1SEL = PRI // Default location for SCL1/SDA1 pin
+
+//JTAG FICD Register
+#pragma config BKBUG = OFF // Background Debugger functions disabled
+#pragma config ICS = PGx2 // PGC2 (pin2) & PGD2 (pin3) are used to connect PICKIT3 debugger
+
+// Deep Sleep RTCC WDT
+#pragma config DSWDTEN = OFF // Deep Sleep WDT is disabled
+#pragma config DSBOREN = OFF // Deep Sleep BOR is disabled
+#pragma config RTCOSC = LPRC// RTCC uses LPRC 32kHz for clock
+#pragma config DSWDTOSC = LPRC // DeepSleep WDT uses Lo Power RC clk
+#pragma config DSWDTPS = DSWDTPS7 // DSWDT postscaler set to 32768
+#endif
@@ -0,0 +1,76 @@
+/*
+ * File: board_panel.h
+ * Author: Andy Smit
+ * Comments: Board descriptor for the panel build of Andy's board, with a
+ *           4 digit 7-segment display in place of the crystal, the pot
+ *           and the piezo. Included through board.h. Buttons PB1-PB3 on
+ *           RA0-RA2 with external pull-downs, as on Andy's board.
+ * Revision history:
+ */
+
+#ifndef BOARD_PANEL_H
+#define	BOARD_PANEL_H
+
+#define BOARD_NAME "panel"
+
+#define BOARD_BUTTON1_PORT BOARD_PORT_A
+#define BOARD_BUTTON1_BIT 0
+#define BOARD_BUTTON1_CN 2
+#define BOARD_BUTTON2_PORT BOARD_PORT_A
+#define BOARD_BUTTON2_BIT 1
+#define BOARD_BUTTON2_CN 3
+#define BOARD_BUTTON3_PORT BOARD_PORT_A
+#define BOARD_BUTTON3_BIT 2
+#define BOARD_BUTTON3_CN 30
+#define BOARD_BUTTONS_ACTIVE_LOW 0
+#define BOARD_BUTTONS_PULLUP 0
+
+// Pull-up on RA3 (CN29), which is not connected
+#define BOARD_CNPU1_EXTRA 0x0000
+#define BOARD_CNPU2_EXTRA (1u << (29 - 16))
+
+// PORT A<3:0> and U2RX inputs, everything else output. All pins digital.
+#define BOARD_TRISA 0x000F
+#define BOARD_TRISB 0x0002
+#define BOARD_AD1PCFG 0xFFFF
+
+// The display takes RB4 and RB15, so there is no crystal and no piezo,
+// and RB12 (AN12), so there is no pot.
+#define BOARD_HAS_SOSC 0
+#define BOARD_HAS_POT 0
+#define BOARD_HAS_PIEZO 0
+
+// Common cathode display, multiplexed by display.c. The segments a-g are
+// driven high through their resistors from the PORTB bits below. The
+// digit is selected with its number, 0 on the left, on SEL1:SEL0, which
+// drive a 74HC139 whose active low outputs sink the digit commons. The
+// colon is wired on. Segments and digit are all on PORTB, so one write
+// moves the display to the next digit; the 20 pin part has no room for
+// four digit lines besides the seven segments.
+#define BOARD_HAS_DISPLAY 1
+#define BOARD_DISPLAY_SEG_A 2
+#define BOARD_DISPLAY_SEG_B 4
+#define BOARD_DISPLAY_SEG_C 7
+#define BOARD_DISPLAY_SEG_D 8
+#define BOARD_DISPLAY_SEG_E 9
+#define BOARD_DISPLAY_SEG_F 12
+#define BOARD_DISPLAY_SEG_G 13
+#define BOARD_DISPLAY_SEL0 14
+#define BOARD_DISPLAY_SEL1 15
+
+#endif	/* BOARD_PANEL_H */
+
+#ifdef BOARD_CONFIG_BITS
+// CLOCK CONTROL
+#pragma config IESO = OFF    // 2 Speed Startup disabled
+#pragma config FNOSC = LPFRC//FRC  // Start up CLK = 31 KHz
+#pragma config FCKSM = CSECMD // Clock switching is enabled, clock monitor disabled
+#pragma config SOSCSEL = SOSCLP // Secondary oscillator for Low Power Operation
+#pragma config RTCOSC = LPRC // No crystal, RTCC uses LPRC
+#pragma config POSCFREQ = MS  //Primary Oscillator/External clk freq betwn 100kHz and 8 MHz. Options: LS, MS, HS
+#pragma config OSCIOFNC = ON  //CLKO output disabled on pin 8, use as IO.
+#pragma config POSCMOD = NONE  // Primary oscillator mode is disabled
+
+// Set the PGx3 port as the programmer
+#pragma config ICS = PGx3
+#endif
@@ -0,0 +1,43 @@
+/*
+ * File:   boot.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Boot time instrumentation. The system time starts from 0 at the top of
+ * main() and each boot stage records it.
+ *
+ * Time spent in the C startup code before main() is not counted.
+ */
+
+#include <xc.h>
+#include "boot.h"
+#include "timebase.h"
+
+volatile uint16_t boot_ticks[BOOT_NUM_STAGES] = {0};
+
+
+/*
+ * BOOT_mark
+ *
+ * Record the end of a boot stage. Only the first mark of a stage counts.
+ *
+ * @param stage The stage that has just completed
+ * @return None
+ */
+void BOOT_mark(boot_stage_t stage)
+{
+    uint32_t now;
+
+    if (boot_ticks[stage])
+    {
+        return;
+    }
+    now = TIMEBASE_now();
+    boot_ticks[stage] = now > BOOT_TICKS_SATURATED ? BOOT_TICKS_SATURATED
+                                                   : now;
+    if (boot_ticks[stage] == 0)
+    {
+        boot_ticks[stage] = 1;
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * File: boot.h
+ * Author: Andy Smit
+ * Comments: Boot stage timestamps and the boot time budgets.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef BOOT_H
+#define	BOOT_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+#include "timebase.h"
+
+// Boot stages in the order they complete. BOOT_STAGE_READY is the end of
+// the essential phase: from there a button press is handled. Display and
+// response are the first display output and the first handled button
+// event.
+typedef enum
+{
+    BOOT_STAGE_IO = 0,
+    BOOT_STAGE_EEPROM,
+    BOOT_STAGE_READY,
+    BOOT_STAGE_DISPLAY,
+    BOOT_STAGE_RESPONSE,
+    BOOT_NUM_STAGES
+} boot_stage_t;
+
+// Stages are stamped with the system time (see timebase.h), saturating
+// at 0xFFFF: 16.8s on the LPFRC or 4.2s on the FRC.
+#define BOOT_TICK_US TIMEBASE_TICK_US
+#define BOOT_TICKS_SATURATED 0xFFFF
+
+// Regression budgets, checked by the host simulator. Response is measured
+// from a press at reset.
+#define BOOT_BUDGET_DISPLAY_MS 30
+#define BOOT_BUDGET_RESPONSE_MS 30
+
+// Ticks since TIMEBASE_init at the end of each stage, 0 if the stage has
+// not been reached.
+extern volatile uint16_t boot_ticks[BOOT_NUM_STAGES];
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void BOOT_mark(boot_stage_t stage);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* BOOT_H */
@@ -0,0 +1,232 @@
+/*
+ * File:   calib.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Clock calibration. The LPFRC and FRC are only accurate to a few
+ * percent, and drift with temperature and supply; the 32.768kHz crystal
+ * is accurate to a few ppm. The crystal clocks the RTCC, whose alarm
+ * interrupts on every second. The ISR stamps each second with the system
+ * time, and every CALIB_WINDOW_S seconds the calibration task turns the
+ * ticks counted into the true instruction clock rate:
+ *
+ *   - CLOCK_set_fcy replaces the nominal rate, so the timer periods and
+ *     baud rates computed from then on are right, and the UART divider is
+ *     recomputed at once.
+ *   - The countdown times its seconds with the measured ticks per second
+ *     (CALIB_next_second).
+ *   - On the FRC, OSCTUN is stepped towards the nominal 8MHz, which also
+ *     corrects the fixed dividers (LED PWM, REFO tone). The LPFRC cannot
+ *     be tuned. The window running while OSCTUN changes is discarded.
+ *
+ * The measurement runs for as long as the board is on, so it follows the
+ * drift. Timer 1 cannot count the crystal itself, as it is the system
+ * timebase; the RTCC is the one other peripheral the crystal can clock.
+ * On a board without the crystal nothing runs and the nominal rate is
+ * kept.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "calib.h"
+#include "board.h"
+#include "clock.h"
+#include "timebase.h"
+#include "sched.h"
+#include "power.h"
+#include "UART2.h"
+#include "sync.h"
+#include "profile.h"
+
+// Ticks per second of the crystal, in 1/256 ticks.
+static uint32_t calib_rate = CALIB_NOMINAL_RATE;
+// System time of the first second of the window in progress, and ticks in
+// the last completed window. Written by the ISR only.
+static volatile uint32_t calib_start = 0;
+static volatile uint32_t calib_ticks = 0;
+// Seconds into the window in progress; 0 until the first second.
+static volatile uint8_t calib_seconds = 0;
+// Skip the next window, which started before OSCTUN changed.
+static uint8_t calib_discard = 0;
+
+
+/*
+ * CALIB_init
+ *
+ * Start the crystal and the RTCC alarm on every second. The crystal
+ * takes up to a second to start, and the first measurement completes
+ * CALIB_WINDOW_S seconds after its first second.
+ *
+ * @param None
+ * @return None
+ */
+void CALIB_init(void)
+{
+#if BOARD_HAS_SOSC
+    // SOSCEN. The builtin performs the OSCCON unlock sequence.
+    __builtin_write_OSCCONL(OSCCON | 0x02);
+    POWER_acquire(POWER_RTCC);
+
+    __builtin_write_RTCWEN();
+    RCFGCALbits.RTCEN = 0;
+    ALCFGRPT = 0;
+    ALCFGRPTbits.AMASK = 0b0001; // Alarm every second
+    ALCFGRPTbits.CHIME = 1; // Repeat forever
+    ALCFGRPTbits.ALRMEN = 1;
+    RCFGCALbits.RTCEN = 1;
+    RCFGCALbits.RTCWREN = 0;
+
+    IPC15bits.RTCIP = IPL_RTCC;
+    IFS3bits.RTCIF = 0;
+    IEC3bits.RTCIE = 1;
+#endif
+}
+
+
+#if CLOCK_FOSC == CLOCK_FRC_HZ
+/*
+ * calib_trim
+ *
+ * Step OSCTUN once towards the nominal FRC frequency.
+ *
+ * @param fcy The measured instruction clock rate in Hz
+ */
+static void calib_trim(uint32_t fcy)
+{
+    // TUN is 6 bit two's complement; positive is faster.
+    int8_t tun = OSCTUNbits.TUN;
+    if (tun & 0x20)
+    {
+        tun -= 0x40;
+    }
+
+    if (fcy > CLOCK_FCY + CLOCK_FCY / CALIB_TRIM_DIV && tun > -32)
+    {
+        tun--;
+    }
+    else if (fcy < CLOCK_FCY - CLOCK_FCY / CALIB_TRIM_DIV && tun < 31)
+    {
+        tun++;
+    }
+    else
+    {
+        return;
+    }
+    OSCTUNbits.TUN = tun;
+    calib_discard = 1;
+    SYNC_clock_stepped();
+}
+#endif
+
+
+/*
+ * CALIB_handle_event
+ *
+ * Take the measurement of a completed window. Runs as the calibration
+ * task (see sched.c).
+ *
+ * @param None
+ * @return None
+ */
+void CALIB_handle_event(void)
+{
+    // The next window completes seconds from now, so the count cannot
+    // change while it is read.
+    uint32_t ticks = calib_ticks;
+    uint32_t nominal = CALIB_NOMINAL_RATE * CALIB_WINDOW_S / 256;
+    uint32_t fcy;
+
+    if (calib_discard)
+    {
+        calib_discard = 0;
+        return;
+    }
+    // A count a quarter off is no RC oscillator: a crystal that has not
+    // started properly, or a second lost to a long critical section.
+    if (ticks < nominal - nominal / 4 || ticks > nominal + nominal / 4)
+    {
+        return;
+    }
+
+    calib_rate = (ticks << 8) / CALIB_WINDOW_S;
+    fcy = ticks * TIMEBASE_PRESCALE / CALIB_WINDOW_S;
+    CLOCK_set_fcy(fcy);
+    UART2_retune();
+#if CLOCK_FOSC == CLOCK_FRC_HZ
+    calib_trim(fcy);
+#endif
+}
+
+
+/*
+ * CALIB_get_rate
+ *
+ * @param None
+ * @return Timebase ticks per second in 1/256 ticks, measured if the
+ *         calibration has run, otherwise nominal
+ */
+uint32_t CALIB_get_rate(void)
+{
+    return calib_rate;
+}
+
+
+/*
+ * CALIB_split_second
+ *
+ * The length of the next second in whole ticks, for a rate in 1/256
+ * ticks per second. A second is rarely a whole number of ticks, so the
+ * fraction left over is carried in the caller's residue and a series of
+ * seconds adds up without drift. Start the residue at 0.
+ *
+ * @param rate Ticks per second in 1/256 ticks
+ * @param residue The caller's fraction of a tick, in 1/256 ticks
+ * @return The ticks to the end of the next second
+ */
+uint32_t CALIB_split_second(uint32_t rate, uint8_t *residue)
+{
+    uint16_t sum = (uint16_t)*residue + (uint8_t)rate;
+    *residue = (uint8_t)sum;
+    return (rate >> 8) + (sum >> 8);
+}
+
+
+/*
+ * CALIB_next_second
+ *
+ * The length of the next second of the crystal in whole ticks, see
+ * CALIB_split_second.
+ *
+ * @param residue The caller's fraction of a tick, in 1/256 ticks
+ * @return The ticks to the end of the next second
+ */
+uint32_t CALIB_next_second(uint8_t *residue)
+{
+    return CALIB_split_second(calib_rate, residue);
+}
+
+
+// A second of the crystal. Stamp it, and post the calibration task at the
+// end of each window.
+void ISR _RTCCInterrupt(void)
+{
+    uint32_t now;
+    PROFILE_ISR_ENTER();
+
+    now = TIMEBASE_now();
+    IFS3bits.RTCIF = 0;
+    if (calib_seconds == 0)
+    {
+        calib_start = now;
+    }
+    else if (calib_seconds == CALIB_WINDOW_S)
+    {
+        calib_ticks = now - calib_start;
+        calib_start = now;
+        calib_seconds = 0;
+        SCHED_post(SCHED_TASK_CALIB);
+    }
+    calib_seconds++;
+    PROFILE_ISR_EXIT(PROFILE_ISR_RTCC);
+}
@@ -0,0 +1,49 @@
+/*
+ * File: calib.h
+ * Author: Andy Smit
+ * Comments: Measures the RC oscillator against the 32.768kHz crystal and
+ *           corrects for its error: the calibrated rate replaces the
+ *           nominal one in every divider computed at run time, and on the
+ *           FRC the oscillator itself is trimmed.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef CALIB_H
+#define	CALIB_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+#include "clock.h"
+#include "timebase.h"
+
+// Seconds of the crystal in each measurement.
+#define CALIB_WINDOW_S 4
+
+// Timebase ticks per second if the clock is exact, in 1/256 ticks.
+#define CALIB_NOMINAL_RATE (CLOCK_FCY * 256 / TIMEBASE_PRESCALE)
+
+// The FRC is trimmed while it is off by more than 1/CALIB_TRIM_DIV. Keep
+// this above half an OSCTUN step, or the trim hunts around nominal.
+#define CALIB_TRIM_DIV 500
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void CALIB_init(void);
+
+void CALIB_handle_event(void);
+
+uint32_t CALIB_get_rate(void);
+
+uint32_t CALIB_split_second(uint32_t rate, uint8_t *residue);
+
+uint32_t CALIB_next_second(uint8_t *residue);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* CALIB_H */
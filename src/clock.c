@@ -0,0 +1,79 @@
+/*
+ * File:   clock.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * System clock. The configuration bits start the CPU on the LPFRC with
+ * clock switching enabled (FCKSM = CSECMD); a build for the 8MHz FRC
+ * switches over here, before anything that depends on Fcy has started.
+ *
+ * Both RC oscillators are only accurate to a few percent. Drivers whose
+ * rates are set at run time take Fcy from CLOCK_get_fcy, which starts
+ * at the nominal CLOCK_FCY and is replaced by the measured rate once the
+ * calibration (calib.c) has one.
+ */
+
+#include <xc.h>
+#include "clock.h"
+
+// NOSC value for the FRC oscillator without postscaler
+#define CLOCK_NOSC_FRC 0b000
+
+// Best known instruction clock rate in Hz.
+static uint32_t clock_fcy = CLOCK_FCY;
+
+
+/*
+ * CLOCK_init
+ *
+ * Set up the system clock selected in clock.h. Call first thing in
+ * main().
+ *
+ * @param None
+ * @return None
+ */
+void CLOCK_init(void)
+{
+    // FRC postscaler 1:1
+    CLKDIVbits.RCDIV = 0;
+
+#if CLOCK_FOSC == CLOCK_FRC_HZ
+    // The builtins perform the OSCCON unlock sequences.
+    __builtin_write_OSCCONH(CLOCK_NOSC_FRC);
+    __builtin_write_OSCCONL(OSCCON | 0x01);
+    // OSWEN clears once the FRC is running. The FRC starts in a few
+    // microseconds.
+    while (OSCCONbits.OSWEN)
+    {
+    }
+#endif
+}
+
+
+/*
+ * CLOCK_get_fcy
+ *
+ * @param None
+ * @return The instruction clock rate in Hz, measured if the calibration
+ *         has run, otherwise nominal
+ */
+uint32_t CLOCK_get_fcy(void)
+{
+    return clock_fcy;
+}
+
+
+/*
+ * CLOCK_set_fcy
+ *
+ * Record a measured instruction clock rate. Drivers pick it up the next
+ * time they compute a divider.
+ *
+ * @param fcy The rate in Hz
+ * @return None
+ */
+void CLOCK_set_fcy(uint32_t fcy)
+{
+    clock_fcy = fcy;
+}
@@ -0,0 +1,51 @@
+/*
+ * File: clock.h
+ * Author: Andy Smit
+ * Comments: System clock selection. The clock is chosen at compile time
+ *           with -DCLOCK_FRC_8MHZ; the default is the 500kHz LPFRC the
+ *           configuration bits start on. Drivers derive their periods and
+ *           baud rates from CLOCK_FCY, so nothing else changes between
+ *           the two; those set at run time use CLOCK_get_fcy, the rate
+ *           measured against the 32.768kHz crystal where there is one.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef CLOCK_H
+#define	CLOCK_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+#define CLOCK_LPFRC_HZ 500000UL
+#define CLOCK_FRC_HZ 8000000UL
+
+#ifdef CLOCK_FRC_8MHZ
+#define CLOCK_FOSC CLOCK_FRC_HZ
+// Fosc is the LPFRC shifted left by this much. Dividers that only divide
+// by powers of two (REFO) add it to get the same output frequency.
+#define CLOCK_FOSC_SHIFT 4
+#else
+#define CLOCK_FOSC CLOCK_LPFRC_HZ
+#define CLOCK_FOSC_SHIFT 0
+#endif
+
+// Instruction clock, which clocks the timers and the UART.
+#define CLOCK_FCY (CLOCK_FOSC / 2)
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void CLOCK_init(void);
+
+uint32_t CLOCK_get_fcy(void);
+
+void CLOCK_set_fcy(uint32_t fcy);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* CLOCK_H */
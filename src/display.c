@@ -0,0 +1,293 @@
+/*
+ * File:   display.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Multiplexed 7-segment display of the countdown as MM:SS, on boards
+ * that have one (BOARD_HAS_DISPLAY). Only one digit is lit at a time.
+ * Timer 3 divides the refresh period into a slot per digit, and at the
+ * start of each slot its interrupt lights the next digit with a single
+ * write of PORTB, which sets the segments and selects the digit at once.
+ *
+ * The port value of each digit is kept in display_frame, built from the
+ * const display_font table (a segment pattern per decimal digit, already
+ * in PORTB bits) when the time changes, so the interrupt only copies a
+ * word. A frame updated while it is being shown mixes the old and new
+ * time for one refresh period at most.
+ *
+ * Below full brightness each slot has a second phase: the interrupt ends
+ * the digit's on-time by clearing the segments, and the next one lights
+ * the next digit. Timer 3 alternates between the two lengths, so the
+ * brightness costs nothing but the extra interrupt.
+ *
+ * The display starts with the first time shown and runs until its
+ * brightness is set to 0 (see battery.c). It runs in Idle.
+ */
+
+#include <xc.h>
+#include <stdio.h>
+#include "main.h"
+#include "display.h"
+#include "atomic.h"
+#include "clock.h"
+#include "power.h"
+#include "timebase.h"
+#include "board.h"
+
+// Timer 3 counts Fcy for a slot of each digit in the refresh period: 625
+// on the LPFRC, 10000 on the FRC.
+#define DISPLAY_SLOT_CYCLES (CLOCK_FCY / (DISPLAY_REFRESH_HZ * DISPLAY_DIGITS))
+
+#if BOARD_HAS_DISPLAY
+// Segments a (bit 0) to g (bit 6) of the decimal digits, as PORTB bits.
+static const uint16_t display_font[10] = {
+    BOARD_DISPLAY_SEGMENTS(0x3F), BOARD_DISPLAY_SEGMENTS(0x06),
+    BOARD_DISPLAY_SEGMENTS(0x5B), BOARD_DISPLAY_SEGMENTS(0x4F),
+    BOARD_DISPLAY_SEGMENTS(0x66), BOARD_DISPLAY_SEGMENTS(0x6D),
+    BOARD_DISPLAY_SEGMENTS(0x7D), BOARD_DISPLAY_SEGMENTS(0x07),
+    BOARD_DISPLAY_SEGMENTS(0x7F), BOARD_DISPLAY_SEGMENTS(0x6F),
+};
+
+// PORTB value of each digit, its select bits included
+static volatile uint16_t display_frame[DISPLAY_DIGITS];
+static uint8_t display_digit = 0;
+// The digit is in its on-time. Only changes below full brightness.
+static uint8_t display_lit = 0;
+// PR3 for the on and off phases of a slot. Off is 0 at full brightness,
+// which has no off phase.
+static volatile uint16_t display_on_pr;
+static volatile uint16_t display_off_pr;
+
+static uint8_t display_level = DISPLAY_BRIGHTNESS;
+static uint8_t display_running = 0;
+static uint8_t display_shown = 0;
+static uint8_t display_blanked = 0;
+static bcd_time_t display_time = 0;
+
+// Interrupts since the last status dump, and when that was
+static volatile uint32_t display_irqs = 0;
+static uint32_t display_since = 0;
+
+
+/*
+ * display_update
+ *
+ * Build the frame for the time shown.
+ */
+static void display_update(void)
+{
+    uint8_t i;
+
+    // A digit per nibble, the tens of minutes in the top one
+    for (i = 0; i < DISPLAY_DIGITS; i++)
+    {
+        uint8_t digit = display_time >> (12 - 4 * i) & 0x0F;
+        display_frame[i] = BOARD_DISPLAY_SELECT(i)
+                           | (display_blanked ? 0 : display_font[digit]);
+    }
+}
+
+
+/*
+ * display_phases
+ *
+ * Set the phase lengths for the brightness.
+ */
+static void display_phases(void)
+{
+    uint16_t on = (uint32_t)DISPLAY_SLOT_CYCLES * display_level
+                  / DISPLAY_BRIGHTNESS_MAX;
+    uint16_t ipl;
+
+    CRITICAL_ENTER(ipl, IPL_DISPLAY);
+    display_on_pr = on - 1;
+    display_off_pr = display_level < DISPLAY_BRIGHTNESS_MAX
+                     ? DISPLAY_SLOT_CYCLES - on - 1 : 0;
+    CRITICAL_EXIT(ipl);
+}
+
+
+/*
+ * display_start
+ *
+ * Power up Timer 3 and start the refresh.
+ */
+static void display_start(void)
+{
+    POWER_acquire(POWER_TIMER3);
+    display_phases();
+    T3CON = 0; // Internal clock, 1:1, continue in idle
+    TMR3 = 0;
+    PR3 = display_on_pr;
+    display_lit = 0;
+    IPC2bits.T3IP = IPL_DISPLAY;
+    IFS0bits.T3IF = 0;
+    IEC0bits.T3IE = 1;
+    T3CONbits.TON = 1;
+    display_irqs = 0;
+    display_since = TIMEBASE_now();
+    display_running = 1;
+}
+
+
+/*
+ * display_stop
+ *
+ * Stop the refresh with every segment off and power Timer 3 down.
+ */
+static void display_stop(void)
+{
+    IEC0bits.T3IE = 0;
+    T3CON = 0;
+    LATB &= ~BOARD_DISPLAY_SEG_MASK;
+    POWER_release(POWER_TIMER3);
+    display_running = 0;
+}
+#endif
+
+
+/*
+ * DISPLAY_show_time
+ *
+ * Show a time as MM:SS from the next refresh, starting the display the
+ * first time.
+ *
+ * @param time The time
+ * @return None
+ */
+void DISPLAY_show_time(bcd_time_t time)
+{
+#if BOARD_HAS_DISPLAY
+    display_time = time;
+    display_update();
+    display_shown = 1;
+    if (!display_running && display_level)
+    {
+        display_start();
+    }
+#endif
+}
+
+
+/*
+ * DISPLAY_set_brightness
+ *
+ * Set the on-time of each digit, or turn the display off.
+ *
+ * @param level 0 (off) to DISPLAY_BRIGHTNESS_MAX
+ * @return None
+ */
+void DISPLAY_set_brightness(uint8_t level)
+{
+#if BOARD_HAS_DISPLAY
+    display_level = level > DISPLAY_BRIGHTNESS_MAX ? DISPLAY_BRIGHTNESS_MAX
+                                                    : level;
+    if (!display_level)
+    {
+        if (display_running)
+        {
+            display_stop();
+        }
+    }
+    else if (display_running)
+    {
+        display_phases();
+    }
+    else if (display_shown)
+    {
+        display_start();
+    }
+#endif
+}
+
+
+/*
+ * DISPLAY_blank
+ *
+ * Blank the display, keeping the time it shows once unblanked. The
+ * refresh goes on, so unblanking takes effect at once.
+ *
+ * @param blank 1 to blank the display, 0 to show the time again
+ * @return None
+ */
+void DISPLAY_blank(uint8_t blank)
+{
+#if BOARD_HAS_DISPLAY
+    display_blanked = blank;
+    display_update();
+#endif
+}
+
+
+/*
+ * DISPLAY_display_status
+ *
+ * Print the refresh rate, the brightness and the refresh interrupts a
+ * second since the last status dump, with the part of the CPU they take,
+ * on their own line. The CPU runs the interrupts dozed (see battery.c),
+ * so doze multiplies their load. Prints nothing on boards without a
+ * display.
+ *
+ * @param None
+ * @return None
+ */
+void DISPLAY_display_status(void)
+{
+#if BOARD_HAS_DISPLAY
+    char s[64];
+    uint32_t irqs;
+    uint32_t ticks;
+    uint32_t rate = 0;
+    uint32_t permille;
+    uint16_t ipl;
+
+    CRITICAL_ENTER(ipl, IPL_DISPLAY);
+    irqs = display_irqs;
+    display_irqs = 0;
+    CRITICAL_EXIT(ipl);
+    ticks = TIMEBASE_elapsed(display_since);
+    display_since += ticks;
+    if (display_running && ticks)
+    {
+        rate = (uint64_t)irqs * TIMEBASE_HZ / ticks;
+    }
+    permille = rate * DISPLAY_ISR_CYCLES
+               * (CLKDIVbits.DOZEN ? 1u << CLKDIVbits.DOZE : 1)
+               / (CLOCK_get_fcy() / 1000);
+    snprintf(s, sizeof(s), "display %u Hz %u/%u %lu irq/s ~%lu.%lu%% cpu\r\n",
+             DISPLAY_REFRESH_HZ, display_level, DISPLAY_BRIGHTNESS_MAX,
+             (unsigned long)rate, (unsigned long)(permille / 10),
+             (unsigned long)(permille % 10));
+    Disp2String(s);
+#endif
+}
+
+
+#if BOARD_HAS_DISPLAY
+// Start of a digit's slot, or the end of its on-time when dimmed.
+void ISR _T3Interrupt(void)
+{
+    IFS0bits.T3IF = 0;
+    display_irqs++;
+    if (display_lit && display_off_pr)
+    {
+        LATB &= ~BOARD_DISPLAY_SEG_MASK;
+        PR3 = display_off_pr;
+        display_lit = 0;
+    }
+    else
+    {
+        display_digit = (display_digit + 1) & (DISPLAY_DIGITS - 1);
+        LATB = (LATB & ~BOARD_DISPLAY_MASK) | display_frame[display_digit];
+        PR3 = display_on_pr;
+        display_lit = 1;
+    }
+    // Held off past the end of the new phase, by doze or by the ISRs
+    // above: end it at the next count rather than after TMR3 wraps.
+    if (TMR3 > PR3)
+    {
+        TMR3 = PR3;
+    }
+}
+#endif
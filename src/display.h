@@ -0,0 +1,54 @@
+/*
+ * File: display.h
+ * Author: Andy Smit
+ * Comments: 4 digit multiplexed 7-segment display of the countdown as
+ *           MM:SS, refreshed a digit at a time from the Timer 3
+ *           interrupt, on boards that have one (BOARD_HAS_DISPLAY).
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef DISPLAY_H
+#define	DISPLAY_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+#include "bcd.h"
+
+#define DISPLAY_DIGITS 4
+
+// Times a second each digit is lit. Every digit costs an interrupt per
+// refresh, two when dimmed, so this trades flicker against CPU time;
+// below about 60 Hz the display flickers.
+#define DISPLAY_REFRESH_HZ 100
+
+// Brightness is the part of its quarter of the refresh period each digit
+// is lit for, in steps of 1/DISPLAY_BRIGHTNESS_MAX. The current the
+// segments draw scales with it. 0 turns the display off.
+#define DISPLAY_BRIGHTNESS_MAX 8
+#define DISPLAY_BRIGHTNESS 4
+
+// Instruction cycles of one refresh interrupt, entry and return
+// included, for the CPU load in the status dump. An estimate, not yet
+// measured, so the dump marks the load with "~"; measure it with the MPLAB
+// X Stopwatch (see README.md, Interrupts) and drop the mark.
+#define DISPLAY_ISR_CYCLES 40
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void DISPLAY_show_time(bcd_time_t time);
+
+void DISPLAY_set_brightness(uint8_t level);
+
+void DISPLAY_blank(uint8_t blank);
+
+void DISPLAY_display_status(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* DISPLAY_H */
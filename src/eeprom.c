@@ -0,0 +1,310 @@
+/*
+ * File:   eeprom.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Append-only journal in the 512 byte data EEPROM. Every save writes a
+ * complete record (last countdown and all presets) to the slot after
+ * the newest one, so erases are spread evenly over the whole array.
+ * Each record carries a sequence number and a checksum; the checksum is
+ * the last word written, so a record cut short by a reset is ignored.
+ *
+ * Erase and write take a few milliseconds each. They are started here
+ * and continued from the main loop on each NVM interrupt, so nothing
+ * ever waits on the EEPROM. The data EEPROM is only powered during the
+ * boot scan and while a record is being written.
+ */
+
+#include <xc.h>
+#include <string.h>
+#include "main.h"
+#include "eeprom.h"
+#include "sched.h"
+#include "power.h"
+#include "profile.h"
+
+#define EEPROM_RECORD_WORDS 8
+#define EEPROM_NUM_SLOTS (512 / 2 / EEPROM_RECORD_WORDS)
+
+// NVMCON values: WREN set, with ERASE and NVMOP for the operation
+#define NVMCON_ERASE_8_WORDS 0x405A
+#define NVMCON_WRITE_WORD 0x4004
+
+// One journal record. Exactly EEPROM_RECORD_WORDS words so a record is
+// erased with a single 8 word erase.
+typedef struct
+{
+    uint16_t seq;
+    uint16_t last_countdown_s;
+    uint16_t presets[EEPROM_NUM_PRESETS];
+    uint16_t reserved;
+    uint16_t checksum;
+} eeprom_record_t;
+
+typedef enum
+{
+    EEPROM_IDLE,
+    EEPROM_ERASING,
+    EEPROM_WRITING
+} eeprom_write_state_t;
+
+static uint16_t __attribute__((space(eedata))) eeprom_data[EEPROM_NUM_SLOTS * EEPROM_RECORD_WORDS];
+
+// Newest values, including changes not yet committed.
+static eeprom_record_t cache;
+// Record currently being written and its slot.
+static eeprom_record_t pending;
+static uint8_t pending_slot;
+// Slot holding the newest complete record.
+static uint8_t newest_slot;
+static uint8_t write_index;
+static uint8_t changed = 0;
+static uint8_t commit_queued = 0;
+static eeprom_write_state_t write_state = EEPROM_IDLE;
+
+
+/*
+ * eeprom_checksum
+ *
+ * Rotate and xor over every word before the checksum. Seeded so an
+ * erased (all 0xFFFF) or zeroed slot never validates.
+ */
+static uint16_t eeprom_checksum(const eeprom_record_t *record)
+{
+    const uint16_t *words = (const uint16_t *)record;
+    uint16_t sum = 0xA55A;
+    uint8_t i;
+    for (i = 0; i < EEPROM_RECORD_WORDS - 1; i++)
+    {
+        sum = ((sum << 1) | (sum >> 15)) ^ words[i];
+    }
+    return sum;
+}
+
+
+static uint16_t eeprom_read_word(uint16_t index)
+{
+    TBLPAG = __builtin_tblpage(eeprom_data);
+    return __builtin_tblrdl(__builtin_tbloffset(eeprom_data) + 2 * index);
+}
+
+
+/*
+ * eeprom_start_nvm
+ *
+ * Start an erase or write on the word at index. Completion raises the
+ * NVM interrupt.
+ */
+static void eeprom_start_nvm(uint16_t nvmcon, uint16_t index, uint16_t data)
+{
+    NVMCON = nvmcon;
+    TBLPAG = __builtin_tblpage(eeprom_data);
+    __builtin_tblwtl(__builtin_tbloffset(eeprom_data) + 2 * index, data);
+    // Performs the unlock sequence with interrupts disabled and sets WR.
+    __builtin_write_NVM();
+}
+
+
+/*
+ * eeprom_start_record
+ *
+ * Snapshot the cache into the next slot of the ring and erase it.
+ */
+static void eeprom_start_record(void)
+{
+    pending = cache;
+    pending.seq = cache.seq + 1;
+    pending.checksum = eeprom_checksum(&pending);
+    pending_slot = (newest_slot + 1) % EEPROM_NUM_SLOTS;
+    changed = 0;
+    write_state = EEPROM_ERASING;
+    POWER_acquire(POWER_EEPROM);
+    eeprom_start_nvm(NVMCON_ERASE_8_WORDS,
+                     pending_slot * EEPROM_RECORD_WORDS, 0);
+}
+
+
+/*
+ * EEPROM_init
+ *
+ * Find the newest valid record in a single pass over the journal and
+ * load it. A blank EEPROM leaves every value at 0.
+ *
+ * @param None
+ * @return None
+ */
+void EEPROM_init(void)
+{
+    eeprom_record_t record;
+    uint16_t *words = (uint16_t *)&record;
+    uint8_t found = 0;
+    uint8_t slot;
+    uint8_t i;
+
+    POWER_acquire(POWER_EEPROM);
+    memset(&cache, 0, sizeof(cache));
+    newest_slot = EEPROM_NUM_SLOTS - 1;
+    for (slot = 0; slot < EEPROM_NUM_SLOTS; slot++)
+    {
+        for (i = 0; i < EEPROM_RECORD_WORDS; i++)
+        {
+            words[i] = eeprom_read_word(slot * EEPROM_RECORD_WORDS + i);
+        }
+        // Sequence numbers in the ring are consecutive, so a wrapping
+        // compare picks the newest.
+        if (record.checksum == eeprom_checksum(&record)
+            && (!found || (int16_t)(record.seq - cache.seq) > 0))
+        {
+            cache = record;
+            newest_slot = slot;
+            found = 1;
+        }
+    }
+    POWER_release(POWER_EEPROM);
+
+    IPC3bits.NVMIP = IPL_NVM;
+    IFS0bits.NVMIF = 0;
+    IEC0bits.NVMIE = 1;
+}
+
+
+uint16_t EEPROM_get_last(void)
+{
+    return cache.last_countdown_s;
+}
+
+
+/*
+ * EEPROM_set_last
+ *
+ * Update the last used countdown. Takes effect in the EEPROM at the next
+ * EEPROM_commit.
+ *
+ * @param countdown_s The countdown in seconds
+ */
+void EEPROM_set_last(uint16_t countdown_s)
+{
+    if (cache.last_countdown_s != countdown_s)
+    {
+        cache.last_countdown_s = countdown_s;
+        changed = 1;
+    }
+}
+
+
+uint16_t EEPROM_get_preset(uint8_t preset)
+{
+    return cache.presets[preset % EEPROM_NUM_PRESETS];
+}
+
+
+/*
+ * EEPROM_set_preset
+ *
+ * Update a preset. Takes effect in the EEPROM at the next EEPROM_commit.
+ *
+ * @param preset Index of the preset
+ * @param countdown_s The countdown in seconds
+ */
+void EEPROM_set_preset(uint8_t preset, uint16_t countdown_s)
+{
+    preset %= EEPROM_NUM_PRESETS;
+    if (cache.presets[preset] != countdown_s)
+    {
+        cache.presets[preset] = countdown_s;
+        changed = 1;
+    }
+}
+
+
+/*
+ * EEPROM_commit
+ *
+ * Start writing a new record if anything changed. Returns immediately;
+ * if a record is already being written the new one follows it.
+ *
+ * @param None
+ * @return None
+ */
+void EEPROM_commit(void)
+{
+    if (!changed)
+    {
+        return;
+    }
+    if (write_state == EEPROM_IDLE)
+    {
+        eeprom_start_record();
+    }
+    else
+    {
+        commit_queued = 1;
+    }
+}
+
+
+/*
+ * EEPROM_handle_nvm_event
+ *
+ * Continue the record write after an erase or word write has finished.
+ * Runs as the NVM task on each NVM interrupt (see sched.c).
+ *
+ * @param None
+ * @return None
+ */
+void EEPROM_handle_nvm_event(void)
+{
+    const uint16_t *words = (const uint16_t *)&pending;
+    switch (write_state)
+    {
+        case EEPROM_ERASING:
+        {
+            write_state = EEPROM_WRITING;
+            write_index = 0;
+            eeprom_start_nvm(NVMCON_WRITE_WORD,
+                             pending_slot * EEPROM_RECORD_WORDS, words[0]);
+            break;
+        }
+        case EEPROM_WRITING:
+        {
+            write_index++;
+            if (write_index < EEPROM_RECORD_WORDS)
+            {
+                eeprom_start_nvm(NVMCON_WRITE_WORD,
+                                 pending_slot * EEPROM_RECORD_WORDS + write_index,
+                                 words[write_index]);
+                break;
+            }
+            // Record complete
+            newest_slot = pending_slot;
+            cache.seq = pending.seq;
+            write_state = EEPROM_IDLE;
+            POWER_release(POWER_EEPROM);
+            if (commit_queued)
+            {
+                commit_queued = 0;
+                EEPROM_commit();
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+
+uint8_t EEPROM_busy(void)
+{
+    return write_state != EEPROM_IDLE;
+}
+
+
+void ISR _NVMInterrupt(void)
+{
+    PROFILE_ISR_ENTER();
+
+    IFS0bits.NVMIF = 0;
+    SCHED_post(SCHED_TASK_NVM);
+    PROFILE_ISR_EXIT(PROFILE_ISR_NVM);
+}
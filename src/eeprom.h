@@ -0,0 +1,43 @@
+/*
+ * File: eeprom.h
+ * Author: Andy Smit
+ * Comments: Wear-leveled journal in data EEPROM for the last used
+ *           countdown and the presets.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef EEPROM_H
+#define	EEPROM_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+#define EEPROM_NUM_PRESETS 4
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void EEPROM_init(void);
+
+uint16_t EEPROM_get_last(void);
+
+void EEPROM_set_last(uint16_t countdown_s);
+
+uint16_t EEPROM_get_preset(uint8_t preset);
+
+void EEPROM_set_preset(uint8_t preset, uint16_t countdown_s);
+
+void EEPROM_commit(void);
+
+void EEPROM_handle_nvm_event(void);
+
+uint8_t EEPROM_busy(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* EEPROM_H */
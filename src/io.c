@@ -8,12 +8,36 @@
 #include <xc.h>
 #include "main.h"
 #include "io.h"
-#include "timer.h"
 #include "UART2.h"
+#include "sched.h"
+#include "timebase.h"
+#include "boot.h"
+#include "power.h"
+#include "board.h"
+#include "profile.h"
 
 
 typedef void (*button_callback_t)(button_t);
 static button_callback_t button_callback = NULL;
+// When the button being held went down
+static uint32_t io_press_time = 0;
+
+// Edges the button task has yet to handle. 4 presses and releases, more
+// than a hand can make between two runs of the task.
+#define IO_EDGE_QUEUE_SIZE 8
+
+typedef struct
+{
+    // TIMEBASE_now when the CN ISR saw the change
+    uint32_t time;
+    button_t buttons;
+} io_edge_t;
+
+static io_edge_t io_edges[IO_EDGE_QUEUE_SIZE];
+// Written by the CN ISR only
+static volatile uint8_t io_edge_head = 0;
+// Written by the button task only
+static volatile uint8_t io_edge_tail = 0;
 
 /*
  * IO_init
@@ -26,53 +50,26 @@ static button_callback_t button_callback = NULL;
  */
 void IO_init()
 {
-    AD1PCFG = 0xFFFF; // Turn all analog pins as digital
-#ifndef ANDY_HARDWARE
-    // Set input/output
-    TRISAbits.TRISA2 = 1;
-    TRISAbits.TRISA4 = 1;
-    TRISBbits.TRISB4 = 1;
-    TRISBbits.TRISB8 = 0;
-
-    //Set pull-ups for inputs
-    CNPU2bits.CN30PUE = 1;
-    CNPU1bits.CN0PUE = 1;
-    CNPU1bits.CN1PUE = 1;
-
-    //Clock output on REF0
-    TRISBbits.TRISB15 = 0;
-    REFOCONbits.ROEN = 1;
-    REFOCONbits.ROSSLP = 0;
-    REFOCONbits.ROSEL = 0;
-    REFOCONbits.RODIV = 0b0000;
+    // Pin directions and analog pins from the board descriptor. Button
+    // pins are always inputs.
+    AD1PCFG = BOARD_AD1PCFG;
+    TRISA = BOARD_TRISA | BOARD_BUTTON_MASK(BOARD_PORT_A);
+    TRISB = BOARD_TRISB | BOARD_BUTTON_MASK(BOARD_PORT_B);
 
-    // Enable interrupts on input pins
-    CNEN2bits.CN30IE = 1;
-    CNEN1bits.CN0IE = 1;
-    CNEN1bits.CN1IE = 1;
+    // Set pull-ups for inputs
+#if BOARD_BUTTONS_PULLUP
+    CNPU1 |= BOARD_CN_MASK(0);
+    CNPU2 |= BOARD_CN_MASK(1);
 #endif
-#ifdef ANDY_HARDWARE
-    // Set PORT A<3:0> as inputs and PORT B as output
-    TRISA = 0x000f;
-    AD1PCFG = 0xDC3F; // Configure all AN pins as digital inputs for use on hardware
-    TRISB = 0x0000;
-
-    //Clock output on REF0
-    TRISBbits.TRISB15 = 0;
-    REFOCONbits.ROEN = 1;
-    REFOCONbits.ROSSLP = 0;
-    REFOCONbits.ROSEL = 0;
-    REFOCONbits.RODIV = 0b0000;
+    CNPU1 |= BOARD_CNPU1_EXTRA;
+    CNPU2 |= BOARD_CNPU2_EXTRA;
 
     // Enable interrupts on input pins
-    CNPU2bits.CN29PUE = 1;
-    CNEN2bits.CN30IE = 1;
-    CNEN1bits.CN2IE = 1;
-    CNEN1bits.CN3IE = 1;
-#endif
+    CNEN1 |= BOARD_CN_MASK(0);
+    CNEN2 |= BOARD_CN_MASK(1);
 
     // Set CN interrupt priority to 3.
-    IPC4bits.CNIP = 3;
+    IPC4bits.CNIP = IPL_CN;
 
     // Enable the CN interrupt
     IEC1bits.CNIE = 1;
@@ -95,28 +92,10 @@ void IO_init()
  */
 button_t Io_get_buttons()
 {
-    // Bit field for button state
-    union Button_state
-    {
-        button_t state;
-        struct
-        {
-            uint8_t s0:1;
-            uint8_t s1:1;
-            uint8_t s2:1;
-        };
-    } buttons = {0};
-    #ifdef ANDY_HARDWARE
-    // Using positive logic buttons read directly.
-    buttons.state = PORTA & 0x7;
-    #else
-    buttons.s0 = !PORTAbits.RA2;
-    buttons.s1 = !PORTBbits.RB4;
-    buttons.s2 = !PORTBbits.RA4;
-    #endif
-    debug_hex(buttons.state);
-
-    return buttons.state;
+    button_t buttons = BOARD_READ_BUTTONS();
+    debug_hex(buttons);
+
+    return buttons;
 }
 
 
@@ -134,21 +113,33 @@ void IO_set_button_callback(button_callback_t callback)
 
 
 /*
- * IO_handle_button_event
+ * IO_dispatch
  *
- * Handle buttons being pressed and released. Call the appropriate
- * button callback when buttons are released. Determine if a button
- * press was long or short.
+ * Hand a button event to the callback of the current state.
  *
- * @param none
+ * @param buttons The buttons released, or the long press
  */
-void IO_handle_button_event()
+void IO_dispatch(button_t buttons)
+{
+    (*button_callback)(buttons);
+}
+
+
+/*
+ * io_button_edge
+ *
+ * Act on one change of the buttons at the time the CN ISR stamped it.
+ * A press is long if it was held IO_LONG_PRESS_MS between its two edges.
+ * Buttons 1 and 2 together are dispatched as they meet, and nothing else
+ * is until all the buttons are up again.
+ */
+static void io_button_edge(button_t cur_buttons, uint32_t event_time)
 {
-    // Current and previous state of the buttons.
-    button_t cur_buttons = Io_get_buttons();
+    // Previous state of the buttons
     static button_t pre_buttons = NO_BUTTONS;
+    // Buttons 1 and 2 met during this press
+    static uint8_t chord = 0;
 
-    debug_print("Button Handler");
     debug_hex(pre_buttons);
     debug_hex(cur_buttons);
     switch (cur_buttons)
@@ -156,10 +147,15 @@ void IO_handle_button_event()
         // Handle button events on release of button
         case NO_BUTTONS:
         {
-            timer_stop(TIMER3);
-            // Check if button timer finished and if true switch button
-            // to long press
-            if(!timer_flags.timer2_flag)
+            if (chord)
+            {
+                chord = 0;
+                break;
+            }
+            // Check if the button was held for the long press time and if
+            // true switch button to long press
+            if(event_time - io_press_time
+               >= TIMEBASE_MS_TO_TICKS(IO_LONG_PRESS_MS))
             {
                 switch (pre_buttons)
                 {
@@ -182,71 +178,142 @@ void IO_handle_button_event()
                         break;
                 }
             }
-            else
-            {
-                // Stop the button timer if it hasn't expired yet.
-                timer_stop(TIMER2);
-            }
+            SCHED_cancel(SCHED_TASK_HOLD);
             // Callback to button handler
             debug_print("Callback");
-            (*button_callback)(pre_buttons);
+            IO_dispatch(pre_buttons);
+            break;
         }
-        // If a button has been pressed down start the timer for 3s to
-        // check for long presses.
+        // If a button has been pressed down note when, and start the
+        // hold task, which runs every 500ms to auto-repeat buttons 1 and
+        // 2 (see APP_handle_hold_event).
         case BUTTON1:
         case BUTTON2:
+        case BUTTON3:
         {
-            // For buttons 1 and 2 detect if the button has been held
-            // down and trigger a timer every 500ms in that case
-            timer_start(TIMER3, 500);
+            if (chord)
+            {
+                break;
+            }
+            io_press_time = event_time;
+            SCHED_post_at(SCHED_TASK_HOLD, event_time
+                          + TIMEBASE_MS_TO_TICKS(IO_HOLD_TICK_MS));
+            break;
         }
-        case BUTTON3:
+        // Buttons 1 and 2 together, without the auto-repeat of either
+        case BUTTON1_2:
         {
-            timer_start(TIMER2, 3000);
+            if (!chord)
+            {
+                chord = 1;
+                SCHED_cancel(SCHED_TASK_HOLD);
+                IO_dispatch(BUTTON1_2);
+            }
             break;
         }
+        // Other buttons down at once, which nothing acts on
+        default:
+            break;
     }
     // Update the previous buttons
     pre_buttons = cur_buttons;
 }
 
 
-void __attribute__((interrupt, no_auto_psv)) _CNInterrupt(void)
+/*
+ * IO_handle_button_event
+ *
+ * Handle buttons being pressed and released, in the order the CN ISR
+ * saw them. Call the appropriate button callback when buttons are
+ * released. Determine if a button press was long or short.
+ *
+ * @param none
+ */
+void IO_handle_button_event()
+{
+    PROFILE_ENTER();
+
+    BOOT_mark(BOOT_STAGE_RESPONSE);
+
+    debug_print("Button Handler");
+    while (io_edge_tail != io_edge_head)
+    {
+        const io_edge_t *edge = &io_edges[io_edge_tail];
+        io_button_edge(edge->buttons, edge->time);
+        io_edge_tail = (io_edge_tail + 1) % IO_EDGE_QUEUE_SIZE;
+    }
+    PROFILE_EXIT(PROFILE_BUTTON_EVENT);
+}
+
+
+// Read and stamp the buttons as they change, before any task runs.
+void ISR _CNInterrupt(void)
 {
+    static button_t last = NO_BUTTONS;
+    button_t buttons;
+    uint8_t head;
+    PROFILE_ISR_ENTER();
+
     // Clear the interrupt
     IFS1bits.CNIF = 0;
-    interrupt_state.cn_trig = 1;
+    buttons = BOARD_READ_BUTTONS();
+    if (buttons == last)
+    {
+        PROFILE_ISR_EXIT(PROFILE_ISR_CN);
+        return;
+    }
+    last = buttons;
+    head = io_edge_head;
+    if ((head + 1) % IO_EDGE_QUEUE_SIZE == io_edge_tail)
+    {
+        // Full: the newest edge takes the latest state, so intermediate
+        // changes can be lost but never the state the buttons are left in.
+        head = (head + IO_EDGE_QUEUE_SIZE - 1) % IO_EDGE_QUEUE_SIZE;
+        io_edges[head].buttons = buttons;
+        io_edges[head].time = TIMEBASE_now();
+    }
+    else
+    {
+        io_edges[head].buttons = buttons;
+        io_edges[head].time = TIMEBASE_now();
+        io_edge_head = (head + 1) % IO_EDGE_QUEUE_SIZE;
+    }
+    SCHED_post(SCHED_TASK_BUTTON);
+    PROFILE_ISR_EXIT(PROFILE_ISR_CN);
 
     return;
 }
 
 
 /*
- * LED_toggle
+ * REFO_start
  *
- * Toggle the LED on port B8
- */
-void LED_toggle()
-{
-    LATBbits.LATB8 ^= 1;
-}
-
-/*
- * LED_on
+ * Output the system clock divided by 2^divider on REFO (RB15). Every call
+ * must be paired with REFO_stop; the module is powered off once the last
+ * user has stopped it.
  *
- * Turn the LED on port B8 on
+ * @param divider RODIV value, 0 to 15
  */
-void LED_on()
+void REFO_start(uint8_t divider)
 {
-    LATBbits.LATB8 = 1;
+    if (POWER_acquire(POWER_REFO))
+    {
+        TRISBbits.TRISB15 = 0;
+        REFOCON = 0;
+        REFOCONbits.ROSSLP = 0;
+        REFOCONbits.ROSEL = 0;
+    }
+    REFOCONbits.RODIV = divider;
+    REFOCONbits.ROEN = 1;
 }
 
+
 /*
- * LED_off
+ * REFO_stop
  *
- * Turn the LED on port B8 off
+ * Release the clock output started with REFO_start.
  */
-void LED_off()
+void REFO_stop()
 {
-    LATBbits.LATB8 = 0;
+    POWER_release(POWER_REFO);
 }
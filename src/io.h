@@ -11,12 +11,19 @@
 #define	IO_H
 
 #include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// Auto-repeat interval and the hold time of a long press
+#define IO_HOLD_TICK_MS 500
+#define IO_LONG_PRESS_MS 3000
 
 typedef enum
 {
     NO_BUTTONS =0,
     BUTTON1 = 1,
     BUTTON2 = 2,
+    // Buttons 1 and 2 pressed together
+    BUTTON1_2 = 3,
     BUTTON3 = 4,
     BUTTON1_LONG = 5,
     BUTTON2_LONG = 6,
@@ -34,13 +41,13 @@ void IO_handle_button_event();
 
 void IO_set_button_callback();
 
-button_t Io_get_buttons();
+void IO_dispatch(button_t buttons);
 
-void LED_toggle();
+button_t Io_get_buttons();
 
-void LED_on();
+void REFO_start(uint8_t divider);
 
-void LED_off();
+void REFO_stop();
 
 #ifdef	__cplusplus
 }
@@ -0,0 +1,430 @@
+/*
+ * File:   lcd.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * 16x2 character LCD on I2C1 (SCL1 on RB8, SDA1 on RB9, I2C1SEL = PRI),
+ * built in with LCD_I2C. The module is an HD44780 in 4 bit mode behind a
+ * PCF8574 port expander: every I2C byte sets its eight pins, RS, RW, E and
+ * the backlight on P0-P3 and D4-D7 on P4-P7. An instruction or character
+ * is two nibbles, and each nibble takes two bytes, one with E high and
+ * one with it low, as the LCD latches the nibble as E falls.
+ *
+ * Row 0 shows the time, row 1 the note the terminal shows after
+ * it (the preset recalled, or ALARM). Writes only change lcd_want, and
+ * post the LCD task. The task compares it with lcd_shown, what the LCD
+ * has been sent, and queues each character that differs, with a Set
+ * DDRAM Address instruction in front of it unless it follows the one
+ * before. A second of the countdown is one or two characters. The queue
+ * goes out as one transfer driven by the master interrupt, which sends
+ * the next byte as each one ends, so nothing waits on the bus. The
+ * interrupt posts the task once the stop condition is sent, and the task
+ * queues whatever changed in the meantime. I2C1 is powered only for the
+ * transfer.
+ *
+ * At power up the LCD is put through the reset sequence of the HD44780
+ * datasheet, a transfer per instruction with its wait after it. An LCD
+ * that does not acknowledge is tried again from the reset sequence
+ * LCD_RETRY_MS later, so one plugged in later, or reset by a glitch, is
+ * picked up.
+ *
+ * On the LPFRC a byte on the bus lasts about 30 instruction cycles,
+ * about what the interrupt takes, so the transfer goes at the pace of
+ * the interrupt rather than of SCL; the master holds SCL low between
+ * bytes for as long as it needs.
+ */
+
+#include <xc.h>
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "lcd.h"
+#include "sched.h"
+#include "timebase.h"
+#include "power.h"
+#include "clock.h"
+#include "board.h"
+#include "profile.h"
+
+#if LCD_I2C && BOARD_HAS_DISPLAY
+#error "The 7-segment display takes RB8 and RB9, the pins of I2C1"
+#endif
+
+// I2C1BRG for LCD_I2C_HZ, from the datasheet's formula. 2 is the least
+// the module takes, which gives about 83kHz on the LPFRC.
+#define LCD_BRG_FOR_HZ \
+    (CLOCK_FCY / LCD_I2C_HZ - CLOCK_FCY / 10000000UL - 1)
+#define LCD_BRG (LCD_BRG_FOR_HZ < 2 ? 2 : LCD_BRG_FOR_HZ)
+
+// PCF8574 pins. RW (P1) is held low: the LCD is only written.
+#define LCD_RS 0x01
+#define LCD_E 0x04
+#define LCD_BACKLIGHT 0x08
+
+// HD44780 Set DDRAM Address, and the address of the start of row 1
+#define LCD_SET_DDRAM 0x80
+#define LCD_ROW1 0x40
+
+// Entries of a transfer. Up to 7 characters with their addresses, the
+// rest of a full screen follows in the next transfers.
+#define LCD_QUEUE_SIZE 16
+
+typedef enum
+{
+    LCD_BUS_IDLE = 0,
+    LCD_BUS_START,
+    LCD_BUS_DATA,
+    LCD_BUS_STOP
+} lcd_bus_t;
+
+#if LCD_I2C
+typedef struct
+{
+    uint8_t op;
+    // Sent as its high nibble only, as while the LCD is in 8 bit mode
+    uint8_t nibble;
+    // Wait after the instruction
+    uint8_t ms;
+} lcd_reset_step_t;
+
+// Reset by instruction, then 2 lines, display off, clear, increment and
+// display on without a cursor.
+static const lcd_reset_step_t lcd_reset[] = {
+    {0x30, 1, 5}, {0x30, 1, 1}, {0x30, 1, 1}, {0x20, 1, 1},
+    {0x28, 0, 1}, {0x08, 0, 1}, {0x01, 0, 2}, {0x06, 0, 1}, {0x0C, 0, 1},
+};
+#define LCD_RESET_STEPS (sizeof(lcd_reset) / sizeof(lcd_reset[0]))
+
+static char lcd_want[LCD_ROWS][LCD_COLS];
+static char lcd_shown[LCD_ROWS][LCD_COLS];
+// DDRAM address the LCD writes the next character to
+static uint8_t lcd_cursor;
+static uint8_t lcd_step = 0;
+// The next step waits for lcd_ready
+static uint8_t lcd_waiting = 0;
+static uint16_t lcd_wait_ms;
+static uint32_t lcd_ready;
+
+// The transfer: lcd_count entries, of which the interrupt has sent
+// lcd_next. In a text transfer entries below LCD_SET_DDRAM are
+// characters; otherwise all are instructions. Each entry takes
+// lcd_phases bytes.
+static uint8_t lcd_queue[LCD_QUEUE_SIZE];
+static uint8_t lcd_count = 0;
+static uint8_t lcd_next;
+static uint8_t lcd_phase;
+static uint8_t lcd_phases;
+static uint8_t lcd_text;
+static volatile uint8_t lcd_bus = LCD_BUS_IDLE;
+static volatile uint8_t lcd_nack;
+
+// Characters written to the rows and sent to the LCD, and transfers that
+// were not acknowledged
+static uint32_t lcd_written = 0;
+static uint32_t lcd_sent = 0;
+static uint16_t lcd_nacks = 0;
+
+
+/*
+ * lcd_write_row
+ *
+ * Set a row from a string, padded with spaces, and have the task send
+ * what changed.
+ */
+static void lcd_write_row(uint8_t row, const char *s)
+{
+    uint8_t col;
+    char c;
+
+    for (col = 0; col < LCD_COLS; col++)
+    {
+        c = *s ? *s++ : ' ';
+        // Codes from 0x80 would read as instructions in the queue
+        lcd_want[row][col] = (uint8_t)c < LCD_SET_DDRAM ? c : '?';
+    }
+    lcd_written += LCD_COLS;
+    SCHED_post(SCHED_TASK_LCD);
+}
+
+
+/*
+ * lcd_diff
+ *
+ * Queue the characters that differ from what the LCD was sent, until the
+ * queue is full.
+ */
+static void lcd_diff(void)
+{
+    uint8_t row;
+    uint8_t col;
+    uint8_t addr;
+    char c;
+
+    lcd_text = 1;
+    lcd_phases = 4;
+    for (row = 0; row < LCD_ROWS; row++)
+    {
+        for (col = 0; col < LCD_COLS; col++)
+        {
+            c = lcd_want[row][col];
+            if (c == lcd_shown[row][col])
+            {
+                continue;
+            }
+            addr = row * LCD_ROW1 + col;
+            if (addr != lcd_cursor)
+            {
+                if (lcd_count > LCD_QUEUE_SIZE - 2)
+                {
+                    return;
+                }
+                lcd_queue[lcd_count++] = LCD_SET_DDRAM | addr;
+            }
+            else if (lcd_count == LCD_QUEUE_SIZE)
+            {
+                return;
+            }
+            lcd_queue[lcd_count++] = c;
+            lcd_shown[row][col] = c;
+            lcd_cursor = addr + 1;
+            lcd_sent++;
+        }
+    }
+}
+
+
+/*
+ * lcd_start
+ *
+ * Power up I2C1 and start sending the queue with a start condition.
+ */
+static void lcd_start(void)
+{
+    POWER_acquire(POWER_I2C1);
+    I2C1BRG = LCD_BRG;
+    I2C1CON = 0;
+    I2C1CONbits.DISSLW = 1; // Slew rate control is for 400kHz
+    I2C1CONbits.I2CEN = 1;
+    lcd_next = 0;
+    lcd_phase = 0;
+    lcd_nack = 0;
+    lcd_bus = LCD_BUS_START;
+    IFS1bits.MI2C1IF = 0;
+    IEC1bits.MI2C1IE = 1;
+    I2C1CONbits.SEN = 1;
+}
+
+
+/*
+ * lcd_end
+ *
+ * Power I2C1 down after a transfer.
+ */
+static void lcd_end(void)
+{
+    IEC1bits.MI2C1IE = 0;
+    I2C1CON = 0;
+    POWER_release(POWER_I2C1);
+    lcd_count = 0;
+}
+#endif
+
+
+/*
+ * LCD_init
+ *
+ * Release the I2C pins and start the reset sequence once the LCD has
+ * powered up. Writes before it has finished are shown after it, so this
+ * comes before the first.
+ *
+ * @param None
+ * @return None
+ */
+void LCD_init(void)
+{
+#if LCD_I2C
+    // Inputs, left to the bus pull-ups, while I2C1 is off
+    LATB &= ~((1u << 8) | (1u << 9));
+    TRISB |= (1u << 8) | (1u << 9);
+    IPC4bits.MI2C1IP = IPL_I2C;
+    memset(lcd_want, ' ', sizeof(lcd_want));
+    lcd_ready = TIMEBASE_deadline(LCD_POWER_UP_MS);
+    lcd_waiting = 1;
+    SCHED_post_at(SCHED_TASK_LCD, lcd_ready);
+#endif
+}
+
+
+/*
+ * LCD_show_time
+ *
+ * Show a time as the terminal does, "MMm:SSs", on row 0.
+ *
+ * @param time The time
+ * @return None
+ */
+void LCD_show_time(bcd_time_t time)
+{
+#if LCD_I2C
+    char s[BCD_RENDER_SIZE];
+
+    BCD_render(time, s);
+    lcd_write_row(0, s);
+#endif
+}
+
+
+/*
+ * LCD_show_text
+ *
+ * Show a note on row 1, or clear it.
+ *
+ * @param text Up to LCD_COLS characters, "" to clear the row
+ * @return None
+ */
+void LCD_show_text(const char *text)
+{
+#if LCD_I2C
+    lcd_write_row(1, text);
+#else
+    (void)text;
+#endif
+}
+
+
+/*
+ * LCD_handle_event
+ *
+ * Runs as the LCD task, posted by writes, by the I2C interrupt as a
+ * transfer ends and by itself for the waits of the reset sequence: once
+ * the bus is free, send the next reset step, or what changed.
+ *
+ * @param None
+ * @return None
+ */
+void LCD_handle_event(void)
+{
+#if LCD_I2C
+    if (lcd_bus != LCD_BUS_IDLE)
+    {
+        // Posted again as the transfer ends
+        return;
+    }
+    if (lcd_count)
+    {
+        lcd_end();
+        if (lcd_nack)
+        {
+            lcd_nacks++;
+            lcd_step = 0;
+            lcd_wait_ms = LCD_RETRY_MS;
+        }
+        // The wait starts once the instruction has reached the LCD
+        if (lcd_wait_ms)
+        {
+            lcd_ready = TIMEBASE_deadline(lcd_wait_ms + 1);
+            lcd_waiting = 1;
+        }
+    }
+    if (lcd_waiting)
+    {
+        if (!TIMEBASE_reached(lcd_ready))
+        {
+            SCHED_post_at(SCHED_TASK_LCD, lcd_ready);
+            return;
+        }
+        lcd_waiting = 0;
+    }
+
+    lcd_wait_ms = 0;
+    if (lcd_step < LCD_RESET_STEPS)
+    {
+        lcd_queue[0] = lcd_reset[lcd_step].op;
+        lcd_count = 1;
+        lcd_text = 0;
+        lcd_phases = lcd_reset[lcd_step].nibble ? 2 : 4;
+        lcd_wait_ms = lcd_reset[lcd_step].ms;
+        if (++lcd_step == LCD_RESET_STEPS)
+        {
+            // Cleared by the reset, with the cursor home
+            memset(lcd_shown, ' ', sizeof(lcd_shown));
+            lcd_cursor = 0;
+        }
+    }
+    else
+    {
+        lcd_diff();
+    }
+    if (lcd_count)
+    {
+        lcd_start();
+    }
+#endif
+}
+
+
+/*
+ * LCD_display_status
+ *
+ * Print the SCL rate, the characters sent to the LCD out of those
+ * written to it and the transfers it did not acknowledge, on their own
+ * line. Prints nothing without the LCD.
+ *
+ * @param None
+ * @return None
+ */
+void LCD_display_status(void)
+{
+#if LCD_I2C
+    char s[72];
+
+    snprintf(s, sizeof(s), "lcd %lu kHz %lu/%lu chars sent %u nack\r\n",
+             (unsigned long)(CLOCK_FCY / (LCD_BRG + 1) / 1000),
+             (unsigned long)lcd_sent, (unsigned long)lcd_written, lcd_nacks);
+    Disp2String(s);
+#endif
+}
+
+
+#if LCD_I2C
+// The start condition, a byte or the stop condition has been sent.
+void ISR _MI2C1Interrupt(void)
+{
+    uint8_t c;
+    PROFILE_ISR_ENTER();
+
+    IFS1bits.MI2C1IF = 0;
+    if (lcd_bus == LCD_BUS_START)
+    {
+        I2C1TRN = LCD_ADDRESS << 1;
+        lcd_bus = LCD_BUS_DATA;
+    }
+    else if (lcd_bus == LCD_BUS_DATA && !I2C1STATbits.ACKSTAT
+             && lcd_next < lcd_count)
+    {
+        // High nibble then low, each with E high and then low
+        c = lcd_queue[lcd_next];
+        I2C1TRN = ((lcd_phase < 2 ? c : c << 4) & 0xF0) | LCD_BACKLIGHT
+                  | (lcd_text && c < LCD_SET_DDRAM ? LCD_RS : 0)
+                  | (lcd_phase & 1 ? 0 : LCD_E);
+        if (++lcd_phase == lcd_phases)
+        {
+            lcd_phase = 0;
+            lcd_next++;
+        }
+    }
+    else if (lcd_bus == LCD_BUS_DATA)
+    {
+        lcd_nack = I2C1STATbits.ACKSTAT;
+        I2C1CONbits.PEN = 1;
+        lcd_bus = LCD_BUS_STOP;
+    }
+    else
+    {
+        lcd_bus = LCD_BUS_IDLE;
+        SCHED_post(SCHED_TASK_LCD);
+    }
+    PROFILE_ISR_EXIT(PROFILE_ISR_I2C);
+}
+#endif
@@ -0,0 +1,62 @@
+/*
+ * File: lcd.h
+ * Author: Andy Smit
+ * Comments: 16x2 character LCD on I2C1, for stations without a terminal.
+ *           An HD44780 module behind a PCF8574 I2C backpack, written from
+ *           a shadow of its screen so only the characters that changed
+ *           are sent. Built in with -DLCD_I2C=1; the UART terminal shows
+ *           the same text either way.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef LCD_H
+#define	LCD_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+#include "bcd.h"
+
+// 1 to drive the LCD. Off by default: with no LCD on the bus every
+// update would be tried, and answered by nobody.
+#ifndef LCD_I2C
+#define LCD_I2C 0
+#endif
+
+#define LCD_COLS 16
+#define LCD_ROWS 2
+
+// 7 bit address of the PCF8574 with A2-A0 open, as the backpacks ship.
+// The PCF8574A's is 0x3F.
+#define LCD_ADDRESS 0x27
+
+// SCL rate. The HD44780 cannot take characters faster than this anyway.
+#define LCD_I2C_HZ 100000UL
+
+// The HD44780 needs 40ms from power up before its first instruction.
+#define LCD_POWER_UP_MS 50
+
+// Time before an LCD that did not acknowledge is tried again from its
+// reset sequence.
+#define LCD_RETRY_MS 1000
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void LCD_init(void);
+
+void LCD_show_time(bcd_time_t time);
+
+void LCD_show_text(const char *text);
+
+void LCD_handle_event(void);
+
+void LCD_display_status(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* LCD_H */
@@ -0,0 +1,193 @@
+/*
+ * File:   led.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * LED engine. The LED is driven from the OC1 pin (RA6) by output compare
+ * 1 in PWM mode, with Timer 2 as the time base. A pattern is a PWM period
+ * and a const table of duty cycles:
+ *
+ *  - A single step pattern runs entirely in hardware. With the 1:256
+ *    prescaler the period can be up to 67s (4.2s on the FRC), so a
+ *    short flash every second is one PWM cycle and needs no interrupts
+ *    at all.
+ *  - A multi step pattern advances one step every few PWM periods from
+ *    the Timer 2 interrupt, which only reloads OC1RS. OC1RS is latched at
+ *    the next period boundary, so steps never glitch.
+ *
+ * Timer 2 and OC1 are powered only while a pattern other than
+ * LED_PATTERN_OFF is running. While the LED is disabled to save power
+ * (see battery.c) none runs, and the pattern last set starts once it is
+ * enabled again.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "led.h"
+#include "power.h"
+#include "clock.h"
+#include "profile.h"
+
+// Timer 2 prescaler selections
+#define LED_TCKPS_1 0b00
+#define LED_TCKPS_8 0b01
+#define LED_TCKPS_256 0b11
+
+// PR2 for a PWM period in ms with a 1:256 or 1:8 prescaler.
+#define LED_PERIOD_256(ms) ((uint16_t)((ms) * (CLOCK_FCY / 1000) / 256) - 1)
+#define LED_PERIOD_8(ms) ((uint16_t)((ms) * (CLOCK_FCY / 1000) / 8) - 1)
+
+// OCM value for PWM mode with the fault pin disabled
+#define LED_OCM_PWM 0b110
+
+typedef struct
+{
+    uint8_t tckps;
+    uint16_t period;
+    // PWM periods each step is held for. Unused for a single step.
+    uint8_t periods_per_step;
+    uint8_t num_steps;
+    // Duty cycle of each step in 1/256 of the period.
+    const uint8_t *steps;
+} led_pattern_t;
+
+// 1 Hz flash of about 30 ms.
+static const uint8_t led_steps_countdown[] = {8};
+// Slow breathing at a low level, 100 Hz PWM and 100 ms per step.
+static const uint8_t led_steps_paused[] = {
+    0, 1, 2, 4, 6, 9, 13, 18, 24, 18, 13, 9, 6, 4, 2, 1
+};
+// 4 Hz strobe of about 47 ms, a fifth of the current of the LED held on.
+static const uint8_t led_steps_alarm[] = {48};
+
+static const led_pattern_t led_patterns[LED_NUM_PATTERNS] = {
+    [LED_PATTERN_OFF] = {0, 0, 0, 0, NULL},
+    [LED_PATTERN_COUNTDOWN] = {LED_TCKPS_256, LED_PERIOD_256(1000), 1,
+                               sizeof(led_steps_countdown), led_steps_countdown},
+    [LED_PATTERN_PAUSED] = {LED_TCKPS_8, LED_PERIOD_8(10), 10,
+                            sizeof(led_steps_paused), led_steps_paused},
+    [LED_PATTERN_ALARM] = {LED_TCKPS_256, LED_PERIOD_256(250), 1,
+                           sizeof(led_steps_alarm), led_steps_alarm},
+};
+
+static const led_pattern_t *led_pattern = &led_patterns[LED_PATTERN_OFF];
+static led_pattern_id_t led_requested = LED_PATTERN_OFF;
+static uint8_t led_enabled = 1;
+static uint8_t led_step = 0;
+static uint8_t led_period_count = 0;
+
+
+// OC1RS for a step of the current pattern. A macro and a single MUL so
+// the ISR makes no calls.
+#define LED_DUTY(step) \
+    ((uint16_t)(__builtin_muluu(led_pattern->period + 1, \
+                                led_pattern->steps[step]) >> 8))
+
+
+/*
+ * led_run
+ *
+ * Switch the hardware to a pattern, starting from its first step.
+ * Switching to the pattern that is already running does not restart it.
+ */
+static void led_run(led_pattern_id_t id)
+{
+    const led_pattern_t *pattern = &led_patterns[id];
+    if (pattern == led_pattern)
+    {
+        return;
+    }
+
+    if (led_pattern->num_steps)
+    {
+        IEC0bits.T2IE = 0;
+        T2CONbits.TON = 0;
+        OC1CON = 0;
+    }
+    else
+    {
+        POWER_acquire(POWER_TIMER2);
+        POWER_acquire(POWER_OC1);
+    }
+    led_pattern = pattern;
+    led_step = 0;
+    led_period_count = 0;
+
+    if (!pattern->num_steps)
+    {
+        POWER_release(POWER_OC1);
+        POWER_release(POWER_TIMER2);
+        TRISAbits.TRISA6 = 0;
+        LATAbits.LATA6 = 0;
+        return;
+    }
+
+    T2CON = 0; // Internal clock, 16 bit, continue in idle
+    T2CONbits.TCKPS = pattern->tckps;
+    TMR2 = 0;
+    PR2 = pattern->period;
+    OC1R = LED_DUTY(0);
+    OC1RS = OC1R;
+    OC1CONbits.OCTSEL = 0; // Timer 2 time base
+    OC1CONbits.OCM = LED_OCM_PWM;
+
+    // Only multi step patterns need the CPU
+    IPC1bits.T2IP = IPL_LED;
+    IFS0bits.T2IF = 0;
+    IEC0bits.T2IE = pattern->num_steps > 1;
+    T2CONbits.TON = 1;
+}
+
+
+/*
+ * LED_set_pattern
+ *
+ * Switch the LED to a pattern, starting from its first step. Setting the
+ * pattern that is already running does not restart it. While the LED is
+ * disabled the pattern is only remembered.
+ *
+ * @param id The pattern
+ * @return None
+ */
+void LED_set_pattern(led_pattern_id_t id)
+{
+    led_requested = id;
+    led_run(led_enabled ? id : LED_PATTERN_OFF);
+}
+
+
+/*
+ * LED_enable
+ *
+ * Turn the LED off whatever the pattern, or back on with the pattern
+ * last set.
+ *
+ * @param enable 0 to turn the LED off, 1 to turn it back on
+ * @return None
+ */
+void LED_enable(uint8_t enable)
+{
+    led_enabled = enable;
+    led_run(enable ? led_requested : LED_PATTERN_OFF);
+}
+
+
+void ISR _T2Interrupt(void)
+{
+    PROFILE_ISR_ENTER();
+
+    IFS0bits.T2IF = 0;
+    if (++led_period_count < led_pattern->periods_per_step)
+    {
+        PROFILE_ISR_EXIT(PROFILE_ISR_LED);
+        return;
+    }
+    led_period_count = 0;
+    if (++led_step >= led_pattern->num_steps)
+    {
+        led_step = 0;
+    }
+    OC1RS = LED_DUTY(led_step);
+    PROFILE_ISR_EXIT(PROFILE_ISR_LED);
+}
@@ -0,0 +1,37 @@
+/*
+ * File: led.h
+ * Author: Andy Smit
+ * Comments: LED patterns run by output compare 1 in PWM mode.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef LED_H
+#define	LED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+typedef enum
+{
+    LED_PATTERN_OFF = 0,
+    LED_PATTERN_COUNTDOWN,
+    LED_PATTERN_PAUSED,
+    LED_PATTERN_ALARM,
+    LED_NUM_PATTERNS
+} led_pattern_id_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void LED_set_pattern(led_pattern_id_t id);
+
+void LED_enable(uint8_t enable);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* LED_H */
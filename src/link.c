@@ -0,0 +1,571 @@
+/*
+ * File:   link.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Control of the UART2 console link by a test fixture or gateway. The
+ * link starts at UART2_DEFAULT_BAUD. Commands are a line ending in CR or
+ * LF; each is answered with a line:
+ *
+ *   B          "B <rate>", the highest rate the current clock supports
+ *   B<rate>    step up (or down) to <rate>, see below
+ *   S          status dump, including the stack high-water mark, the
+ *              battery, the 7-segment display's CPU load since the
+ *              last dump and the characters the LCD was sent
+ *   T          task statistics, a line per task: runs, overruns,
+ *              merged posts, worst latency and run time in us
+ *   X          transmit statistics: "uart <ms>", the time they cover,
+ *              then a line per stream (see UART2.h): bytes, ms spent
+ *              waiting for room in the queue, writes that found it
+ *              full, refresh bytes dropped and the most bytes queued
+ *   X0         clear the transmit statistics; answered "OK"
+ *   P          profile, in a PROFILE build: "profile <ms> <Fcy>", the
+ *              time it covers and the instruction clock, then a line
+ *              per function: calls, total and longest cycles, and a
+ *              line per ISR: calls and longest cycles of its body
+ *   P0         clear the profile; answered "OK"
+ *   K          benchmarks, in a PROFILE build and during time entry:
+ *              "bench <Fcy> <kernels>", then a line per kernel: its
+ *              name, runs and cycles per call (see bench.c), once the
+ *              suite has run; "ERR" in any other state
+ *   L, L0      lead, or stop leading, the countdown of other units on
+ *              the link (see sync.c); answered "OK"
+ *   @...       sync message from a leader, not answered
+ *
+ * The dumps of S, T, X and P are written a line per run of the link task,
+ * each once the line before it has been sent, so no run waits for room
+ * in the transmit queue and the countdown and the alarm are not held up
+ * behind a dump. Commands received meanwhile wait for the dump to end.
+ *
+ * A SYNC_MARK always starts a new line. A unit following a leader takes
+ * only sync messages: its RX is the leader's TX, so every other line is
+ * the leader's display or its answers to its own console.
+ *
+ * A step up is answered "OK" at the old rate. The unit then switches and
+ * waits for the sync character 0x55 at the new rate, which it measures
+ * with auto-baud. If the measurement matches it answers "OK" at the new
+ * rate; otherwise it goes back to the old rate and answers "ERR".
+ *
+ * LINK_MAX_ERRORS framing or overrun errors with no good command in
+ * between drop the link back to UART2_DEFAULT_BAUD with auto-baud armed,
+ * so a peer that has lost the unit sends 0x55 at any rate to get it back.
+ * A sync character is ignored anywhere else. A follower never falls back.
+ */
+
+#include <xc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "main.h"
+#include "link.h"
+#include "app.h"
+#include "boot.h"
+#include "UART2.h"
+#include "stack.h"
+#include "sched.h"
+#include "timebase.h"
+#include "clock.h"
+#include "sync.h"
+#include "battery.h"
+#include "display.h"
+#include "lcd.h"
+#include "profile.h"
+#include "bench.h"
+
+// Long enough for the longest sync message
+#define LINK_LINE_SIZE 32
+
+typedef enum
+{
+    LINK_IDLE,
+    // Stepped to a new rate, waiting for the peer's sync.
+    LINK_CONFIRM,
+    // Fallen back after errors, waiting for the peer's sync.
+    LINK_RESYNC
+} link_state_t;
+
+// Rates offered to the peer, lowest first. Only those the instruction
+// clock reaches within UART2_BAUD_TOLERANCE_PCT are accepted: up to
+// 62500 on the LPFRC and 500000 on the FRC.
+static const uint32_t link_rates[] = {
+    4800, 9600, 19200, 38400, 57600, 62500, 115200, 125000, 250000, 500000
+};
+#define LINK_NUM_RATES (sizeof(link_rates) / sizeof(link_rates[0]))
+
+static link_state_t link_state = LINK_IDLE;
+static uint32_t link_prev_baud;
+static uint32_t link_request_baud;
+static uint8_t link_errors = 0;
+static char link_line[LINK_LINE_SIZE];
+static uint8_t link_len = 0;
+// The dump being written, NULL for none, and its next line. A dump
+// writes one of its lines, and returns 0 once past the last.
+static uint8_t (*link_dump)(uint8_t line) = NULL;
+static uint8_t link_dump_line;
+
+
+/*
+ * link_nearest_rate
+ *
+ * The offered rate within tolerance of a measured rate, or the measured
+ * rate itself if there is none.
+ */
+static uint32_t link_nearest_rate(uint32_t measured)
+{
+    uint8_t i;
+    for (i = 0; i < LINK_NUM_RATES; i++)
+    {
+        uint32_t rate = link_rates[i];
+        uint32_t diff = measured > rate ? measured - rate : rate - measured;
+        if (diff * 100 <= rate * UART2_BAUD_TOLERANCE_PCT)
+        {
+            return rate;
+        }
+    }
+    return measured;
+}
+
+
+static void link_reply_rate(const char *prefix, uint32_t baud)
+{
+    char s[20];
+    snprintf(s, sizeof(s), "%s %lu\r\n", prefix, (unsigned long)baud);
+    Disp2String(s);
+}
+
+
+static uint8_t link_status(uint8_t line)
+{
+    char s[48];
+    uint8_t i;
+
+    switch (line)
+    {
+        case 0:
+        {
+            Disp2String("\r\n");
+            APP_display_status();
+            break;
+        }
+        case 1:
+        {
+            link_reply_rate("link", UART2_get_baud());
+            break;
+        }
+        case 2:
+        {
+            snprintf(s, sizeof(s), "stack %u/%u\r\n", STACK_high_water(),
+                     STACK_size());
+            Disp2String(s);
+            break;
+        }
+        case 3:
+        {
+            Disp2String("boot us");
+            for (i = 0; i < BOOT_NUM_STAGES; i++)
+            {
+                snprintf(s, sizeof(s), " %lu",
+                         (unsigned long)boot_ticks[i] * BOOT_TICK_US);
+                Disp2String(s);
+            }
+            Disp2String("\r\n");
+            break;
+        }
+        case 4:
+        {
+            SYNC_display_status();
+            break;
+        }
+        case 5:
+        {
+            BATTERY_display_status();
+            break;
+        }
+        case 6:
+        {
+            DISPLAY_display_status();
+            break;
+        }
+        case 7:
+        {
+            LCD_display_status();
+            break;
+        }
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+
+static uint8_t link_task_stats(uint8_t line)
+{
+    char s[64];
+    const sched_stats_t *stats;
+
+    if (line == 0)
+    {
+        Disp2String("\r\n");
+    }
+    if (line >= SCHED_NUM_TASKS)
+    {
+        return 0;
+    }
+    stats = SCHED_get_stats(line);
+    snprintf(s, sizeof(s), "%s %u %u %u %lu %lu\r\n",
+             SCHED_task_name(line), stats->runs, stats->overruns,
+             stats->merged,
+             (unsigned long)stats->max_latency * TIMEBASE_TICK_US,
+             (unsigned long)stats->max_run * TIMEBASE_TICK_US);
+    Disp2String(s);
+    return 1;
+}
+
+
+/*
+ * link_ticks_to_ms
+ *
+ * Timebase ticks to milliseconds, for spans of any length.
+ */
+static uint32_t link_ticks_to_ms(uint32_t ticks)
+{
+    return ticks / 1000 * TIMEBASE_TICK_US
+           + ticks % 1000 * TIMEBASE_TICK_US / 1000;
+}
+
+
+static uint8_t link_uart_stats(uint8_t line)
+{
+    char s[48];
+    const uart2_stats_t *stats;
+
+    if (line == 0)
+    {
+        Disp2String("\r\n");
+        snprintf(s, sizeof(s), "uart %lu\r\n",
+                 (unsigned long)link_ticks_to_ms(
+                     TIMEBASE_elapsed(UART2_stats_since())));
+        Disp2String(s);
+        return 1;
+    }
+    if (line > UART2_NUM_STREAMS)
+    {
+        return 0;
+    }
+    stats = UART2_get_stats(line - 1);
+    snprintf(s, sizeof(s), "%s %lu %lu %u %u %u\r\n",
+             UART2_stream_name(line - 1), (unsigned long)stats->bytes,
+             (unsigned long)link_ticks_to_ms(stats->blocked),
+             stats->full, stats->dropped, stats->max_queued);
+    Disp2String(s);
+    return 1;
+}
+
+
+#if PROFILE
+static uint8_t link_profile(uint8_t line)
+{
+    char s[64];
+    profile_stats_t stats;
+
+    if (line == 0)
+    {
+        Disp2String("\r\n");
+        snprintf(s, sizeof(s), "profile %lu %lu\r\n",
+                 (unsigned long)link_ticks_to_ms(
+                     TIMEBASE_elapsed(PROFILE_since())),
+                 (unsigned long)CLOCK_get_fcy());
+        Disp2String(s);
+        return 1;
+    }
+    if (line > PROFILE_NUM_FUNCS + PROFILE_NUM_ISRS)
+    {
+        return 0;
+    }
+    if (line > PROFILE_NUM_FUNCS)
+    {
+        profile_isr_t isr = line - PROFILE_NUM_FUNCS - 1;
+        profile_isr_stats_t isr_stats = PROFILE_get_isr_stats(isr);
+        snprintf(s, sizeof(s), "%s %u %u\r\n", PROFILE_isr_name(isr),
+                 isr_stats.calls, isr_stats.max);
+        Disp2String(s);
+        return 1;
+    }
+    // Copied first: the lines printed are profiled calls too.
+    stats = *PROFILE_get_stats(line - 1);
+    snprintf(s, sizeof(s), "%s %lu %lu %lu\r\n",
+             PROFILE_func_name(line - 1), (unsigned long)stats.calls,
+             (unsigned long)stats.total, (unsigned long)stats.max);
+    Disp2String(s);
+    return 1;
+}
+#endif
+
+
+/*
+ * link_dump_step
+ *
+ * Write the next line of the dump in progress, once the console output
+ * before it has been sent, and look again after LINK_POLL_MS until the
+ * dump is past its last line.
+ *
+ * @return 1 once the dump is done, otherwise 0
+ */
+static uint8_t link_dump_step(void)
+{
+    if (UART2_is_idle())
+    {
+        if (!link_dump(link_dump_line))
+        {
+            link_dump = NULL;
+            return 1;
+        }
+        link_dump_line++;
+    }
+    SCHED_post_at(SCHED_TASK_LINK, TIMEBASE_deadline(LINK_POLL_MS));
+    return 0;
+}
+
+
+/*
+ * link_dump_start
+ *
+ * Start a dump, from its first line.
+ */
+static void link_dump_start(uint8_t (*dump)(uint8_t line))
+{
+    link_dump = dump;
+    link_dump_line = 0;
+    link_dump_step();
+}
+
+
+/*
+ * link_step
+ *
+ * Answer a step request and switch to the new rate to wait for the
+ * peer's sync.
+ */
+static void link_step(uint32_t baud)
+{
+    uint8_t i;
+    for (i = 0; i < LINK_NUM_RATES; i++)
+    {
+        if (link_rates[i] == baud && UART2_baud_ok(baud))
+        {
+            break;
+        }
+    }
+    if (i == LINK_NUM_RATES)
+    {
+        Disp2String("ERR\r\n");
+        return;
+    }
+    // Sent in full at the old rate before the switch
+    Disp2String("OK\r\n");
+    link_prev_baud = UART2_get_baud();
+    link_request_baud = baud;
+    UART2_set_baud(baud);
+    UART2_autobaud();
+    link_state = LINK_CONFIRM;
+}
+
+
+static void link_command(void)
+{
+    link_line[link_len] = '\0';
+    if (SYNC_get_role() == SYNC_FOLLOWER && link_line[0] != SYNC_MARK)
+    {
+        return;
+    }
+    switch (link_line[0])
+    {
+        case 'B':
+        {
+            if (link_len == 1)
+            {
+                uint8_t i = LINK_NUM_RATES;
+                while (i > 1 && !UART2_baud_ok(link_rates[i - 1]))
+                {
+                    i--;
+                }
+                link_reply_rate("B", link_rates[i - 1]);
+            }
+            else
+            {
+                link_step(strtoul(&link_line[1], NULL, 10));
+            }
+            break;
+        }
+        case 'S':
+        {
+            link_dump_start(link_status);
+            break;
+        }
+        case 'T':
+        {
+            link_dump_start(link_task_stats);
+            break;
+        }
+        case 'X':
+        {
+            if (link_line[1] == '0')
+            {
+                UART2_clear_stats();
+                Disp2String("OK\r\n");
+            }
+            else
+            {
+                link_dump_start(link_uart_stats);
+            }
+            break;
+        }
+#if PROFILE
+        case 'P':
+        {
+            if (link_line[1] == '0')
+            {
+                PROFILE_clear();
+                Disp2String("OK\r\n");
+            }
+            else
+            {
+                link_dump_start(link_profile);
+            }
+            break;
+        }
+        case 'K':
+        {
+            if (!BENCH_start())
+            {
+                Disp2String("ERR\r\n");
+            }
+            break;
+        }
+#endif
+        case 'L':
+        {
+            SYNC_lead(link_line[1] != '0');
+            Disp2String("OK\r\n");
+            break;
+        }
+        case SYNC_MARK:
+        {
+            SYNC_receive(link_line, link_len);
+            break;
+        }
+        default:
+        {
+            Disp2String("ERR\r\n");
+            break;
+        }
+    }
+}
+
+
+/*
+ * link_synced
+ *
+ * The peer's sync has been measured.
+ */
+static void link_synced(void)
+{
+    uint32_t measured = UART2_get_baud();
+    uint32_t rate = link_nearest_rate(measured);
+
+    if (link_state == LINK_CONFIRM)
+    {
+        if (rate == link_request_baud)
+        {
+            UART2_set_baud(rate);
+            Disp2String("OK\r\n");
+        }
+        else
+        {
+            UART2_set_baud(link_prev_baud);
+            Disp2String("ERR\r\n");
+        }
+    }
+    else
+    {
+        // Keep the measured divider for a rate that is not offered
+        if (rate != measured)
+        {
+            UART2_set_baud(rate);
+        }
+        Disp2String("OK\r\n");
+    }
+    link_state = LINK_IDLE;
+    link_errors = 0;
+    link_len = 0;
+}
+
+
+/*
+ * LINK_handle_rx_event
+ *
+ * Process received characters, auto-baud results and receive errors,
+ * and write the dump in progress. Runs as the link task on each receive
+ * interrupt (see sched.c), and every LINK_POLL_MS while a dump is
+ * written.
+ *
+ * @param None
+ * @return None
+ */
+void LINK_handle_rx_event(void)
+{
+    uint8_t c;
+
+    if (UART2_take_sync())
+    {
+        link_synced();
+    }
+
+    // A follower's rate is its own; the leader never sends a sync
+    // character, and characters lost while a long task runs are mostly
+    // the leader's display.
+    link_errors += UART2_take_errors();
+    if (SYNC_get_role() == SYNC_FOLLOWER)
+    {
+        link_errors = 0;
+    }
+    if (link_errors >= LINK_MAX_ERRORS && link_state == LINK_IDLE)
+    {
+        UART2_set_baud(UART2_DEFAULT_BAUD);
+        UART2_autobaud();
+        link_state = LINK_RESYNC;
+        link_errors = 0;
+        link_len = 0;
+    }
+
+    // Received characters wait in the receive ring while a dump is
+    // written
+    if (link_dump != NULL && !link_dump_step())
+    {
+        return;
+    }
+    while (link_dump == NULL && UART2_read(&c))
+    {
+        if (link_state != LINK_IDLE || c == LINK_SYNC)
+        {
+            continue;
+        }
+        if (c == SYNC_MARK)
+        {
+            link_len = 0;
+        }
+        if (c == '\r' || c == '\n')
+        {
+            if (link_len)
+            {
+                link_command();
+                link_errors = 0;
+                link_len = 0;
+            }
+        }
+        else if (link_len < LINK_LINE_SIZE - 1)
+        {
+            link_line[link_len++] = c;
+        }
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * File: link.h
+ * Author: Andy Smit
+ * Comments: Serial link control on the UART2 console: auto-baud, baud
+ *           rate negotiation with fallback, and the status dump.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef LINK_H
+#define	LINK_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// Sync character for auto-baud
+#define LINK_SYNC 0x55
+
+// Receive errors tolerated before the link falls back and resyncs.
+#define LINK_MAX_ERRORS 3
+
+// Time between looks at the console while a dump waits for its last
+// line to be sent
+#define LINK_POLL_MS 10
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void LINK_handle_rx_event(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* LINK_H */
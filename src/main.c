@@ -10,101 +10,64 @@
 #include "main.h"
 #include "app.h"
 #include "io.h"
-#include "timer.h"
+#include "timebase.h"
+#include "sched.h"
 #include "UART2.h"
+#include "eeprom.h"
+#include "boot.h"
+#include "power.h"
+#include "clock.h"
+#include "link.h"
+#include "stack.h"
+#include "calib.h"
+#include "sync.h"
+#include "battery.h"
+#include "lcd.h"
+#include "profile.h"
+#include "bench.h"
+
+// Configuration bits come from the board descriptor
+#define BOARD_CONFIG_BITS
+#include "board.h"
 
-#ifdef ANDY_HARDWARE
-// CLOCK CONTROL
-#pragma config IESO = OFF    // 2 Speed Startup disabled
-#pragma config FNOSC = LPFRC//FRC  // Start up CLK = 31 KHz
-#pragma config FCKSM = CSECMD // Clock switching is enabled, clock monitor disabled
-#pragma config SOSCSEL = SOSCLP // Secondary oscillator for Low Power Operation
-#pragma config POSCFREQ = MS  //Primary Oscillator/External clk freq betwn 100kHz and 8 MHz. Options: LS, MS, HS
-#pragma config OSCIOFNC = ON  //CLKO output disabled on pin 8, use as IO.
-#pragma config POSCMOD = NONE  // Primary oscillator mode is disabled
-
-// Set the PGx3 port as the programmer
-#pragma config ICS = PGx3
-#endif
-
-#ifndef ANDY_HARDWARE
-//// CONFIGURATION BITS - PRE-PROCESSOR DIRECTIVES ////
-
-// Code protection
-#pragma config BSS = OFF // Boot segment code protect disabled
-#pragma config BWRP = OFF // Boot sengment flash write protection off
-#pragma config GCP = OFF // general segment code protecion off
-#pragma config GWRP = OFF
-
-// CLOCK CONTROL
-#pragma config IESO = OFF    // 2 Speed Startup disabled
-#pragma config FNOSC = LPFRC//FRC  // Start up CLK = 31 KHz
-#pragma config FCKSM = CSECMD // Clock switching is enabled, clock monitor disabled
-#pragma config SOSCSEL = SOSCLP // Secondary oscillator for Low Power Operation
-#pragma config POSCFREQ = HS  //Primary Oscillator/External clk freq betwn 100kHz and 8 MHz. Options: LS, MS, HS
-#pragma config OSCIOFNC = ON  //CLKO output disabled on pin 8, use as IO.
-#pragma config POSCMOD = NONE  // Primary oscillator mode is disabled
-
-// WDT
-#pragma config FWDTEN = OFF // WDT is off
-#pragma config WINDIS = OFF // STANDARD WDT/. Applicable if WDT is on
-#pragma config FWPSA = PR32 // WDT is selected uses prescaler of 32
-#pragma config WDTPS = PS1 // WDT postscler is 1 if WDT selected
-
-//MCLR/RA5 CONTROL
-#pragma config MCLRE = OFF // RA5 pin configured as input, MCLR reset on RA5 diabled
-
-//BOR  - FPOR Register
-#pragma config BORV = LPBOR // LPBOR value=2V is BOR enabled
-#pragma config BOREN = BOR0 // BOR controlled using SBOREN bit
-#pragma config PWRTEN = OFF // Powerup timer disabled
-#pragma config I2C1SEL = PRI // Default location for SCL1/SDA1 pin
-
-//JTAG FICD Register
-#pragma config BKBUG = OFF // Background Debugger functions disabled
-#pragma config ICS = PGx2 // PGC2 (pin2) & PGD2 (pin3) are used to connect PICKIT3 debugger
-
-// Deep Sleep RTCC WDT
-#pragma config DSWDTEN = OFF // Deep Sleep WDT is disabled
-#pragma config DSBOREN = OFF // Deep Sleep BOR is disabled
-#pragma config RTCOSC = LPRC// RTCC uses LPRC 32kHz for clock
-#pragma config DSWDTOSC = LPRC // DeepSleep WDT uses Lo Power RC clk
-#pragma config DSWDTPS = DSWDTPS7 // DSWDT postscaler set to 32768
-
-#endif
-
-interrupt_State interrupt_state = {0};
 App_State app_state = STATE_ENTER_TIME;
 
 int main(void)
 {
-    // Disable Nested Interrupts
+    STACK_paint();
+    CLOCK_init();
+    TIMEBASE_init();
+    // Before the first profiled call
+    PROFILE_init();
+
+    // Enable nested interrupts. Priorities are listed in main.h.
     INTCON1bits.NSTDIS = 0;
 
-    // Initialize settings for timer, IO, and UART.
+    // Essential phase: everything needed to respond to a button.
     IO_init();
-    timer_init();
-    InitUART2();
-
-    APP_state_enter_time_init();
-    while(1)
-    {
-        // Handle non app interrupts
-        if(interrupt_state.cn_trig)
-        {
-            interrupt_state.cn_trig = 0;
-            IO_handle_button_event();
-            // uint8_t buttons = io_get_buttons();
-        }
-        if(interrupt_state.timer2_trig)
-        {
-            interrupt_state.timer2_trig = 0;
-            timer_stop(TIMER2);
-        }
-        APP_state_machine_main();
+    // Power down every peripheral that has not been acquired. Drivers
+    // power up what they need as they start.
+    POWER_init();
+    BOOT_mark(BOOT_STAGE_IO);
+    EEPROM_init();
+    BOOT_mark(BOOT_STAGE_EEPROM);
+    APP_init();
+    BOOT_mark(BOOT_STAGE_READY);
+
+    // Deferred phase. The UART is brought up by its first output.
+    LCD_init();
+    APP_display_boot();
+    UART2_flush();
+    BOOT_mark(BOOT_STAGE_DISPLAY);
+    CALIB_init();
+    SYNC_init();
+    BATTERY_init();
+#if BENCH_BOOT
+    BENCH_start();
+#endif
 
-        // Wait for interrupt to trigger next iteration of main loop
-        Idle();
-    }
+    // Everything from here on runs as a task posted by an ISR or
+    // released by the timebase (see sched.c).
+    SCHED_run();
     return 0;
 }
@@ -15,24 +15,32 @@
 #include "UART2.h"
 #include <stdio.h>
 
-// Configuration macro for different hardware IO setup.
-#define ANDY_HARDWARE
+// The hardware IO setup is selected in board.h.
 #define DEBUG 0
 
 #if DEBUG
+// Written straight to the UART rather than formatted into a buffer: the
+// macros are used in ISRs, which share the stack with everything else.
+// Counted in the debug stream of the UART statistics.
 #define debug_print(x) do\
 {\
-    char s[100];\
-    snprintf(s, 100, "%s %d: %s\n\r", __func__, __LINE__, x);\
-    Disp2String(s);\
+    uart2_stream_t debug_prev_ = UART2_select(UART2_STREAM_DEBUG);\
+    Disp2String((char *)__func__);\
+    Disp2Dec(__LINE__);\
+    Disp2String(x);\
+    Disp2String("\n\r");\
+    UART2_select(debug_prev_);\
 } while(0)
 
 #define debug_hex(x)\
 do\
 {\
-    char s[100];\
-    snprintf(s, 100, "%s %d: 0x%x\n\r", __func__, __LINE__, x);\
-    Disp2String(s);\
+    uart2_stream_t debug_prev_ = UART2_select(UART2_STREAM_DEBUG);\
+    Disp2String((char *)__func__);\
+    Disp2Dec(__LINE__);\
+    Disp2Hex(x);\
+    Disp2String("\n\r");\
+    UART2_select(debug_prev_);\
 } while(0)
 #else
 #define debug_print(x) do{}while(0)
@@ -47,18 +55,75 @@ typedef enum state
     STATE_TIMER_FINISH
 } App_State;
 
-// Datatype to hold the current interrupt states
-typedef struct
-{
-        uint8_t cn_trig:1;
-        uint8_t timer1_trig:1;
-        uint8_t timer2_trig:1;
-        uint8_t timer3_trig:1;
-        uint8_t :4;
-} interrupt_State;
+// Interrupt priorities. Nesting is enabled, so an ISR can be preempted by
+// any ISR of a higher priority. Worst-case entry latency of each ISR, in
+// instruction cycles:
+//
+//   _T1Interrupt          IPL 6  C6
+//   _RTCCInterrupt        IPL 5  C5 + T1
+//   _U2RXInterrupt        IPL 4  C4 + T1 + RTCC
+//   _CNInterrupt          IPL 3  C3 + T1 + RTCC + U2RX + U2TX
+//   _U2TXInterrupt        IPL 3  C3 + T1 + RTCC + U2RX + CN
+//   _NVMInterrupt         IPL 2  C2 + T1 + RTCC + U2RX + CN + U2TX
+//                                + the longer of HLVD and ADC1
+//   _HLVDInterrupt        IPL 2  as _NVMInterrupt, with NVM and ADC1
+//   _ADC1Interrupt        IPL 2  as _NVMInterrupt, with NVM and HLVD
+//   _T2Interrupt (LED)    IPL 1  everything above; a late LED step only
+//                                delays the step by one PWM period
+//   _T3Interrupt (display) IPL 1 as _T2Interrupt; a late refresh only
+//                                lights one digit a little longer
+//   _MI2C1Interrupt (LCD) IPL 1  as _T2Interrupt; the I2C master holds
+//                                the bus until the next byte is written
+//   _T3Interrupt (profiler) IPL 1 as _T2Interrupt; a late wrap is still
+//                                counted, as long as it is no later than
+//                                half a Timer 3 period
+//
+// Cn is the longest critical section at IPL n or above. Each ISR named
+// stands for its longest body, as "P" prints it in a PROFILE build (see
+// profile.c), plus the cost of taking it: 5 cycles to the vector, a cycle
+// a register its prologue saves and one to restore it, and 3 for RETFIE.
+// An ISR at the same IPL is one already running, which finishes first.
+// Each ISR is counted once, as none comes round again within another's
+// latency. The simulator counts no cycles: the bodies can only be
+// measured on a unit, at each clock.
+//
+// Every ISR body is a flag clear and a task post (see sched.c), except
+// the LED step which reloads OC1RS, the display refresh which writes
+// PORTB, the LCD's I2C master which sends the next byte of a transfer,
+// the change notification which queues the buttons with the time they
+// changed, the UART receive which empties the 4 character FIFO, the UART
+// transmit which refills it from the transmit queue, the RTCC which
+// stamps the second for the clock calibration and the timebase, which
+// adds the period that ended and leaves the release of the timed tasks
+// to the main loop. A post masks up to IPL_TIMER for the few
+// instructions that stamp the task. Critical sections at IPL 7 are
+// limited to the few instructions around Idle() in the scheduler, so no
+// ISR waits on application code.
+#define IPL_TIMER 6
+#define IPL_RTCC 5
+#define IPL_UART_RX 4
+#define IPL_CN 3
+#define IPL_UART_TX 3
+#define IPL_NVM 2
+#define IPL_HLVD 2
+#define IPL_ADC 2
+#define IPL_LED 1
+#define IPL_DISPLAY 1
+#define IPL_I2C 1
+#define IPL_PROFILE 1
+
+// ISR attributes. The timebase ISR is the most frequent at the highest
+// priority, so it alone uses the shadow registers: PUSH.S/POP.S save W0
+// to W3 and SR in one cycle each instead of a push per register. Only
+// one ISR may have them, as a nested second user would overwrite the
+// first's saved registers. Every other ISR is plain and keeps its
+// context save small by making as few calls as it can: a call makes the
+// compiler save all of W0 to W7, and a 32 bit multiply or divide is a
+// call into the runtime library.
+#define ISR_FAST __attribute__((interrupt, shadow, no_auto_psv))
+#define ISR __attribute__((interrupt, no_auto_psv))
 
 // Make state variable global
-extern interrupt_State interrupt_state;
 extern App_State app_state;
 
 
@@ -0,0 +1,217 @@
+/*
+ * File:   pot.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Time entry from a potentiometer, on boards that have one
+ * (BOARD_HAS_POT). While the time is being entered the pot task starts a
+ * burst every POT_PERIOD_MS: the ADC auto-samples and converts the pot's
+ * input POT_SAMPLES times into its buffers on its own clock and then
+ * interrupts, and the task sums the buffers into one reading with two
+ * more bits than a conversion.
+ *
+ * The reading is quantized to POT_LEVELS settings of POT_STEP_S. The
+ * setting only moves once the reading is three quarters of a step from
+ * it, so noise and a wiper resting between two steps cannot make it
+ * flicker, and the countdown is set and shown only when it moves. The
+ * first reading after time entry starts only sets where the pot is: the
+ * time recalled at entry, or set with the buttons, stays until the pot
+ * is turned.
+ *
+ * The ADC is shared with the battery monitor. Each takes it only while
+ * it is powered down, which is when nobody else holds it, and configures
+ * it for itself; a burst that finds it in use is skipped.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "pot.h"
+#include "app.h"
+#include "sched.h"
+#include "timebase.h"
+#include "power.h"
+#include "board.h"
+#include "profile.h"
+
+// Sum of a burst at full scale
+#define POT_FULL_SCALE (POT_SAMPLES * 1023UL)
+
+#if BOARD_HAS_POT
+static uint8_t pot_running = 0;
+// A burst is converting.
+static uint8_t pot_burst = 0;
+// The setting has been read since time entry started.
+static uint8_t pot_known = 0;
+static uint16_t pot_level;
+static uint32_t pot_next;
+#endif
+
+
+/*
+ * POT_start
+ *
+ * Read the pot until time entry ends. Called as time entry starts.
+ *
+ * @param None
+ * @return None
+ */
+void POT_start(void)
+{
+#if BOARD_HAS_POT
+    if (!pot_running)
+    {
+        pot_running = 1;
+        pot_known = 0;
+        IPC3bits.AD1IP = IPL_ADC;
+        SCHED_post(SCHED_TASK_POT);
+    }
+#endif
+}
+
+
+#if BOARD_HAS_POT
+/*
+ * pot_burst_start
+ *
+ * Start a burst of conversions if the ADC is free.
+ *
+ * @return 1 if the burst started, 0 if the ADC is in use
+ */
+static uint8_t pot_burst_start(void)
+{
+    if (!POWER_acquire(POWER_ADC1))
+    {
+        POWER_release(POWER_ADC1);
+        return 0;
+    }
+    AD1CON1 = 0;                // Integer result
+    AD1CON1bits.SSRC = 0b111;   // Convert when sampling ends
+    AD1CON2 = 0;                // AVDD and AVSS references
+    AD1CON2bits.SMPI = POT_SAMPLES - 1;
+    AD1CON3 = 0;
+    AD1CON3bits.ADRC = 1;       // ADC RC clock, at any Fcy
+    AD1CON3bits.SAMC = 15;      // For the pot's source impedance
+    AD1CHS = 0;
+    AD1CHSbits.CH0SA = BOARD_POT_AN;
+    IFS0bits.AD1IF = 0;
+    IEC0bits.AD1IE = 1;
+    AD1CON1bits.ADON = 1;
+    AD1CON1bits.ASAM = 1;
+    return 1;
+}
+
+
+/*
+ * pot_burst_end
+ *
+ * Stop the ADC and power it down.
+ *
+ * @return The sum of the burst's conversions
+ */
+static uint32_t pot_burst_end(void)
+{
+    volatile uint16_t *buf = &ADC1BUF0;
+    uint32_t sum = 0;
+    uint8_t i;
+
+    IEC0bits.AD1IE = 0;
+    AD1CON1bits.ASAM = 0;
+    for (i = 0; i < POT_SAMPLES; i++)
+    {
+        sum += buf[i];
+    }
+    AD1CON1bits.ADON = 0;
+    POWER_release(POWER_ADC1);
+    return sum;
+}
+
+
+/*
+ * pot_quantize
+ *
+ * The setting for a reading, moving from the current one only once the
+ * reading is three quarters of a step away from it.
+ */
+static uint16_t pot_quantize(uint32_t sum)
+{
+    // The reading and the current setting, both in 1/POT_FULL_SCALE
+    // of a step
+    uint32_t at = sum * (POT_LEVELS - 1);
+    uint32_t level = (uint32_t)pot_level * POT_FULL_SCALE;
+    uint32_t away = at > level ? at - level : level - at;
+
+    if (pot_known && away <= POT_FULL_SCALE * 3 / 4)
+    {
+        return pot_level;
+    }
+    return (at + POT_FULL_SCALE / 2) / POT_FULL_SCALE;
+}
+#endif
+
+
+/*
+ * POT_handle_event
+ *
+ * Runs as the pot task: start a burst, and read it once the ADC
+ * interrupts. Posted by POT_start, the ADC ISR and itself, and stops
+ * once time entry has ended.
+ *
+ * @param None
+ * @return None
+ */
+void POT_handle_event(void)
+{
+#if BOARD_HAS_POT
+    uint16_t level;
+
+    if (app_state != STATE_ENTER_TIME)
+    {
+        if (pot_burst)
+        {
+            pot_burst_end();
+            pot_burst = 0;
+        }
+        SCHED_cancel(SCHED_TASK_POT);
+        pot_running = 0;
+        return;
+    }
+    if (!pot_burst)
+    {
+        pot_next = SCHED_release_time(SCHED_TASK_POT)
+                   + TIMEBASE_MS_TO_TICKS(POT_PERIOD_MS);
+        pot_burst = pot_burst_start();
+        if (!pot_burst)
+        {
+            SCHED_post_at(SCHED_TASK_POT, pot_next);
+        }
+        return;
+    }
+
+    pot_burst = 0;
+    level = pot_quantize(pot_burst_end());
+    if (pot_known && level != pot_level)
+    {
+        APP_set_time(level * POT_STEP_S);
+    }
+    pot_level = level;
+    pot_known = 1;
+    SCHED_post_at(SCHED_TASK_POT, pot_next);
+#endif
+}
+
+
+#if BOARD_HAS_POT
+// A burst has filled the ADC buffers.
+void ISR _ADC1Interrupt(void)
+{
+    PROFILE_ISR_ENTER();
+
+    IFS0bits.AD1IF = 0;
+    // Stop after the conversion in progress, if any. It lands in
+    // ADC1BUF0 as one more sample of the pot.
+    AD1CON1bits.ASAM = 0;
+    SCHED_post(SCHED_TASK_POT);
+    PROFILE_ISR_EXIT(PROFILE_ISR_ADC);
+}
+#endif
@@ -0,0 +1,41 @@
+/*
+ * File: pot.h
+ * Author: Andy Smit
+ * Comments: Time entry from a potentiometer on an analog pin, read in
+ *           oversampled bursts by the ADC in the background.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef POT_H
+#define	POT_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// Time between bursts while the time is being entered.
+#define POT_PERIOD_MS 50
+
+// Conversions summed per reading, and the buffers they fill (AD1CON2
+// SMPI + 1).
+#define POT_SAMPLES 16
+
+// The full turn sets the countdown in POT_LEVELS steps of POT_STEP_S,
+// from 0 to 59m50s.
+#define POT_STEP_S 10
+#define POT_LEVELS 360
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void POT_start(void);
+
+void POT_handle_event(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* POT_H */
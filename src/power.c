@@ -0,0 +1,117 @@
+/*
+ * File:   power.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Reference counted peripheral power. A driver acquires a peripheral
+ * before using it and releases it when done; the peripheral's PMD bit is
+ * set while nobody holds it, which stops its clock and resets its
+ * registers. A driver must therefore configure the peripheral after each
+ * acquire that returns 1.
+ *
+ * Acquire and release are only called from main, never from an ISR.
+ */
+
+#include <xc.h>
+#include "power.h"
+
+typedef struct
+{
+    volatile uint16_t *pmd;
+    uint8_t bit;
+} power_gate_t;
+
+static const power_gate_t power_gates[POWER_NUM_PERIPHERALS] = {
+    [POWER_TIMER1] = {&PMD1, 11},
+    [POWER_TIMER2] = {&PMD1, 12},
+    [POWER_TIMER3] = {&PMD1, 13},
+    [POWER_UART1] = {&PMD1, 5},
+    [POWER_UART2] = {&PMD1, 6},
+    [POWER_SPI1] = {&PMD1, 3},
+    [POWER_I2C1] = {&PMD1, 7},
+    [POWER_ADC1] = {&PMD1, 0},
+    [POWER_IC1] = {&PMD2, 8},
+    [POWER_OC1] = {&PMD2, 0},
+    [POWER_CMP] = {&PMD3, 10},
+    [POWER_RTCC] = {&PMD3, 9},
+    [POWER_CTMU] = {&PMD4, 2},
+    [POWER_HLVD] = {&PMD4, 1},
+    [POWER_REFO] = {&PMD4, 3},
+    [POWER_EEPROM] = {&PMD4, 4},
+};
+
+static uint8_t power_refs[POWER_NUM_PERIPHERALS] = {0};
+
+
+static void power_gate(power_periph_t periph, uint8_t off)
+{
+#if POWER_GATING
+    if (off)
+    {
+        *power_gates[periph].pmd |= 1u << power_gates[periph].bit;
+    }
+    else
+    {
+        *power_gates[periph].pmd &= ~(1u << power_gates[periph].bit);
+    }
+#endif
+}
+
+
+/*
+ * POWER_init
+ *
+ * Gate off every peripheral nobody has acquired yet. Call after IO_init,
+ * which sets the pin modes in the ADC's AD1PCFG register.
+ *
+ * @param None
+ * @return None
+ */
+void POWER_init(void)
+{
+    uint8_t i;
+    for (i = 0; i < POWER_NUM_PERIPHERALS; i++)
+    {
+        if (!power_refs[i])
+        {
+            power_gate(i, 1);
+        }
+    }
+}
+
+
+/*
+ * POWER_acquire
+ *
+ * Take a reference to a peripheral, powering it up if it was off.
+ *
+ * @param periph The peripheral
+ * @return 1 if the peripheral was just powered up and needs configuring
+ */
+uint8_t POWER_acquire(power_periph_t periph)
+{
+    if (power_refs[periph]++)
+    {
+        return 0;
+    }
+    power_gate(periph, 0);
+    return 1;
+}
+
+
+/*
+ * POWER_release
+ *
+ * Drop a reference to a peripheral. The last release powers it off.
+ *
+ * @param periph The peripheral
+ * @return None
+ */
+void POWER_release(power_periph_t periph)
+{
+    if (power_refs[periph] && !--power_refs[periph])
+    {
+        power_gate(periph, 1);
+    }
+}
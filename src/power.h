@@ -0,0 +1,55 @@
+/*
+ * File: power.h
+ * Author: Andy Smit
+ * Comments: Peripheral power gating through the PMD registers.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef POWER_H
+#define	POWER_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// Set to 0 to leave every peripheral powered, for comparing idle current
+// with and without gating on a unit.
+#define POWER_GATING 1
+
+typedef enum
+{
+    POWER_TIMER1 = 0,
+    POWER_TIMER2,
+    POWER_TIMER3,
+    POWER_UART1,
+    POWER_UART2,
+    POWER_SPI1,
+    POWER_I2C1,
+    POWER_ADC1,
+    POWER_IC1,
+    POWER_OC1,
+    POWER_CMP,
+    POWER_RTCC,
+    POWER_CTMU,
+    POWER_HLVD,
+    POWER_REFO,
+    POWER_EEPROM,
+    POWER_NUM_PERIPHERALS
+} power_periph_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void POWER_init(void);
+
+uint8_t POWER_acquire(power_periph_t periph);
+
+void POWER_release(power_periph_t periph);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* POWER_H */
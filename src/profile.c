@@ -0,0 +1,299 @@
+/*
+ * File:   profile.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Function profiler, built in with PROFILE. Timer 3 counts instruction
+ * cycles at 1:1 over its full 16 bits, and its interrupt counts the
+ * wraps, which makes a 32 bit cycle count good for over four hours on
+ * the LPFRC. Each profiled function reads it on entry and on every
+ * return, and the difference, less what reading it costs, is added to
+ * the function's statistics. The link's "P" command prints them.
+ *
+ * The cycles are those from entry to return, so they include whatever
+ * ISRs ran in between, and the calls to other profiled functions. A
+ * dozed CPU runs fewer instructions in them (see battery.c): the count
+ * is of Fcy, not of the instructions run.
+ *
+ * ISRs are timed apart from the functions, body only, by their TMR3
+ * count alone, and only the longest body is kept. What an ISR holds up
+ * beyond that is fixed by the core: 5 cycles to reach the vector, its
+ * prologue and epilogue, a cycle a register saved and restored, and 3
+ * for RETFIE. Their maxima bound the entry latencies in main.h.
+ *
+ * The profiler takes Timer 3 from the 7-segment display, so it cannot be
+ * built for a board that has one.
+ */
+
+#include <xc.h>
+#include <string.h>
+#include "main.h"
+#include "profile.h"
+#include "timebase.h"
+#include "atomic.h"
+#include "power.h"
+#include "board.h"
+
+#if PROFILE && BOARD_HAS_DISPLAY
+#error "The 7-segment display takes Timer 3"
+#endif
+
+#if PROFILE
+static const char *const profile_func_names[PROFILE_NUM_FUNCS] = {
+    [PROFILE_APP_DISPLAY_TIME] = "app_display_time",
+    [PROFILE_BUTTON_EVENT] = "IO_handle_button_event",
+    [PROFILE_SCHED_POST_AT] = "SCHED_post_at",
+    [PROFILE_DISP2STRING] = "Disp2String",
+    [PROFILE_XMITUART2] = "XmitUART2",
+};
+
+static const char *const profile_isr_names[PROFILE_NUM_ISRS] = {
+    [PROFILE_ISR_TIMEBASE] = "_T1Interrupt",
+    [PROFILE_ISR_RTCC] = "_RTCCInterrupt",
+    [PROFILE_ISR_UART_RX] = "_U2RXInterrupt",
+    [PROFILE_ISR_CN] = "_CNInterrupt",
+    [PROFILE_ISR_UART_TX] = "_U2TXInterrupt",
+    [PROFILE_ISR_NVM] = "_NVMInterrupt",
+    [PROFILE_ISR_HLVD] = "_HLVDInterrupt",
+    [PROFILE_ISR_ADC] = "_ADC1Interrupt",
+    [PROFILE_ISR_LED] = "_T2Interrupt",
+    [PROFILE_ISR_I2C] = "_MI2C1Interrupt",
+};
+
+static profile_stats_t profile_stats[PROFILE_NUM_FUNCS];
+volatile profile_isr_stats_t profile_isr_stats[PROFILE_NUM_ISRS];
+static uint32_t profile_stats_start = 0;
+// Timer 3 periods completed, the high half of the cycle count
+static volatile uint16_t profile_wraps = 0;
+// Cycles PROFILE_ENTER and PROFILE_EXIT add to every call, and the ISR
+// hooks to every ISR, measured by PROFILE_init
+static uint32_t profile_overhead = 0;
+uint16_t profile_isr_overhead = 0;
+#endif
+
+
+/*
+ * PROFILE_init
+ *
+ * Start Timer 3 counting cycles, and measure what an empty profiled
+ * call and an empty profiled ISR body cost so they can be taken off.
+ *
+ * @param None
+ * @return None
+ */
+void PROFILE_init(void)
+{
+#if PROFILE
+    uint32_t start;
+
+    POWER_acquire(POWER_TIMER3);
+    T3CON = 0; // Internal clock, 1:1, continue in idle
+    TMR3 = 0;
+    PR3 = 0xFFFF;
+    IPC2bits.T3IP = IPL_PROFILE;
+    IFS0bits.T3IF = 0;
+    IEC0bits.T3IE = 1;
+    T3CONbits.TON = 1;
+
+    start = PROFILE_now();
+    PROFILE_record(PROFILE_APP_DISPLAY_TIME, start);
+    profile_overhead = profile_stats[PROFILE_APP_DISPLAY_TIME].max;
+    {
+        uint16_t ipl;
+        CRITICAL_ENTER(ipl, 7);
+        {
+            PROFILE_ISR_ENTER();
+            PROFILE_ISR_EXIT(PROFILE_ISR_TIMEBASE);
+        }
+        profile_isr_overhead = profile_isr_stats[PROFILE_ISR_TIMEBASE].max;
+        CRITICAL_EXIT(ipl);
+    }
+    PROFILE_clear();
+#endif
+}
+
+
+/*
+ * PROFILE_now
+ *
+ * The cycle count. TMR3 can wrap between reading the wraps and reading
+ * it, before the interrupt counts the wrap; the wraps are read again
+ * until they did not change, and a wrap still pending with TMR3 low
+ * belongs to this read.
+ *
+ * @param None
+ * @return Instruction cycles since PROFILE_init
+ */
+uint32_t PROFILE_now(void)
+{
+#if PROFILE
+    uint16_t hi;
+    uint16_t lo;
+    uint8_t pending;
+
+    do
+    {
+        hi = profile_wraps;
+        lo = TMR3;
+        pending = IFS0bits.T3IF;
+    } while (hi != profile_wraps);
+    if (pending && lo < 0x8000)
+    {
+        hi++;
+    }
+    return ((uint32_t)hi << 16) | lo;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * PROFILE_record
+ *
+ * Add a call to a function's statistics. Used by PROFILE_EXIT.
+ *
+ * @param func The function returning
+ * @param start The cycle count when it was entered
+ * @return None
+ */
+void PROFILE_record(profile_func_t func, uint32_t start)
+{
+#if PROFILE
+    profile_stats_t *stats = &profile_stats[func];
+    uint32_t cycles = PROFILE_now() - start;
+
+    cycles = cycles > profile_overhead ? cycles - profile_overhead : 0;
+    stats->calls++;
+    stats->total += cycles;
+    if (cycles > stats->max)
+    {
+        stats->max = cycles;
+    }
+#endif
+}
+
+
+/*
+ * PROFILE_get_stats
+ *
+ * @param func The function
+ * @return Its statistics since they were last cleared
+ */
+const profile_stats_t *PROFILE_get_stats(profile_func_t func)
+{
+#if PROFILE
+    return &profile_stats[func];
+#else
+    return NULL;
+#endif
+}
+
+
+/*
+ * PROFILE_func_name
+ *
+ * @param func The function
+ * @return Its name, for the console
+ */
+const char *PROFILE_func_name(profile_func_t func)
+{
+#if PROFILE
+    return profile_func_names[func];
+#else
+    return "";
+#endif
+}
+
+
+/*
+ * PROFILE_get_isr_stats
+ *
+ * @param isr The ISR
+ * @return Its statistics since they were last cleared
+ */
+profile_isr_stats_t PROFILE_get_isr_stats(profile_isr_t isr)
+{
+#if PROFILE
+    profile_isr_stats_t stats;
+    uint16_t ipl;
+
+    CRITICAL_ENTER(ipl, 7);
+    stats = profile_isr_stats[isr];
+    CRITICAL_EXIT(ipl);
+    return stats;
+#else
+    profile_isr_stats_t stats = {0, 0};
+    return stats;
+#endif
+}
+
+
+/*
+ * PROFILE_isr_name
+ *
+ * @param isr The ISR
+ * @return Its name, for the console
+ */
+const char *PROFILE_isr_name(profile_isr_t isr)
+{
+#if PROFILE
+    return profile_isr_names[isr];
+#else
+    return "";
+#endif
+}
+
+
+/*
+ * PROFILE_since
+ *
+ * @param None
+ * @return The system time the statistics were last cleared
+ */
+uint32_t PROFILE_since(void)
+{
+#if PROFILE
+    return profile_stats_start;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * PROFILE_clear
+ *
+ * Start the statistics of every function and ISR again from 0.
+ *
+ * @param None
+ * @return None
+ */
+void PROFILE_clear(void)
+{
+#if PROFILE
+    uint16_t ipl;
+    uint8_t i;
+
+    memset(profile_stats, 0, sizeof(profile_stats));
+    CRITICAL_ENTER(ipl, 7);
+    for (i = 0; i < PROFILE_NUM_ISRS; i++)
+    {
+        profile_isr_stats[i].calls = 0;
+        profile_isr_stats[i].max = 0;
+    }
+    CRITICAL_EXIT(ipl);
+    profile_stats_start = TIMEBASE_now();
+#endif
+}
+
+
+#if PROFILE
+// Timer 3 wrapped: the high half of the cycle count goes up.
+void ISR _T3Interrupt(void)
+{
+    IFS0bits.T3IF = 0;
+    profile_wraps++;
+}
+#endif
@@ -0,0 +1,141 @@
+/*
+ * File: profile.h
+ * Author: Andy Smit
+ * Comments: Function profiler: calls, total and longest instruction
+ *           cycles of chosen functions, and the longest body of each
+ *           ISR, timed with Timer 3 and dumped on the console with "P".
+ *           Built in with -DPROFILE=1; otherwise the hooks compile to
+ *           nothing.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef PROFILE_H
+#define	PROFILE_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// 1 to build the profiler in. Never in a release: it takes Timer 3 and
+// adds a few dozen cycles to every profiled call. BENCH_BOOT builds it in,
+// as the benchmarks are timed with it.
+#ifndef PROFILE
+#if defined(BENCH_BOOT) && BENCH_BOOT
+#define PROFILE 1
+#else
+#define PROFILE 0
+#endif
+#endif
+
+// The functions profiled, each with a PROFILE_ENTER at its start and a
+// PROFILE_EXIT at each return. A new one goes here and in the names in
+// profile.c.
+typedef enum
+{
+    PROFILE_APP_DISPLAY_TIME = 0,
+    PROFILE_BUTTON_EVENT,
+    PROFILE_SCHED_POST_AT,
+    PROFILE_DISP2STRING,
+    PROFILE_XMITUART2,
+    PROFILE_NUM_FUNCS
+} profile_func_t;
+
+typedef struct
+{
+    uint32_t calls;
+    // Instruction cycles, less the profiler's own
+    uint32_t total;
+    uint32_t max;
+} profile_stats_t;
+
+// The ISRs timed, each with a PROFILE_ISR_ENTER at the start of its body
+// and a PROFILE_ISR_EXIT at each return. The display's Timer 3 ISR cannot
+// be: the profiler takes the timer.
+typedef enum
+{
+    PROFILE_ISR_TIMEBASE = 0,
+    PROFILE_ISR_RTCC,
+    PROFILE_ISR_UART_RX,
+    PROFILE_ISR_CN,
+    PROFILE_ISR_UART_TX,
+    PROFILE_ISR_NVM,
+    PROFILE_ISR_HLVD,
+    PROFILE_ISR_ADC,
+    PROFILE_ISR_LED,
+    PROFILE_ISR_I2C,
+    PROFILE_NUM_ISRS
+} profile_isr_t;
+
+// Kept in 16 bits, which the ISRs write in one instruction and the main
+// loop reads in one. Calls stop at 0xFFFF.
+typedef struct
+{
+    uint16_t calls;
+    // Instruction cycles of the body, with any ISR nested in it, less the
+    // profiler's own
+    uint16_t max;
+} profile_isr_stats_t;
+
+#if PROFILE
+// Declares the start time of the call, so it goes after the function's
+// declarations. Calls may nest, but only functions of the main loop may
+// be profiled: the statistics are not shared with ISRs.
+#define PROFILE_ENTER() uint32_t profile_start_ = PROFILE_now()
+#define PROFILE_EXIT(func) PROFILE_record((func), profile_start_)
+
+// An ISR body is far shorter than a Timer 3 period, so TMR3 alone times
+// it. The hooks are macros, so the ISR calls no function for them and
+// saves no more registers than it did.
+extern volatile profile_isr_stats_t profile_isr_stats[PROFILE_NUM_ISRS];
+extern uint16_t profile_isr_overhead;
+#define PROFILE_ISR_ENTER() uint16_t profile_isr_start_ = TMR3
+#define PROFILE_ISR_EXIT(isr) \
+    do \
+    { \
+        uint16_t profile_cycles_ = TMR3 - profile_isr_start_; \
+        profile_cycles_ = profile_cycles_ > profile_isr_overhead \
+                          ? profile_cycles_ - profile_isr_overhead : 0; \
+        if (profile_isr_stats[isr].calls != 0xFFFF) \
+        { \
+            profile_isr_stats[isr].calls++; \
+        } \
+        if (profile_cycles_ > profile_isr_stats[isr].max) \
+        { \
+            profile_isr_stats[isr].max = profile_cycles_; \
+        } \
+    } while (0)
+#else
+#define PROFILE_ENTER() do{}while(0)
+#define PROFILE_EXIT(func) do{}while(0)
+#define PROFILE_ISR_ENTER() do{}while(0)
+#define PROFILE_ISR_EXIT(isr) do{}while(0)
+#endif
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void PROFILE_init(void);
+
+uint32_t PROFILE_now(void);
+
+void PROFILE_record(profile_func_t func, uint32_t start);
+
+const profile_stats_t *PROFILE_get_stats(profile_func_t func);
+
+const char *PROFILE_func_name(profile_func_t func);
+
+profile_isr_stats_t PROFILE_get_isr_stats(profile_isr_t isr);
+
+const char *PROFILE_isr_name(profile_isr_t isr);
+
+uint32_t PROFILE_since(void);
+
+void PROFILE_clear(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* PROFILE_H */
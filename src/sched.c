@@ -0,0 +1,416 @@
+/*
+ * File:   sched.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Cooperative scheduler. A task is a handler that runs to completion in
+ * main. ISRs post tasks as their events come in; timed tasks are released
+ * by the main loop after each timebase interrupt, stamped with the time
+ * they were due. Each post is stamped with the time, and the pending task
+ * whose release plus relative deadline is earliest runs first. Once
+ * nothing is pending the core idles until the next interrupt.
+ *
+ * A post to a task that is still pending is merged into it, so a task
+ * runs at most once per pending period and handles everything that has
+ * arrived by the time it starts. Tasks are not preempted: a long task,
+ * like a full line of console output, delays every other. The statistics
+ * of each task show how far: its worst release-to-start latency, which
+ * is its jitter, and its runs that finished past the deadline.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "sched.h"
+#include "timebase.h"
+#include "atomic.h"
+#include "io.h"
+#include "app.h"
+#include "alarm.h"
+#include "eeprom.h"
+#include "link.h"
+#include "calib.h"
+#include "sync.h"
+#include "battery.h"
+#include "pot.h"
+#include "lcd.h"
+#include "profile.h"
+#include "bench.h"
+
+typedef struct
+{
+    void (*handler)(void);
+    // Relative deadline in ticks
+    uint16_t deadline;
+    const char *name;
+} sched_task_info_t;
+
+#define SCHED_TASK(handler, deadline_ms, name) \
+    {handler, TIMEBASE_MS_TO_TICKS(deadline_ms), name}
+
+// The display must follow a button within 300ms and a second of the
+// countdown within 250ms; the console line a button can print takes up
+// to 210ms at 4800 baud. Alarm steps keep the tone cadence, and the
+// EEPROM steps are each 4ms of erase or write. The calibration has
+// seconds before the next window completes, and a sync beacon is stamped
+// as it is sent, so it may go late. The battery is measured every minute,
+// and the pot should follow a turn about as fast as the display follows a
+// button; so should the LCD, whose resets only need their waits to be at
+// least as long as asked. The benchmarks have nobody waiting on them.
+static const sched_task_info_t sched_tasks[SCHED_NUM_TASKS] = {
+    [SCHED_TASK_BUTTON] = SCHED_TASK(IO_handle_button_event, 300, "button"),
+    [SCHED_TASK_HOLD] = SCHED_TASK(APP_handle_hold_event, 300, "hold"),
+    [SCHED_TASK_COUNTDOWN] = SCHED_TASK(APP_handle_countdown_event, 250,
+                                        "countdown"),
+    [SCHED_TASK_ALARM] = SCHED_TASK(ALARM_handle_step_event, 50, "alarm"),
+    [SCHED_TASK_NVM] = SCHED_TASK(EEPROM_handle_nvm_event, 50, "nvm"),
+    [SCHED_TASK_LINK] = SCHED_TASK(LINK_handle_rx_event, 500, "link"),
+    [SCHED_TASK_CALIB] = SCHED_TASK(CALIB_handle_event, 1000, "calib"),
+    [SCHED_TASK_SYNC] = SCHED_TASK(SYNC_handle_beacon_event, 1000, "sync"),
+    [SCHED_TASK_BATTERY] = SCHED_TASK(BATTERY_handle_event, 1000, "battery"),
+    [SCHED_TASK_POT] = SCHED_TASK(POT_handle_event, 300, "pot"),
+#if LCD_I2C
+    [SCHED_TASK_LCD] = SCHED_TASK(LCD_handle_event, 300, "lcd"),
+#endif
+#if PROFILE
+    [SCHED_TASK_BENCH] = SCHED_TASK(BENCH_handle_event, 1000, "bench"),
+    [SCHED_TASK_BENCH_POST] = SCHED_TASK(BENCH_handle_post_event, 1000,
+                                         "bench_post"),
+#endif
+};
+
+// Tasks waiting to run, and timed tasks waiting for their time. Change
+// only with IPL_TIMER or above.
+static volatile uint16_t sched_ready = 0;
+static volatile uint16_t sched_armed = 0;
+// Release time of each ready task, and due time of each armed task.
+static volatile uint32_t sched_release[SCHED_NUM_TASKS];
+static uint32_t sched_due[SCHED_NUM_TASKS];
+static sched_stats_t sched_stats[SCHED_NUM_TASKS];
+
+
+static uint16_t sched_saturate(uint32_t ticks)
+{
+    return ticks > 0xFFFF ? 0xFFFF : ticks;
+}
+
+
+/*
+ * sched_release_task
+ *
+ * Make a task ready, released at a time. Call with IPL_TIMER or above.
+ */
+static void sched_release_task(sched_task_t task, uint32_t at)
+{
+    uint16_t bit = 1u << task;
+    if (sched_ready & bit)
+    {
+        if (sched_stats[task].merged != 0xFFFF)
+        {
+            sched_stats[task].merged++;
+        }
+        return;
+    }
+    sched_release[task] = at;
+    sched_ready |= bit;
+}
+
+
+/*
+ * sched_set_wakeup
+ *
+ * Set the timebase wakeup for the earliest armed task. Call with
+ * IPL_TIMER or above.
+ */
+static void sched_set_wakeup(void)
+{
+    uint32_t next = 0;
+    uint8_t found = 0;
+    uint8_t i;
+
+    for (i = 0; i < SCHED_NUM_TASKS; i++)
+    {
+        if ((sched_armed >> i & 1)
+            && (!found || TIMEBASE_BEFORE(sched_due[i], next)))
+        {
+            next = sched_due[i];
+            found = 1;
+        }
+    }
+    if (found)
+    {
+        TIMEBASE_set_wakeup(next);
+    }
+}
+
+
+/*
+ * SCHED_post
+ *
+ * Release a task now. Safe from main and any ISR at or below IPL_TIMER.
+ *
+ * @param task The task
+ * @return None
+ */
+void SCHED_post(sched_task_t task)
+{
+    uint16_t ipl;
+    CRITICAL_ENTER(ipl, IPL_TIMER);
+    sched_release_task(task, TIMEBASE_now());
+    CRITICAL_EXIT(ipl);
+}
+
+
+/*
+ * SCHED_post_at
+ *
+ * Release a task at a time, replacing any time it was already waiting
+ * for. A time that has passed releases it within a few ticks, stamped
+ * with that time. Call from main.
+ *
+ * @param task The task
+ * @param at The release time, see TIMEBASE_now
+ * @return None
+ */
+void SCHED_post_at(sched_task_t task, uint32_t at)
+{
+    uint16_t ipl;
+    PROFILE_ENTER();
+
+    CRITICAL_ENTER(ipl, IPL_TIMER);
+    sched_due[task] = at;
+    sched_armed |= 1u << task;
+    sched_set_wakeup();
+    CRITICAL_EXIT(ipl);
+    PROFILE_EXIT(PROFILE_SCHED_POST_AT);
+}
+
+
+/*
+ * SCHED_cancel
+ *
+ * Withdraw a task that is ready or waiting for its time. Call from main.
+ *
+ * @param task The task
+ * @return None
+ */
+void SCHED_cancel(sched_task_t task)
+{
+    uint16_t ipl;
+    CRITICAL_ENTER(ipl, IPL_TIMER);
+    sched_ready &= ~(1u << task);
+    sched_armed &= ~(1u << task);
+    CRITICAL_EXIT(ipl);
+}
+
+
+/*
+ * SCHED_is_pending
+ *
+ * @param task The task
+ * @return 1 if the task is ready or waiting for its time, otherwise 0
+ */
+uint8_t SCHED_is_pending(sched_task_t task)
+{
+    return ((sched_ready | sched_armed) >> task) & 1;
+}
+
+
+/*
+ * SCHED_release_time
+ *
+ * When a task was released. From the task's own handler this is the time
+ * the current run was due, so a periodic task reposts itself a period
+ * after it to run without drift.
+ *
+ * @param task The task
+ * @return The last release time of the task
+ */
+uint32_t SCHED_release_time(sched_task_t task)
+{
+    return sched_release[task];
+}
+
+
+/*
+ * SCHED_release_due
+ *
+ * Release the timed tasks whose time has come and set the wakeup for the
+ * rest. Called by the main loop after each timebase interrupt.
+ *
+ * @param None
+ * @return None
+ */
+void SCHED_release_due(void)
+{
+    uint32_t now;
+    uint16_t ipl;
+    uint8_t i;
+
+    CRITICAL_ENTER(ipl, IPL_TIMER);
+    now = TIMEBASE_now();
+    for (i = 0; i < SCHED_NUM_TASKS; i++)
+    {
+        if ((sched_armed >> i & 1) && !TIMEBASE_BEFORE(now, sched_due[i]))
+        {
+            sched_armed &= ~(1u << i);
+            sched_release_task(i, sched_due[i]);
+        }
+    }
+    sched_set_wakeup();
+    CRITICAL_EXIT(ipl);
+}
+
+
+/*
+ * sched_next
+ *
+ * The ready task with the earliest deadline. Ties go to the task listed
+ * first.
+ *
+ * @return The task, or SCHED_NUM_TASKS if none is ready
+ */
+static sched_task_t sched_next(void)
+{
+    uint16_t ready = sched_ready;
+    sched_task_t best = SCHED_NUM_TASKS;
+    uint32_t best_deadline = 0;
+    uint8_t i;
+
+    // A ready task's release time only changes once it has run, so it
+    // is read without masking the ISRs.
+    for (i = 0; i < SCHED_NUM_TASKS; i++)
+    {
+        if (ready >> i & 1)
+        {
+            uint32_t deadline = sched_release[i] + sched_tasks[i].deadline;
+            if (best == SCHED_NUM_TASKS
+                || TIMEBASE_BEFORE(deadline, best_deadline))
+            {
+                best = i;
+                best_deadline = deadline;
+            }
+        }
+    }
+    return best;
+}
+
+
+/*
+ * sched_run_task
+ *
+ * Run a ready task and update its statistics.
+ */
+static void sched_run_task(sched_task_t task)
+{
+    sched_stats_t *stats = &sched_stats[task];
+    uint32_t release = sched_release[task];
+    uint32_t start;
+    uint32_t finish;
+    uint16_t ipl;
+
+    CRITICAL_ENTER(ipl, IPL_TIMER);
+    sched_ready &= ~(1u << task);
+    CRITICAL_EXIT(ipl);
+
+    start = TIMEBASE_now();
+    sched_tasks[task].handler();
+    finish = TIMEBASE_now();
+
+    if (stats->runs != 0xFFFF)
+    {
+        stats->runs++;
+    }
+    if (finish - release > sched_tasks[task].deadline
+        && stats->overruns != 0xFFFF)
+    {
+        stats->overruns++;
+    }
+    if (sched_saturate(start - release) > stats->max_latency)
+    {
+        stats->max_latency = sched_saturate(start - release);
+    }
+    if (sched_saturate(finish - start) > stats->max_run)
+    {
+        stats->max_run = sched_saturate(finish - start);
+    }
+}
+
+
+/*
+ * SCHED_run
+ *
+ * Run tasks forever, earliest deadline first, and idle whenever none is
+ * ready. Called at the end of main() once everything is initialized.
+ *
+ * @param None
+ * @return Never
+ */
+void SCHED_run(void)
+{
+    uint16_t ipl;
+
+    while(1)
+    {
+        sched_task_t task;
+
+        if (TIMEBASE_take_expired())
+        {
+            SCHED_release_due();
+        }
+        task = sched_next();
+        if (task != SCHED_NUM_TASKS)
+        {
+            sched_run_task(task);
+            continue;
+        }
+
+        // An ISR that posts a task after the check above would otherwise
+        // be slept through, so test and idle with interrupts masked. Idle
+        // still wakes on a masked interrupt and the ISR runs once the
+        // priority is restored. ISRs that post nothing, like the LED
+        // steps, go straight back to Idle.
+        CRITICAL_ENTER(ipl, 7);
+        if (!sched_ready && !TIMEBASE_expired())
+        {
+            Idle();
+        }
+        CRITICAL_EXIT(ipl);
+    }
+}
+
+
+/*
+ * SCHED_get_stats
+ *
+ * @param task The task
+ * @return The task's statistics
+ */
+const sched_stats_t *SCHED_get_stats(sched_task_t task)
+{
+    return &sched_stats[task];
+}
+
+
+/*
+ * SCHED_task_name
+ *
+ * @param task The task
+ * @return A short name for the task
+ */
+const char *SCHED_task_name(sched_task_t task)
+{
+    return sched_tasks[task].name;
+}
+
+
+/*
+ * SCHED_task_deadline
+ *
+ * @param task The task
+ * @return The task's relative deadline in ticks
+ */
+uint32_t SCHED_task_deadline(sched_task_t task)
+{
+    return sched_tasks[task].deadline;
+}
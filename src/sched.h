@@ -0,0 +1,89 @@
+/*
+ * File: sched.h
+ * Author: Andy Smit
+ * Comments: Run-to-completion task scheduler for the main loop. Tasks are
+ *           posted by ISRs or released at a time, and run earliest
+ *           deadline first.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef SCHED_H
+#define	SCHED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+#include "profile.h"
+#include "lcd.h"
+
+// Every task, with its handler and deadline in the table in sched.c.
+typedef enum
+{
+    SCHED_TASK_BUTTON = 0,
+    SCHED_TASK_HOLD,
+    SCHED_TASK_COUNTDOWN,
+    SCHED_TASK_ALARM,
+    SCHED_TASK_NVM,
+    SCHED_TASK_LINK,
+    SCHED_TASK_CALIB,
+    SCHED_TASK_SYNC,
+    SCHED_TASK_BATTERY,
+    SCHED_TASK_POT,
+#if LCD_I2C
+    // The character LCD, only in a build with it
+    SCHED_TASK_LCD,
+#endif
+#if PROFILE
+    // The benchmark suite, only in a profiling build, and the task its
+    // SCHED_post_at kernel arms, which does nothing
+    SCHED_TASK_BENCH,
+    SCHED_TASK_BENCH_POST,
+#endif
+    SCHED_NUM_TASKS
+} sched_task_t;
+
+// Statistics of a task since reset. Times are in timebase ticks and
+// saturate at 0xFFFF.
+typedef struct
+{
+    uint16_t runs;
+    // Runs that finished after their deadline.
+    uint16_t overruns;
+    // Posts that found the task still pending, and were merged into it.
+    uint16_t merged;
+    // Longest wait from release to start: the task's jitter.
+    uint16_t max_latency;
+    // Longest time from start to finish.
+    uint16_t max_run;
+} sched_stats_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void SCHED_post(sched_task_t task);
+
+void SCHED_post_at(sched_task_t task, uint32_t at);
+
+void SCHED_cancel(sched_task_t task);
+
+uint8_t SCHED_is_pending(sched_task_t task);
+
+uint32_t SCHED_release_time(sched_task_t task);
+
+void SCHED_release_due(void);
+
+void SCHED_run(void);
+
+const sched_stats_t *SCHED_get_stats(sched_task_t task);
+
+const char *SCHED_task_name(sched_task_t task);
+
+uint32_t SCHED_task_deadline(sched_task_t task);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* SCHED_H */
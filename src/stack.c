@@ -0,0 +1,87 @@
+/*
+ * File:   stack.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Stack usage. The stack takes all data RAM left over by static data,
+ * from __SP_init up to __SPLIM_init (the PIC24 stack grows upwards). It
+ * is painted at boot; the highest word no longer holding the paint is
+ * the high-water mark. Nested interrupts all run on this stack, so the
+ * mark includes the deepest nesting seen since reset.
+ */
+
+#include <xc.h>
+#include "stack.h"
+
+#ifdef __XC16__
+// Stack bounds from the linker
+extern uint16_t _SP_init;
+extern uint16_t _SPLIM_init;
+
+
+/*
+ * STACK_paint
+ *
+ * Fill the unused stack above the current stack pointer. Call first
+ * thing in main(), before interrupts are enabled.
+ *
+ * @param None
+ * @return None
+ */
+void STACK_paint(void)
+{
+    volatile uint16_t *p = (volatile uint16_t *)WREG15;
+    while (p < &_SPLIM_init)
+    {
+        *p++ = STACK_PAINT;
+    }
+}
+
+
+/*
+ * STACK_high_water
+ *
+ * @param None
+ * @return The most stack used since STACK_paint, in bytes
+ */
+uint16_t STACK_high_water(void)
+{
+    volatile uint16_t *p = &_SPLIM_init;
+    while (p > &_SP_init && p[-1] == STACK_PAINT)
+    {
+        p--;
+    }
+    return (uint16_t)p - (uint16_t)&_SP_init;
+}
+
+
+/*
+ * STACK_size
+ *
+ * @param None
+ * @return The size of the stack in bytes
+ */
+uint16_t STACK_size(void)
+{
+    return (uint16_t)&_SPLIM_init - (uint16_t)&_SP_init;
+}
+#else
+// Host simulator builds run on the host stack, which the simulator
+// measures itself (see sim.c).
+void STACK_paint(void)
+{
+}
+
+
+uint16_t STACK_high_water(void)
+{
+    return 0;
+}
+
+
+uint16_t STACK_size(void)
+{
+    return 0;
+}
+#endif
@@ -0,0 +1,33 @@
+/*
+ * File: stack.h
+ * Author: Andy Smit
+ * Comments: Stack painting and high-water mark.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef STACK_H
+#define	STACK_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// Fill for unused stack. Not a valid return address or a likely local.
+#define STACK_PAINT 0xA55A
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void STACK_paint(void);
+
+uint16_t STACK_high_water(void);
+
+uint16_t STACK_size(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* STACK_H */
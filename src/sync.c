@@ -0,0 +1,526 @@
+/*
+ * File:   sync.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * Countdown synchronization. The leader's TX is wired to the RX of every
+ * follower; followers send nothing back. The console command L makes a
+ * unit the leader (see link.c), and a unit that hears a leader follows
+ * it. Every message is a line starting with SYNC_MARK, stamped with the
+ * leader's system time as its first character goes out, in fixed width
+ * upper case hex:
+ *
+ *   @T<time>                           beacon, every SYNC_BEACON_MS
+ *   @C<time><due><seconds><rate><res>  countdown of <seconds> running;
+ *                                      its next second ends at <due>,
+ *                                      and the ones after are split
+ *                                      from <rate> with CALIB_split_second
+ *                                      starting from residue <res>
+ *   @P<time><seconds>                  countdown paused at <seconds>
+ *   @X<time>                           countdown cancelled
+ *
+ * Time fields are 8 digits, seconds 4, rate 6 and residue 2.
+ *
+ * The follower's UART stamps the arrival of each SYNC_MARK, a character
+ * time after the leader stamped it. Each message is then a pair of
+ * times that maps the leader's clock onto the follower's: the latest
+ * pair gives the offset, and the pair from some seconds back the skew.
+ * A follower replays the leader's seconds in leader time and maps each
+ * end onto its own clock. Where a better estimate moves a second, the
+ * move is spread over the following seconds, SYNC_SLEW_MAX_MS at a time,
+ * so the display never skips.
+ *
+ * A follower's own buttons still work; they take the countdown out of
+ * the leader's hands until its next @C.
+ */
+
+#include <xc.h>
+#include <stdio.h>
+#include "main.h"
+#include "sync.h"
+#include "app.h"
+#include "calib.h"
+#include "sched.h"
+#include "timebase.h"
+#include "UART2.h"
+
+// Longest message, with CR LF and the terminator
+#define SYNC_MSG_SIZE 33
+// Offset of the first field after the time
+#define SYNC_FIELDS 10
+
+static sync_role_t sync_role = SYNC_ALONE;
+
+// Follower: the latest pair of leader and local times, and the pair the
+// skew is measured from. The skew is local ticks per leader tick, less
+// 1, in 1/2^20.
+static uint32_t sync_ref_leader;
+static uint32_t sync_ref_local;
+static uint32_t sync_anchor_leader;
+static uint32_t sync_anchor_local;
+static int32_t sync_skew = 0;
+// The skew has been measured since the last step of either clock.
+static uint8_t sync_skew_known = 0;
+// The local clock has stepped since the last beacon.
+static uint8_t sync_restart = 0;
+
+// Follower: the leader's countdown, in leader time. sync_prev_local is
+// where the previous second was put on the local clock.
+static uint8_t sync_counting = 0;
+static uint8_t sync_have_prev = 0;
+static uint32_t sync_due;
+static uint32_t sync_prev_due;
+static uint32_t sync_prev_local;
+static uint32_t sync_rate;
+static uint8_t sync_residue;
+
+
+/*
+ * SYNC_init
+ *
+ * Have the UART timestamp sync messages. Call once at boot.
+ *
+ * @param None
+ * @return None
+ */
+void SYNC_init(void)
+{
+    UART2_set_mark(SYNC_MARK);
+}
+
+
+/*
+ * sync_hex
+ *
+ * Write a number as a fixed number of upper case hex digits.
+ */
+static void sync_hex(char *p, uint32_t value, uint8_t digits)
+{
+    while (digits--)
+    {
+        uint8_t nib = value & 0xF;
+        p[digits] = nib < 10 ? '0' + nib : 'A' - 10 + nib;
+        value >>= 4;
+    }
+}
+
+
+/*
+ * sync_parse_hex
+ *
+ * Read a fixed number of hex digits.
+ *
+ * @return 1 on success, 0 on a character that is not a hex digit
+ */
+static uint8_t sync_parse_hex(const char *p, uint8_t digits, uint32_t *value)
+{
+    uint32_t v = 0;
+    while (digits--)
+    {
+        char c = *p++;
+        if (c >= '0' && c <= '9')
+        {
+            v = (v << 4) | (c - '0');
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            v = (v << 4) | (c - 'A' + 10);
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    *value = v;
+    return 1;
+}
+
+
+/*
+ * sync_send
+ *
+ * Stamp and send a message whose type and fields are filled in. The time
+ * is taken as late as possible: once the transmit queue has emptied, so
+ * the first character goes out as soon as it is written.
+ *
+ * @param msg The message, with its fields from SYNC_FIELDS on
+ * @param len Length of the message up to the end of its fields
+ */
+static void sync_send(char *msg, uint8_t len)
+{
+    msg[0] = SYNC_MARK;
+    msg[len] = '\r';
+    msg[len + 1] = '\n';
+    msg[len + 2] = '\0';
+    UART2_flush();
+    sync_hex(&msg[2], TIMEBASE_now(), 8);
+    Disp2String(msg);
+}
+
+
+/*
+ * SYNC_lead
+ *
+ * Start or stop leading: broadcast the countdown and the beacons.
+ *
+ * @param on 1 to lead, 0 to stop
+ * @return None
+ */
+void SYNC_lead(uint8_t on)
+{
+    if (on)
+    {
+        sync_role = SYNC_LEADER;
+        SCHED_post_at(SCHED_TASK_SYNC, TIMEBASE_now());
+    }
+    else if (sync_role == SYNC_LEADER)
+    {
+        sync_role = SYNC_ALONE;
+        SCHED_cancel(SCHED_TASK_SYNC);
+    }
+}
+
+
+/*
+ * SYNC_get_role
+ *
+ * @param None
+ * @return Whether the unit leads, follows or does neither
+ */
+sync_role_t SYNC_get_role(void)
+{
+    return sync_role;
+}
+
+
+/*
+ * SYNC_handle_beacon_event
+ *
+ * Send a beacon. Runs as the sync task every SYNC_BEACON_MS while
+ * leading (see sched.c).
+ *
+ * @param None
+ * @return None
+ */
+void SYNC_handle_beacon_event(void)
+{
+    char msg[SYNC_MSG_SIZE];
+
+    if (sync_role != SYNC_LEADER)
+    {
+        return;
+    }
+    SCHED_post_at(SCHED_TASK_SYNC, SCHED_release_time(SCHED_TASK_SYNC)
+                                   + TIMEBASE_MS_TO_TICKS(SYNC_BEACON_MS));
+    msg[1] = 'T';
+    sync_send(msg, SYNC_FIELDS);
+}
+
+
+/*
+ * SYNC_clock_stepped
+ *
+ * The local clock has changed rate, as when OSCTUN is trimmed: measure
+ * the skew again from the next beacon. Called by the calibration.
+ *
+ * @param None
+ * @return None
+ */
+void SYNC_clock_stepped(void)
+{
+    if (sync_role == SYNC_FOLLOWER)
+    {
+        sync_restart = 1;
+    }
+}
+
+
+/*
+ * sync_map
+ *
+ * A leader time on the local clock.
+ */
+static uint32_t sync_map(uint32_t leader)
+{
+    int32_t d = (int32_t)(leader - sync_ref_leader);
+    return sync_ref_local + d + (int32_t)(((int64_t)d * sync_skew) >> 20);
+}
+
+
+/*
+ * sync_sample
+ *
+ * Take a pair of times: a message stamped by the leader and its arrival
+ * here.
+ */
+static void sync_sample(uint32_t leader, uint32_t local)
+{
+    uint32_t span;
+
+    if (sync_role != SYNC_FOLLOWER)
+    {
+        sync_role = SYNC_FOLLOWER;
+        sync_anchor_leader = leader;
+        sync_anchor_local = local;
+        sync_skew = 0;
+        sync_skew_known = 0;
+    }
+    else if (sync_restart)
+    {
+        sync_anchor_leader = leader;
+        sync_anchor_local = local;
+        sync_skew_known = 0;
+        sync_restart = 0;
+    }
+    else if (sync_skew_known)
+    {
+        // A pair far from where the estimate puts it means one of the
+        // clocks has stepped, as when OSCTUN is trimmed: measure the skew
+        // again from here, keeping the old one meanwhile.
+        int32_t error = (int32_t)(local - sync_map(leader));
+        if (error > (int32_t)TIMEBASE_MS_TO_TICKS(SYNC_STEP_MS)
+            || error < -(int32_t)TIMEBASE_MS_TO_TICKS(SYNC_STEP_MS))
+        {
+            sync_anchor_leader = leader;
+            sync_anchor_local = local;
+            sync_skew_known = 0;
+        }
+    }
+    span = leader - sync_anchor_leader;
+    if (span >= TIMEBASE_MS_TO_TICKS(SYNC_SKEW_MIN_MS))
+    {
+        int32_t diff = (int32_t)((local - sync_anchor_local) - span);
+        sync_skew = (int32_t)(((int64_t)diff << 20) / (int32_t)span);
+        sync_skew_known = 1;
+    }
+    if (span >= TIMEBASE_MS_TO_TICKS(SYNC_SKEW_WINDOW_MS))
+    {
+        sync_anchor_leader = leader;
+        sync_anchor_local = local;
+    }
+    sync_ref_leader = leader;
+    sync_ref_local = local;
+}
+
+
+/*
+ * SYNC_receive
+ *
+ * Act on a sync message from the leader. Called by the link with each
+ * line starting with SYNC_MARK; lines that do not parse are dropped.
+ *
+ * @param line The line, without its CR or LF
+ * @param len Its length
+ * @return None
+ */
+void SYNC_receive(const char *line, uint8_t len)
+{
+    uint32_t arrival = UART2_get_mark_time();
+    uint32_t sent;
+    uint32_t due;
+    uint32_t seconds;
+    uint32_t rate;
+    uint32_t residue;
+
+    if (sync_role == SYNC_LEADER || len < SYNC_FIELDS
+        || !sync_parse_hex(&line[2], 8, &sent))
+    {
+        return;
+    }
+    // The mark is stamped once the character is in, 10 bits after the
+    // leader stamped it.
+    arrival -= (CALIB_get_rate() * 10 / UART2_get_baud()) >> 8;
+
+    switch (line[1])
+    {
+        case 'T':
+        {
+            sync_sample(sent, arrival);
+            break;
+        }
+        case 'C':
+        {
+            if (len != SYNC_FIELDS + 20
+                || !sync_parse_hex(&line[SYNC_FIELDS], 8, &due)
+                || !sync_parse_hex(&line[SYNC_FIELDS + 8], 4, &seconds)
+                || !sync_parse_hex(&line[SYNC_FIELDS + 12], 6, &rate)
+                || !sync_parse_hex(&line[SYNC_FIELDS + 18], 2, &residue)
+                || seconds == 0)
+            {
+                return;
+            }
+            sync_sample(sent, arrival);
+            sync_due = due;
+            sync_rate = rate;
+            sync_residue = residue;
+            sync_counting = 1;
+            sync_have_prev = 0;
+            APP_sync_run(seconds);
+            break;
+        }
+        case 'P':
+        {
+            if (len != SYNC_FIELDS + 4
+                || !sync_parse_hex(&line[SYNC_FIELDS], 4, &seconds))
+            {
+                return;
+            }
+            sync_sample(sent, arrival);
+            sync_counting = 0;
+            APP_sync_hold(seconds);
+            break;
+        }
+        case 'X':
+        {
+            sync_sample(sent, arrival);
+            sync_counting = 0;
+            APP_sync_cancel();
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+
+/*
+ * SYNC_countdown_run
+ *
+ * The countdown has started or resumed. A leader broadcasts it; on a
+ * follower the local buttons have taken over from the leader.
+ *
+ * @param seconds Seconds left
+ * @param due When the current second ends
+ * @param residue The residue of CALIB_next_second after that second
+ * @return None
+ */
+void SYNC_countdown_run(uint16_t seconds, uint32_t due, uint8_t residue)
+{
+    char msg[SYNC_MSG_SIZE];
+
+    sync_counting = 0;
+    if (sync_role != SYNC_LEADER)
+    {
+        return;
+    }
+    msg[1] = 'C';
+    sync_hex(&msg[SYNC_FIELDS], due, 8);
+    sync_hex(&msg[SYNC_FIELDS + 8], seconds, 4);
+    sync_hex(&msg[SYNC_FIELDS + 12], CALIB_get_rate(), 6);
+    sync_hex(&msg[SYNC_FIELDS + 18], residue, 2);
+    sync_send(msg, SYNC_FIELDS + 20);
+}
+
+
+/*
+ * SYNC_countdown_hold
+ *
+ * The countdown has been paused. See SYNC_countdown_run.
+ *
+ * @param seconds Seconds left
+ * @return None
+ */
+void SYNC_countdown_hold(uint16_t seconds)
+{
+    char msg[SYNC_MSG_SIZE];
+
+    sync_counting = 0;
+    if (sync_role != SYNC_LEADER)
+    {
+        return;
+    }
+    msg[1] = 'P';
+    sync_hex(&msg[SYNC_FIELDS], seconds, 4);
+    sync_send(msg, SYNC_FIELDS + 4);
+}
+
+
+/*
+ * SYNC_countdown_cancel
+ *
+ * The countdown has been cancelled. See SYNC_countdown_run.
+ *
+ * @param None
+ * @return None
+ */
+void SYNC_countdown_cancel(void)
+{
+    char msg[SYNC_MSG_SIZE];
+
+    sync_counting = 0;
+    if (sync_role != SYNC_LEADER)
+    {
+        return;
+    }
+    msg[1] = 'X';
+    sync_send(msg, SYNC_FIELDS);
+}
+
+
+/*
+ * SYNC_next_due
+ *
+ * When the next second of the countdown ends, while following the
+ * leader's. Each call moves on by a second.
+ *
+ * @param due Where to store the time
+ * @return 1 if following the leader's countdown, otherwise 0 and the
+ *         countdown times its own seconds
+ */
+uint8_t SYNC_next_due(uint32_t *due)
+{
+    uint32_t local;
+
+    if (sync_role != SYNC_FOLLOWER || !sync_counting)
+    {
+        return 0;
+    }
+    local = sync_map(sync_due);
+    if (sync_have_prev)
+    {
+        // How far the previous second is from where the estimate now
+        // puts it. Make up at most SYNC_SLEW_MAX_MS of it this second.
+        int32_t error = (int32_t)(sync_map(sync_prev_due) - sync_prev_local);
+        int32_t limit = TIMEBASE_MS_TO_TICKS(SYNC_SLEW_MAX_MS);
+        local -= error;
+        local += error > limit ? limit : error < -limit ? -limit : error;
+    }
+    sync_prev_due = sync_due;
+    sync_prev_local = local;
+    sync_have_prev = 1;
+    sync_due += CALIB_split_second(sync_rate, &sync_residue);
+    *due = local;
+    return 1;
+}
+
+
+/*
+ * SYNC_display_status
+ *
+ * Print the role, and on a follower the skew of the leader's clock, on
+ * their own line.
+ *
+ * @param None
+ * @return None
+ */
+void SYNC_display_status(void)
+{
+    char s[32];
+
+    switch (sync_role)
+    {
+        case SYNC_LEADER:
+            Disp2String("sync leader\r\n");
+            break;
+        case SYNC_FOLLOWER:
+            // 1/2^20 to ppm
+            snprintf(s, sizeof(s), "sync follower %ld ppm\r\n",
+                     (long)(((int32_t)sync_skew * 15625) >> 14));
+            Disp2String(s);
+            break;
+        default:
+            Disp2String("sync off\r\n");
+            break;
+    }
+}
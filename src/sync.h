@@ -0,0 +1,76 @@
+/*
+ * File: sync.h
+ * Author: Andy Smit
+ * Comments: Countdown synchronization of several units over the serial
+ *           link. A leader broadcasts its countdowns and time beacons;
+ *           followers estimate the offset and skew of its clock and
+ *           time their seconds to end with the leader's.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef SYNC_H
+#define	SYNC_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+
+// First character of every sync message. Its arrival is timestamped.
+#define SYNC_MARK '@'
+
+// Time between the leader's beacons.
+#define SYNC_BEACON_MS 2000
+
+// The skew is measured over beacons at least SYNC_SKEW_MIN_MS apart, from
+// a reference that restarts every SYNC_SKEW_WINDOW_MS so it follows
+// drift.
+#define SYNC_SKEW_MIN_MS 4000
+#define SYNC_SKEW_WINDOW_MS 60000
+
+// A beacon this far from where the estimate puts it restarts the skew
+// measurement.
+#define SYNC_STEP_MS 2
+
+// Most a follower moves the end of one second to catch up with a better
+// estimate of the leader's clock.
+#define SYNC_SLEW_MAX_MS 10
+
+typedef enum
+{
+    SYNC_ALONE = 0,
+    SYNC_LEADER,
+    SYNC_FOLLOWER
+} sync_role_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void SYNC_init(void);
+
+void SYNC_lead(uint8_t on);
+
+sync_role_t SYNC_get_role(void);
+
+void SYNC_handle_beacon_event(void);
+
+void SYNC_clock_stepped(void);
+
+void SYNC_receive(const char *line, uint8_t len);
+
+void SYNC_countdown_run(uint16_t seconds, uint32_t due, uint8_t residue);
+
+void SYNC_countdown_hold(uint16_t seconds);
+
+void SYNC_countdown_cancel(void);
+
+uint8_t SYNC_next_due(uint32_t *due);
+
+void SYNC_display_status(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* SYNC_H */
@@ -0,0 +1,213 @@
+/*
+ * File:   timebase.c
+ * Author: andy
+ *
+ * Created on October 19, 2026
+ *
+ * System time. Timer 1 runs from the top of main() and never stops; the
+ * time is the count plus the ticks of every completed period, kept in
+ * timebase_base. The period register doubles as the wakeup: it is set so
+ * the period ends when the scheduler's next timed task is due, and left
+ * at its maximum otherwise. The core then sleeps until that interrupt
+ * with no periodic tick, and the time stays exact because each period is
+ * added as it ends.
+ *
+ * This is the one clock of the firmware: timestamps, latencies and
+ * timeouts all read TIMEBASE_now. Nothing waits on it by spinning. Code
+ * that needs to do something later takes a TIMEBASE_deadline and either
+ * checks TIMEBASE_reached when it next runs, or has the scheduler run a
+ * task at that time with SCHED_post_at.
+ *
+ * The ISR only adds the period and flags that it ended; the scheduler
+ * releases the timed tasks from the main loop (TIMEBASE_take_expired).
+ * That keeps the body of the highest priority ISR to a few instructions,
+ * all on the shadow registers.
+ */
+
+#include <xc.h>
+#include "main.h"
+#include "timebase.h"
+#include "atomic.h"
+#include "power.h"
+#include "profile.h"
+
+// Least ticks between the count and a period end for the period to be
+// changed, so the count cannot pass either end while PR1 is written.
+#define TIMEBASE_MIN_LEAD 4
+
+// Time at which the current period started. Written by the ISR only.
+static volatile uint32_t timebase_base = 0;
+// Bit 0 is set by the ISR when a period ends. See atomic.h.
+static volatile uint16_t timebase_expired = 0;
+
+
+/*
+ * TIMEBASE_init
+ *
+ * Start the system time from 0. Call first thing in main(); Timer 1 is
+ * held from then on.
+ *
+ * @param None
+ * @return None
+ */
+void TIMEBASE_init(void)
+{
+    POWER_acquire(POWER_TIMER1);
+    T1CON = 0; // Internal clock, not gated, continue in idle
+    TMR1 = 0;
+    PR1 = 0xFFFF;
+    T1CONbits.TCKPS = TIMEBASE_TCKPS; // See TIMEBASE_TICK_US
+    IPC0bits.T1IP = IPL_TIMER;
+    IFS0bits.T1IF = 0;
+    IEC0bits.T1IE = 1;
+    T1CONbits.TON = 1;
+}
+
+
+/*
+ * TIMEBASE_now
+ *
+ * The time in ticks since TIMEBASE_init. Safe from main and any ISR.
+ *
+ * @param None
+ * @return The time, see TIMEBASE_TICK_US
+ */
+uint32_t TIMEBASE_now(void)
+{
+    uint16_t ipl;
+    uint16_t count;
+    uint32_t now;
+
+    CRITICAL_ENTER(ipl, IPL_TIMER);
+    count = TMR1;
+    now = timebase_base;
+    // A period that has ended but is not yet added: the count restarted
+    // from 0, possibly after the read above.
+    if (IFS0bits.T1IF)
+    {
+        count = TMR1;
+        now += (uint32_t)PR1 + 1;
+    }
+    CRITICAL_EXIT(ipl);
+    return now + count;
+}
+
+
+/*
+ * TIMEBASE_deadline
+ *
+ * The time a number of milliseconds from now.
+ *
+ * @param ms Milliseconds from now, up to a day
+ * @return The time, for TIMEBASE_reached or SCHED_post_at
+ */
+uint32_t TIMEBASE_deadline(uint32_t ms)
+{
+    return TIMEBASE_now() + TIMEBASE_MS_TO_TICKS(ms);
+}
+
+
+/*
+ * TIMEBASE_reached
+ *
+ * @param deadline A time, see TIMEBASE_deadline
+ * @return 1 if the time has come, otherwise 0
+ */
+uint8_t TIMEBASE_reached(uint32_t deadline)
+{
+    return !TIMEBASE_BEFORE(TIMEBASE_now(), deadline);
+}
+
+
+/*
+ * TIMEBASE_elapsed
+ *
+ * @param since An earlier time, such as a timestamp
+ * @return The ticks from then until now
+ */
+uint32_t TIMEBASE_elapsed(uint32_t since)
+{
+    return TIMEBASE_now() - since;
+}
+
+
+/*
+ * TIMEBASE_set_wakeup
+ *
+ * Interrupt at a time, or as soon as possible if it has passed. Replaces
+ * any earlier wakeup. A time more than one full count away wakes at the
+ * end of the count instead, and the ISR sets it again.
+ *
+ * @param at The time to wake at
+ * @return None
+ */
+void TIMEBASE_set_wakeup(uint32_t at)
+{
+    uint16_t ipl;
+    uint16_t count;
+    uint32_t ahead;
+
+    CRITICAL_ENTER(ipl, IPL_TIMER);
+    count = TMR1;
+    // A period that has ended, or is about to, is added by the ISR, which
+    // sets the wakeup again.
+    if (!IFS0bits.T1IF && PR1 - count >= TIMEBASE_MIN_LEAD)
+    {
+        ahead = at - timebase_base - count;
+        if ((int32_t)ahead < TIMEBASE_MIN_LEAD)
+        {
+            ahead = TIMEBASE_MIN_LEAD;
+        }
+        if (ahead + count > 0x10000UL)
+        {
+            PR1 = 0xFFFF;
+        }
+        else
+        {
+            PR1 = count + ahead - 1;
+        }
+    }
+    CRITICAL_EXIT(ipl);
+}
+
+
+/*
+ * TIMEBASE_take_expired
+ *
+ * Whether a period has ended since the last call: a wakeup, or the count
+ * running out, after which the wakeup must be set again. Call from main.
+ *
+ * @param None
+ * @return 1 if a period has ended, otherwise 0
+ */
+uint8_t TIMEBASE_take_expired(void)
+{
+    return ATOMIC_TEST_AND_CLEAR_BIT(timebase_expired, 0);
+}
+
+
+/*
+ * TIMEBASE_expired
+ *
+ * Like TIMEBASE_take_expired, but leaves the flag set. Safe with any IPL.
+ *
+ * @param None
+ * @return 1 if a period has ended, otherwise 0
+ */
+uint8_t TIMEBASE_expired(void)
+{
+    return timebase_expired & 1;
+}
+
+
+// The end of a period: either a wakeup or the count running out.
+void ISR_FAST _T1Interrupt(void)
+{
+    PROFILE_ISR_ENTER();
+
+    IFS0bits.T1IF = 0;
+    timebase_base += (uint32_t)PR1 + 1;
+    PR1 = 0xFFFF;
+    ATOMIC_SET_BIT(timebase_expired, 0);
+    PROFILE_ISR_EXIT(PROFILE_ISR_TIMEBASE);
+}
@@ -0,0 +1,66 @@
+/*
+ * File: timebase.h
+ * Author: Andy Smit
+ * Comments: Monotonic system time on Timer 1, extended to 32 bits in
+ *           software, with a single wakeup for the scheduler.
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef TIMEBASE_H
+#define	TIMEBASE_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdint.h>
+#include "clock.h"
+
+// Timer 1 counts Fcy / 64 on the LPFRC and Fcy / 256 on the FRC: 256us
+// or 64us per tick. The 32 bit time wraps after 12.7 or 3.2 days;
+// compare times with TIMEBASE_BEFORE, never with <.
+#if CLOCK_FCY > 1000000UL
+#define TIMEBASE_TCKPS 0b11
+#define TIMEBASE_PRESCALE 256UL
+#else
+#define TIMEBASE_TCKPS 0b10
+#define TIMEBASE_PRESCALE 64UL
+#endif
+#define TIMEBASE_HZ (CLOCK_FCY / TIMEBASE_PRESCALE)
+#define TIMEBASE_TICK_US (TIMEBASE_PRESCALE * 1000000UL / CLOCK_FCY)
+
+// Milliseconds to ticks, rounded to the nearest tick.
+#define TIMEBASE_MS_TO_TICKS(ms) \
+    ((uint32_t)(((uint32_t)(ms) * (CLOCK_FCY / 1000) + TIMEBASE_PRESCALE / 2) \
+                / TIMEBASE_PRESCALE))
+
+// Time a is before time b, across the wrap.
+#define TIMEBASE_BEFORE(a, b) ((int32_t)((uint32_t)(a) - (uint32_t)(b)) < 0)
+
+// Ticks to whole milliseconds, for spans up to an hour.
+#define TIMEBASE_TICKS_TO_MS(ticks) ((uint32_t)(ticks) * TIMEBASE_TICK_US / 1000)
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+void TIMEBASE_init(void);
+
+uint32_t TIMEBASE_now(void);
+
+uint32_t TIMEBASE_deadline(uint32_t ms);
+
+uint8_t TIMEBASE_reached(uint32_t deadline);
+
+uint32_t TIMEBASE_elapsed(uint32_t since);
+
+void TIMEBASE_set_wakeup(uint32_t at);
+
+uint8_t TIMEBASE_take_expired(void);
+
+uint8_t TIMEBASE_expired(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* TIMEBASE_H */
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+#
+# File:   ram_report.py
+# Author: Andy Smit
+#
+# Static RAM per module from a linker map file, checked against the
+# budgets in ram_budget.txt. Run after every build (see the .build-post
+# target in Makefile); exits with status 1 when a budget is exceeded.
+#
+# usage: ram_report.py [-b BUDGET] MAP|DIR
+#
+# Given a directory, the newest *.map file under it is used. Works on
+# XC16 and GNU ld map files; a module is an object file, or an archive
+# for library code.
+
+import argparse
+import os
+import re
+import sys
+
+# Input sections that occupy data RAM. .eedata and .const are in the
+# EEPROM and program memory.
+RAM_SECTION = re.compile(r'^(\.n?bss|\.n?data|\.s?bss|\.s?data|\.pbss|COMMON)(\.|$)')
+SECTION_LINE = re.compile(r'^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+SECTION_NAME = re.compile(r'^ (\S+)$')
+SECTION_REST = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+
+
+def module_name(path):
+    """Object file base name, or the archive for a library member."""
+    path = path.strip()
+    archive = re.match(r'^(.*)\((.*)\)$', path)
+    if archive:
+        return os.path.basename(archive.group(1))
+    return os.path.splitext(os.path.basename(path))[0]
+
+
+def parse_map(path):
+    """Bytes of static RAM per module."""
+    modules = {}
+    in_map = False
+    pending = None
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if line.startswith('Linker script and memory map'):
+                in_map = True
+                continue
+            if not in_map:
+                continue
+            match = SECTION_LINE.match(line)
+            if match:
+                name, size, obj = match.group(1), match.group(3), match.group(4)
+            elif pending:
+                # Section name too long, the rest is on the next line
+                match = SECTION_REST.match(line)
+                name, pending = pending, None
+                if not match:
+                    continue
+                size, obj = match.group(2), match.group(3)
+            else:
+                match = SECTION_NAME.match(line)
+                if match:
+                    pending = match.group(1)
+                continue
+            size = int(size, 16)
+            if size and RAM_SECTION.match(name):
+                module = module_name(obj)
+                modules[module] = modules.get(module, 0) + size
+    return modules
+
+
+def parse_budget(path):
+    """Budget file: "ram N", "stack N", "reserve N" and "module NAME N"."""
+    budget = {'ram': 0, 'stack': 0, 'reserve': 0, 'modules': {}}
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            words = line.split('#', 1)[0].split()
+            if not words:
+                continue
+            if words[0] == 'module' and len(words) == 3:
+                budget['modules'][words[1]] = int(words[2], 0)
+            elif words[0] in ('ram', 'stack', 'reserve') and len(words) == 2:
+                budget[words[0]] = int(words[1], 0)
+            else:
+                sys.exit('%s:%d: bad budget line' % (path, number))
+    return budget
+
+
+def newest_map(directory):
+    maps = []
+    for root, _, files in os.walk(directory):
+        maps += [os.path.join(root, f) for f in files if f.endswith('.map')]
+    if not maps:
+        sys.exit('no map file under %s' % directory)
+    return max(maps, key=os.path.getmtime)
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description='Static RAM report')
+    parser.add_argument('-b', '--budget',
+                        default=os.path.join(here, 'ram_budget.txt'))
+    parser.add_argument('map')
+    args = parser.parse_args()
+
+    path = newest_map(args.map) if os.path.isdir(args.map) else args.map
+    modules = parse_map(path)
+    budget = parse_budget(args.budget)
+    failed = False
+
+    print('Static RAM from %s' % path)
+    for module, size in sorted(modules.items(), key=lambda m: -m[1]):
+        limit = budget['modules'].get(module)
+        note = ''
+        if limit is not None:
+            note = '  (budget %d)' % limit
+            if size > limit:
+                note += '  OVER'
+                failed = True
+        print('  %-20s %5d%s' % (module, size, note))
+
+    static = sum(modules.values())
+    used = static + budget['stack'] + budget['reserve']
+    print('  %-20s %5d' % ('total static', static))
+    print('  %-20s %5d' % ('stack', budget['stack']))
+    if budget['reserve']:
+        print('  %-20s %5d' % ('reserved', budget['reserve']))
+    print('  %-20s %5d of %d, %d free' % ('ram', used, budget['ram'],
+                                         budget['ram'] - used))
+    if budget['ram'] and used > budget['ram']:
+        print('RAM budget exceeded by %d bytes' % (used - budget['ram']))
+        failed = True
+    elif failed:
+        print('Module RAM budget exceeded')
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())